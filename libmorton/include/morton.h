@@ -9,66 +9,324 @@
 #include "morton2D.h"
 #include "morton3D.h"
 #include "morton_BMI.h"
+#include "morton_CLMUL.h"
+#include "morton_AVX2.h"
+#include "morton_neighbors.h"
+#include "morton_dispatch.h"
+#include <stddef.h>
 
 namespace libmorton {
 	// Functions under this are stubs which will always point to fastest implementation at the moment
 	//-----------------------------------------------------------------------------------------------
 
+#if LIBMORTON_RUNTIME_DISPATCH
+	// The fastest implementation is picked at runtime, see morton_dispatch.h
+
+	// ENCODING
+	inline uint_fast32_t morton2D_32_encode(const uint_fast16_t x, const uint_fast16_t y) {
+		return dispatch_detail::table().m2D_32_encode(static_cast<uint16_t>(x), static_cast<uint16_t>(y));
+	}
+	inline uint_fast64_t morton2D_64_encode(const uint_fast32_t x, const uint_fast32_t y) {
+		return dispatch_detail::table().m2D_64_encode(static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+	}
+	inline uint_fast32_t morton3D_32_encode(const uint_fast16_t x, const uint_fast16_t y, const uint_fast16_t z) {
+		return dispatch_detail::table().m3D_32_encode(static_cast<uint16_t>(x), static_cast<uint16_t>(y), static_cast<uint16_t>(z));
+	}
+	inline uint_fast64_t morton3D_64_encode(const uint_fast32_t x, const uint_fast32_t y, const uint_fast32_t z) {
+		return dispatch_detail::table().m3D_64_encode(static_cast<uint32_t>(x), static_cast<uint32_t>(y), static_cast<uint32_t>(z));
+	}
+
+	// DECODING
+	inline void morton2D_32_decode(const uint_fast32_t morton, uint_fast16_t& x, uint_fast16_t& y) {
+		uint16_t dx, dy;
+		dispatch_detail::table().m2D_32_decode(static_cast<uint32_t>(morton), dx, dy);
+		x = dx; y = dy;
+	}
+	inline void morton2D_64_decode(const uint_fast64_t morton, uint_fast32_t& x, uint_fast32_t& y) {
+		uint32_t dx, dy;
+		dispatch_detail::table().m2D_64_decode(static_cast<uint64_t>(morton), dx, dy);
+		x = dx; y = dy;
+	}
+	inline void morton3D_32_decode(const uint_fast32_t morton, uint_fast16_t& x, uint_fast16_t& y, uint_fast16_t& z) {
+		uint16_t dx, dy, dz;
+		dispatch_detail::table().m3D_32_decode(static_cast<uint32_t>(morton), dx, dy, dz);
+		x = dx; y = dy; z = dz;
+	}
+	inline void morton3D_64_decode(const uint_fast64_t morton, uint_fast32_t& x, uint_fast32_t& y, uint_fast32_t& z) {
+		uint32_t dx, dy, dz;
+		dispatch_detail::table().m3D_64_decode(static_cast<uint64_t>(morton), dx, dy, dz);
+		x = dx; y = dy; z = dz;
+	}
+
+#if LIBMORTON_HAS_UINT128
+	// 128-BIT CODES
+	// 2D coordinates up to 64 bits, 3D coordinates up to 42 bits. morton128_t codes compare and sort in Z-order.
+	inline morton128_t morton2D_128_encode(const uint_fast64_t x, const uint_fast64_t y) {
+		return dispatch_detail::table().m2D_128_encode(static_cast<uint64_t>(x), static_cast<uint64_t>(y));
+	}
+	inline morton128_t morton3D_128_encode(const uint_fast64_t x, const uint_fast64_t y, const uint_fast64_t z) {
+		return dispatch_detail::table().m3D_128_encode(static_cast<uint64_t>(x), static_cast<uint64_t>(y), static_cast<uint64_t>(z));
+	}
+	inline void morton2D_128_decode(const morton128_t morton, uint_fast64_t& x, uint_fast64_t& y) {
+		uint64_t dx, dy;
+		dispatch_detail::table().m2D_128_decode(morton, dx, dy);
+		x = dx; y = dy;
+	}
+	inline void morton3D_128_decode(const morton128_t morton, uint_fast64_t& x, uint_fast64_t& y, uint_fast64_t& z) {
+		uint64_t dx, dy, dz;
+		dispatch_detail::table().m3D_128_decode(morton, dx, dy, dz);
+		x = dx; y = dy; z = dz;
+	}
+#endif
+
+	// BATCH ENCODING
+	// Encode n coordinate tuples from separate x, y (and z) arrays into out
+	inline void morton2D_32_encode_batch(const uint16_t* x, const uint16_t* y, uint32_t* out, size_t n) {
+		dispatch_detail::table().m2D_32_encode_batch(x, y, out, n);
+	}
+	inline void morton2D_64_encode_batch(const uint32_t* x, const uint32_t* y, uint64_t* out, size_t n) {
+		dispatch_detail::table().m2D_64_encode_batch(x, y, out, n);
+	}
+	inline void morton3D_32_encode_batch(const uint16_t* x, const uint16_t* y, const uint16_t* z, uint32_t* out, size_t n) {
+		dispatch_detail::table().m3D_32_encode_batch(x, y, z, out, n);
+	}
+	inline void morton3D_64_encode_batch(const uint32_t* x, const uint32_t* y, const uint32_t* z, uint64_t* out, size_t n) {
+		dispatch_detail::table().m3D_64_encode_batch(x, y, z, out, n);
+	}
+
+	// BATCH DECODING
+	// Decode n morton codes into separate x, y (and z) arrays
+	inline void morton2D_32_decode_batch(const uint32_t* m, uint16_t* x, uint16_t* y, size_t n) {
+		dispatch_detail::table().m2D_32_decode_batch(m, x, y, n);
+	}
+	inline void morton2D_64_decode_batch(const uint64_t* m, uint32_t* x, uint32_t* y, size_t n) {
+		dispatch_detail::table().m2D_64_decode_batch(m, x, y, n);
+	}
+	inline void morton3D_32_decode_batch(const uint32_t* m, uint16_t* x, uint16_t* y, uint16_t* z, size_t n) {
+		dispatch_detail::table().m3D_32_decode_batch(m, x, y, z, n);
+	}
+	inline void morton3D_64_decode_batch(const uint64_t* m, uint32_t* x, uint32_t* y, uint32_t* z, size_t n) {
+		dispatch_detail::table().m3D_64_decode_batch(m, x, y, z, n);
+	}
+
+	// BATCH NEIGHBORS
+	// Face, edge and corner neighbors of n 3D morton codes, see morton_neighbors.h
+	inline void morton3D_32_neighbors_batch(const uint32_t* m, size_t n, const morton_stencil stencil, const uint32_t max_code, uint32_t* out, uint32_t* valid) {
+		dispatch_detail::table().m3D_32_neighbors_batch(m, n, stencil, max_code, out, valid);
+	}
+	inline void morton3D_64_neighbors_batch(const uint64_t* m, size_t n, const morton_stencil stencil, const uint64_t max_code, uint64_t* out, uint32_t* valid) {
+		dispatch_detail::table().m3D_64_neighbors_batch(m, n, stencil, max_code, out, valid);
+	}
+
+#else
+	// The fastest implementation is picked at compile time
+
 	// ENCODING
 #if defined(__BMI2__) || __AVX2__
 	inline uint_fast32_t morton2D_32_encode(const uint_fast16_t x, const uint_fast16_t y) {
-		return m2D_e_BMI<uint_fast32_t, uint_fast16_t>(x, y);
+		return m2D_e_BMI<uint32_t, uint16_t>(static_cast<uint16_t>(x), static_cast<uint16_t>(y));
 	}
 	inline uint_fast64_t morton2D_64_encode(const uint_fast32_t x, const uint_fast32_t y) {
-		return m2D_e_BMI<uint_fast64_t, uint_fast32_t>(x, y);
+		return m2D_e_BMI<uint64_t, uint32_t>(static_cast<uint32_t>(x), static_cast<uint32_t>(y));
 	}
 	inline uint_fast32_t morton3D_32_encode(const uint_fast16_t x, const uint_fast16_t y, const uint_fast16_t z) {
-		return m3D_e_BMI<uint_fast32_t, uint_fast16_t>(x, y, z);
+		return m3D_e_BMI<uint32_t, uint16_t>(static_cast<uint16_t>(x), static_cast<uint16_t>(y), static_cast<uint16_t>(z));
 	}
 	inline uint_fast64_t morton3D_64_encode(const uint_fast32_t x, const uint_fast32_t y, const uint_fast32_t z) {
-		return m3D_e_BMI<uint_fast64_t, uint_fast32_t>(x, y, z);
+		return m3D_e_BMI<uint64_t, uint32_t>(static_cast<uint32_t>(x), static_cast<uint32_t>(y), static_cast<uint32_t>(z));
 	}
 #else
 	inline uint_fast32_t morton2D_32_encode(const uint_fast16_t x, const uint_fast16_t y) {
-		return m2D_e_sLUT<uint_fast32_t, uint_fast16_t>(x, y);
+		return m2D_e_sLUT<uint32_t, uint16_t>(static_cast<uint16_t>(x), static_cast<uint16_t>(y));
 	}
 	inline uint_fast64_t morton2D_64_encode(const uint_fast32_t x, const uint_fast32_t y) {
-		return m2D_e_sLUT<uint_fast64_t, uint_fast32_t>(x, y);
+		return m2D_e_sLUT<uint64_t, uint32_t>(static_cast<uint32_t>(x), static_cast<uint32_t>(y));
 	}
 	inline uint_fast32_t morton3D_32_encode(const uint_fast16_t x, const uint_fast16_t y, const uint_fast16_t z) {
-		return m3D_e_sLUT<uint_fast32_t, uint_fast16_t>(x, y, z);
+		return m3D_e_sLUT<uint32_t, uint16_t>(static_cast<uint16_t>(x), static_cast<uint16_t>(y), static_cast<uint16_t>(z));
 	}
 	inline uint_fast64_t morton3D_64_encode(const uint_fast32_t x, const uint_fast32_t y, const uint_fast32_t z) {
-		return m3D_e_sLUT<uint_fast64_t, uint_fast32_t>(x, y, z);
+		return m3D_e_sLUT<uint64_t, uint32_t>(static_cast<uint32_t>(x), static_cast<uint32_t>(y), static_cast<uint32_t>(z));
 	}
 #endif
 
 	// DECODING
 #if defined(__BMI2__) || __AVX2__
 	inline void morton2D_32_decode(const uint_fast32_t morton, uint_fast16_t& x, uint_fast16_t& y) {
-		m2D_d_BMI<uint_fast32_t, uint_fast16_t>(morton, x, y);
+		uint16_t dx, dy;
+		m2D_d_BMI<uint32_t, uint16_t>(static_cast<uint32_t>(morton), dx, dy);
+		x = dx; y = dy;
 	}
 	inline void morton2D_64_decode(const uint_fast64_t morton, uint_fast32_t& x, uint_fast32_t& y) {
-		m2D_d_BMI<uint_fast64_t, uint_fast32_t>(morton, x, y);
+		uint32_t dx, dy;
+		m2D_d_BMI<uint64_t, uint32_t>(static_cast<uint64_t>(morton), dx, dy);
+		x = dx; y = dy;
 	}
 	inline void morton3D_32_decode(const uint_fast32_t morton, uint_fast16_t& x, uint_fast16_t& y, uint_fast16_t& z) {
-		m3D_d_BMI<uint_fast32_t, uint_fast16_t>(morton, x, y, z);
+		uint16_t dx, dy, dz;
+		m3D_d_BMI<uint32_t, uint16_t>(static_cast<uint32_t>(morton), dx, dy, dz);
+		x = dx; y = dy; z = dz;
 	}
 	inline void morton3D_64_decode(const uint_fast64_t morton, uint_fast32_t& x, uint_fast32_t& y, uint_fast32_t& z) {
-		m3D_d_BMI<uint_fast64_t, uint_fast32_t>(morton, x, y, z);
+		uint32_t dx, dy, dz;
+		m3D_d_BMI<uint64_t, uint32_t>(static_cast<uint64_t>(morton), dx, dy, dz);
+		x = dx; y = dy; z = dz;
 	}
 #else
 	inline void morton2D_32_decode(const uint_fast32_t morton, uint_fast16_t& x, uint_fast16_t& y) {
-		m2D_d_sLUT<uint_fast32_t, uint_fast16_t>(morton, x, y);
+		uint16_t dx, dy;
+		m2D_d_sLUT<uint32_t, uint16_t>(static_cast<uint32_t>(morton), dx, dy);
+		x = dx; y = dy;
 	}
 	inline void morton2D_64_decode(const uint_fast64_t morton, uint_fast32_t& x, uint_fast32_t& y) {
-		m2D_d_sLUT<uint_fast64_t, uint_fast32_t>(morton, x, y);
+		uint32_t dx, dy;
+		m2D_d_sLUT<uint64_t, uint32_t>(static_cast<uint64_t>(morton), dx, dy);
+		x = dx; y = dy;
 	}
 	inline void morton3D_32_decode(const uint_fast32_t morton, uint_fast16_t& x, uint_fast16_t& y, uint_fast16_t& z) {
-		m3D_d_sLUT<uint_fast32_t, uint_fast16_t>(morton, x, y, z);
+		uint16_t dx, dy, dz;
+		m3D_d_sLUT<uint32_t, uint16_t>(static_cast<uint32_t>(morton), dx, dy, dz);
+		x = dx; y = dy; z = dz;
 	}
 	inline void morton3D_64_decode(const uint_fast64_t morton, uint_fast32_t& x, uint_fast32_t& y, uint_fast32_t& z) {
-		m3D_d_sLUT<uint_fast64_t, uint_fast32_t>(morton, x, y, z);
+		uint32_t dx, dy, dz;
+		m3D_d_sLUT<uint64_t, uint32_t>(static_cast<uint64_t>(morton), dx, dy, dz);
+		x = dx; y = dy; z = dz;
+	}
+#endif
+
+#if LIBMORTON_HAS_UINT128
+	// 128-BIT CODES
+	// 2D coordinates up to 64 bits, 3D coordinates up to 42 bits. morton128_t codes compare and sort in Z-order.
+#if defined(__BMI2__) || __AVX2__
+	inline morton128_t morton2D_128_encode(const uint_fast64_t x, const uint_fast64_t y) {
+		return m2D_e_BMI<morton128_t, uint64_t>(static_cast<uint64_t>(x), static_cast<uint64_t>(y));
+	}
+	inline morton128_t morton3D_128_encode(const uint_fast64_t x, const uint_fast64_t y, const uint_fast64_t z) {
+		return m3D_e_BMI<morton128_t, uint64_t>(static_cast<uint64_t>(x), static_cast<uint64_t>(y), static_cast<uint64_t>(z));
+	}
+	inline void morton2D_128_decode(const morton128_t morton, uint_fast64_t& x, uint_fast64_t& y) {
+		uint64_t dx, dy;
+		m2D_d_BMI<morton128_t, uint64_t>(morton, dx, dy);
+		x = dx; y = dy;
+	}
+	inline void morton3D_128_decode(const morton128_t morton, uint_fast64_t& x, uint_fast64_t& y, uint_fast64_t& z) {
+		uint64_t dx, dy, dz;
+		m3D_d_BMI<morton128_t, uint64_t>(morton, dx, dy, dz);
+		x = dx; y = dy; z = dz;
+	}
+#else
+	inline morton128_t morton2D_128_encode(const uint_fast64_t x, const uint_fast64_t y) {
+		return m2D_e_sLUT<morton128_t, uint64_t>(static_cast<uint64_t>(x), static_cast<uint64_t>(y));
+	}
+	inline morton128_t morton3D_128_encode(const uint_fast64_t x, const uint_fast64_t y, const uint_fast64_t z) {
+		return m3D_e_sLUT<morton128_t, uint64_t>(static_cast<uint64_t>(x), static_cast<uint64_t>(y), static_cast<uint64_t>(z));
+	}
+	inline void morton2D_128_decode(const morton128_t morton, uint_fast64_t& x, uint_fast64_t& y) {
+		uint64_t dx, dy;
+		m2D_d_sLUT<morton128_t, uint64_t>(morton, dx, dy);
+		x = dx; y = dy;
+	}
+	inline void morton3D_128_decode(const morton128_t morton, uint_fast64_t& x, uint_fast64_t& y, uint_fast64_t& z) {
+		uint64_t dx, dy, dz;
+		m3D_d_sLUT<morton128_t, uint64_t>(morton, dx, dy, dz);
+		x = dx; y = dy; z = dz;
+	}
+#endif
+#endif
+
+	// BATCH ENCODING
+	// Encode n coordinate tuples from separate x, y (and z) arrays into out
+#if defined(__AVX2__)
+	inline void morton2D_32_encode_batch(const uint16_t* x, const uint16_t* y, uint32_t* out, size_t n) {
+		m2D_e_AVX2(x, y, out, n);
+	}
+	inline void morton2D_64_encode_batch(const uint32_t* x, const uint32_t* y, uint64_t* out, size_t n) {
+		m2D_e_AVX2(x, y, out, n);
+	}
+	inline void morton3D_32_encode_batch(const uint16_t* x, const uint16_t* y, const uint16_t* z, uint32_t* out, size_t n) {
+		m3D_e_AVX2(x, y, z, out, n);
+	}
+	inline void morton3D_64_encode_batch(const uint32_t* x, const uint32_t* y, const uint32_t* z, uint64_t* out, size_t n) {
+		m3D_e_AVX2(x, y, z, out, n);
+	}
+#else
+	inline void morton2D_32_encode_batch(const uint16_t* x, const uint16_t* y, uint32_t* out, size_t n) {
+		for (size_t i = 0; i < n; ++i) { out[i] = static_cast<uint32_t>(morton2D_32_encode(x[i], y[i])); }
+	}
+	inline void morton2D_64_encode_batch(const uint32_t* x, const uint32_t* y, uint64_t* out, size_t n) {
+		for (size_t i = 0; i < n; ++i) { out[i] = static_cast<uint64_t>(morton2D_64_encode(x[i], y[i])); }
+	}
+	inline void morton3D_32_encode_batch(const uint16_t* x, const uint16_t* y, const uint16_t* z, uint32_t* out, size_t n) {
+		for (size_t i = 0; i < n; ++i) { out[i] = static_cast<uint32_t>(morton3D_32_encode(x[i], y[i], z[i])); }
+	}
+	inline void morton3D_64_encode_batch(const uint32_t* x, const uint32_t* y, const uint32_t* z, uint64_t* out, size_t n) {
+		for (size_t i = 0; i < n; ++i) { out[i] = static_cast<uint64_t>(morton3D_64_encode(x[i], y[i], z[i])); }
+	}
+#endif
+
+	// BATCH DECODING
+	// Decode n morton codes into separate x, y (and z) arrays
+#if defined(__AVX2__)
+	inline void morton2D_32_decode_batch(const uint32_t* m, uint16_t* x, uint16_t* y, size_t n) {
+		m2D_d_AVX2(m, x, y, n);
+	}
+	inline void morton2D_64_decode_batch(const uint64_t* m, uint32_t* x, uint32_t* y, size_t n) {
+		m2D_d_AVX2(m, x, y, n);
+	}
+	inline void morton3D_32_decode_batch(const uint32_t* m, uint16_t* x, uint16_t* y, uint16_t* z, size_t n) {
+		m3D_d_AVX2(m, x, y, z, n);
+	}
+	inline void morton3D_64_decode_batch(const uint64_t* m, uint32_t* x, uint32_t* y, uint32_t* z, size_t n) {
+		m3D_d_AVX2(m, x, y, z, n);
+	}
+#else
+	inline void morton2D_32_decode_batch(const uint32_t* m, uint16_t* x, uint16_t* y, size_t n) {
+		uint_fast16_t xi, yi;
+		for (size_t i = 0; i < n; ++i) {
+			morton2D_32_decode(m[i], xi, yi);
+			x[i] = static_cast<uint16_t>(xi); y[i] = static_cast<uint16_t>(yi);
+		}
+	}
+	inline void morton2D_64_decode_batch(const uint64_t* m, uint32_t* x, uint32_t* y, size_t n) {
+		uint_fast32_t xi, yi;
+		for (size_t i = 0; i < n; ++i) {
+			morton2D_64_decode(m[i], xi, yi);
+			x[i] = static_cast<uint32_t>(xi); y[i] = static_cast<uint32_t>(yi);
+		}
+	}
+	inline void morton3D_32_decode_batch(const uint32_t* m, uint16_t* x, uint16_t* y, uint16_t* z, size_t n) {
+		uint_fast16_t xi, yi, zi;
+		for (size_t i = 0; i < n; ++i) {
+			morton3D_32_decode(m[i], xi, yi, zi);
+			x[i] = static_cast<uint16_t>(xi); y[i] = static_cast<uint16_t>(yi); z[i] = static_cast<uint16_t>(zi);
+		}
+	}
+	inline void morton3D_64_decode_batch(const uint64_t* m, uint32_t* x, uint32_t* y, uint32_t* z, size_t n) {
+		uint_fast32_t xi, yi, zi;
+		for (size_t i = 0; i < n; ++i) {
+			morton3D_64_decode(m[i], xi, yi, zi);
+			x[i] = static_cast<uint32_t>(xi); y[i] = static_cast<uint32_t>(yi); z[i] = static_cast<uint32_t>(zi);
+		}
+	}
+#endif
+
+	// BATCH NEIGHBORS
+	// Face, edge and corner neighbors of n 3D morton codes, see morton_neighbors.h
+#if defined(__AVX2__)
+	inline void morton3D_32_neighbors_batch(const uint32_t* m, size_t n, const morton_stencil stencil, const uint32_t max_code, uint32_t* out, uint32_t* valid) {
+		m3D_neighbors_AVX2(m, n, stencil, max_code, out, valid);
+	}
+	inline void morton3D_64_neighbors_batch(const uint64_t* m, size_t n, const morton_stencil stencil, const uint64_t max_code, uint64_t* out, uint32_t* valid) {
+		m3D_neighbors_AVX2(m, n, stencil, max_code, out, valid);
+	}
+#else
+	inline void morton3D_32_neighbors_batch(const uint32_t* m, size_t n, const morton_stencil stencil, const uint32_t max_code, uint32_t* out, uint32_t* valid) {
+		m3D_neighbors<uint32_t>(m, n, stencil, max_code, out, valid);
+	}
+	inline void morton3D_64_neighbors_batch(const uint64_t* m, size_t n, const morton_stencil stencil, const uint64_t max_code, uint64_t* out, uint32_t* valid) {
+		m3D_neighbors<uint64_t>(m, n, stencil, max_code, out, valid);
 	}
 #endif
+#endif // LIBMORTON_RUNTIME_DISPATCH
 }
\ No newline at end of file
@@ -5,8 +5,8 @@
 
 #include <algorithm>
 #include <stdint.h>
-#include <math.h>
 #include "morton2D_LUTs.h"
+#include "morton_constexpr_LUTs.h"
 #include "morton_common.h"
 
 #define EIGHTBITMASK (morton) 0x000000FF
@@ -16,58 +16,45 @@ using namespace std;
 namespace libmorton {
 
 	// Encode methods
-	template<typename morton, typename coord> inline morton m2D_e_sLUT(const coord x, const coord y);
+	template<typename morton, typename coord, unsigned int chunk = 8> inline morton m2D_e_sLUT(const coord x, const coord y);
 	template<typename morton, typename coord> inline morton m2D_e_sLUT_ET(const coord x, const coord y);
-	template<typename morton, typename coord> inline morton m2D_e_LUT(const coord x, const coord y);
+	template<typename morton, typename coord, unsigned int chunk = 8> inline morton m2D_e_LUT(const coord x, const coord y);
 	template<typename morton, typename coord> inline morton m2D_e_LUT_ET(const coord x, const coord y);
-	template<typename morton, typename coord> inline morton m2D_e_magicbits(const coord x, const coord y);
-	template<typename morton, typename coord> inline morton m2D_e_for(const coord x, const coord y);
+	template<typename morton, typename coord> constexpr morton m2D_e_magicbits(const coord x, const coord y);
+	template<typename morton, typename coord> constexpr morton m2D_e_for(const coord x, const coord y);
 	template<typename morton, typename coord> inline morton m2D_e_for_ET(const coord x, const coord y);
 
 	// Decode methods
-	template<typename morton, typename coord> inline void m2D_d_sLUT(const morton m, coord& x, coord& y);
+	template<typename morton, typename coord, unsigned int chunk = 8> inline void m2D_d_sLUT(const morton m, coord& x, coord& y);
 	template<typename morton, typename coord> inline void m2D_d_sLUT_ET(const morton m, coord& x, coord& y);
-	template<typename morton, typename coord> inline void m2D_d_LUT(const morton m, coord& x, coord& y);
+	template<typename morton, typename coord, unsigned int chunk = 8> inline void m2D_d_LUT(const morton m, coord& x, coord& y);
 	template<typename morton, typename coord> inline void m2D_d_LUT_ET(const morton m, coord& x, coord& y);
-	template<typename morton, typename coord> inline void m2D_d_magicbits(const morton m, coord& x, coord& y);
-	template<typename morton, typename coord> inline void m2D_d_for(const morton m, coord& x, coord& y);
+	template<typename morton, typename coord> constexpr void m2D_d_magicbits(const morton m, coord& x, coord& y);
+	template<typename morton, typename coord> constexpr void m2D_d_for(const morton m, coord& x, coord& y);
 
 	// ENCODE 2D Morton code : Pre-shifted LookUpTable (sLUT)
-	template<typename morton, typename coord>
+	// chunk: coordinate bits per table lookup (tables of 2^chunk entries, see morton_constexpr_LUTs.h)
+	template<typename morton, typename coord, unsigned int chunk>
 	inline morton m2D_e_sLUT(const coord x, const coord y) {
-		morton answer = 0;
-		for (unsigned int i = sizeof(coord); i > 0; --i) {
-			unsigned int shift = (i - 1) * 8;
-			answer =
-				answer << 16 |
-				Morton2D_encode_y_256[(y >> shift) & EIGHTBITMASK] |
-				Morton2D_encode_x_256[(x >> shift) & EIGHTBITMASK];
-		}
-		return answer;
+		return encodeCoord_LUT<morton, coord, 2, chunk>(x, morton_encode_LUT<2, chunk, 0>::table, 0) |
+			encodeCoord_LUT<morton, coord, 2, chunk>(y, morton_encode_LUT<2, chunk, 1>::table, 0);
 	}
 
 	// ENCODE 2D Morton code : LookUpTable (LUT)
-	template<typename morton, typename coord>
+	template<typename morton, typename coord, unsigned int chunk>
 	inline morton m2D_e_LUT(const coord x, const coord y) {
-		morton answer = 0;
-		for (unsigned int i = sizeof(coord); i > 0; --i) {
-			unsigned int shift = (i - 1) * 8;
-			answer =
-				answer << 16 |
-				(Morton2D_encode_x_256[(y >> shift) & EIGHTBITMASK] << 1) |
-				(Morton2D_encode_x_256[(x >> shift) & EIGHTBITMASK]);
-		}
-		return answer;
+		return encodeCoord_LUT<morton, coord, 2, chunk>(x, morton_encode_LUT<2, chunk>::table, 0) |
+			encodeCoord_LUT<morton, coord, 2, chunk>(y, morton_encode_LUT<2, chunk>::table, 1);
 	}
 
 	// HELPER METHOD for Early Termination LUT Encode
-	template<typename morton, typename coord>
-	inline morton compute2D_ET_LUT_encode(const coord c, const coord *LUT) {
+	template<typename morton, typename coord, typename table>
+	inline morton compute2D_ET_LUT_encode(const coord c, const table *LUT) {
 		unsigned long maxbit = 0;
 		if (findFirstSetBit<coord>(c, &maxbit) == 0) { return 0; }
 		morton answer = 0;
 		unsigned int i = 0;
-		while (maxbit >= i) {
+		while (i < maxbit) {
 			answer |= ((morton)LUT[(c >> i) & EIGHTBITMASK]) << i * 2;
 			i += 8;
 		}
@@ -92,35 +79,23 @@ namespace libmorton {
 		return (answer_y << 1) | answer_x;
 	}
 
-	// Magicbits masks (2D encode)
-	static uint_fast32_t magicbit2D_masks32[6] = { 0xFFFFFFFF, 0x0000FFFF, 0x00FF00FF, 0x0F0F0F0F, 0x33333333, 0x55555555 };
-	static uint_fast64_t magicbit2D_masks64[6] = { 0x00000000FFFFFFFF, 0x0000FFFF0000FFFF, 0x00FF00FF00FF00FF, 0x0F0F0F0F0F0F0F0F, 0x3333333333333333, 0x5555555555555555 };
-
 	// HELPER METHOD for Magic bits encoding - split by 2
 	template<typename morton, typename coord>
-	inline morton morton2D_SplitBy2Bits(const coord a) {
-		const morton* masks = (sizeof(morton) <= 4) ? reinterpret_cast<const morton*>(magicbit2D_masks32) : reinterpret_cast<const morton*>(magicbit2D_masks64);
-		morton x = a;
-		if (sizeof(morton) > 4) { x = (x | (uint_fast64_t)x << 32) & masks[0]; }
-		x = (x | x << 16) & masks[1];
-		x = (x | x << 8) & masks[2];
-		x = (x | x << 4) & masks[3];
-		x = (x | x << 2) & masks[4];
-		x = (x | x << 1) & masks[5];
-		return x;
+	constexpr morton morton2D_SplitBy2Bits(const coord a) {
+		return magicbits_detail::split_bits<morton, 2>(static_cast<morton>(a));
 	}
 
 	// ENCODE 2D Morton code : Magic bits
 	template<typename morton, typename coord>
-	inline morton m2D_e_magicbits(const coord x, const coord y) {
+	constexpr morton m2D_e_magicbits(const coord x, const coord y) {
 		return morton2D_SplitBy2Bits<morton, coord>(x) | (morton2D_SplitBy2Bits<morton, coord>(y) << 1);
 	}
 
 	// ENCODE 2D Morton code : For Loop
 	template<typename morton, typename coord>
-	inline morton m2D_e_for(const coord x, const coord y) {
+	constexpr morton m2D_e_for(const coord x, const coord y) {
 		morton answer = 0;
-		unsigned int checkbits = (unsigned int)floor(sizeof(morton) * 4.0f);
+		unsigned int checkbits = sizeof(morton) * 4;
 		for (unsigned int i = 0; i < checkbits; ++i) {
 			morton mshifted = static_cast<morton>(0x1) << i; // Here we need to cast 0x1 to 64bits, otherwise there is a bug when morton code is larger than 32 bits
 			unsigned int shift = i; // because you have to shift back i and forth 2*i
@@ -149,29 +124,19 @@ namespace libmorton {
 		return answer;
 	}
 
-	// HELPER METHODE for LUT decoding
-	template<typename morton, typename coord>
-	inline coord morton2D_DecodeCoord_LUT256(const morton m, const uint_fast8_t *LUT, const unsigned int startshift) {
-		morton a = 0;
-		unsigned int loops = sizeof(morton);
-		for (unsigned int i = 0; i < loops; ++i) {
-			a |= ((morton)LUT[(m >> ((i * 8) + startshift)) & EIGHTBITMASK] << (4 * i));
-		}
-		return static_cast<coord>(a);
-	}
-
 	// DECODE 2D Morton code : Shifted LUT
-	template<typename morton, typename coord>
+	// chunk: morton code bits per table lookup, a multiple of 2
+	template<typename morton, typename coord, unsigned int chunk>
 	inline void m2D_d_sLUT(const morton m, coord& x, coord& y) {
-		x = morton2D_DecodeCoord_LUT256<morton, coord>(m, Morton2D_decode_x_256, 0);
-		y = morton2D_DecodeCoord_LUT256<morton, coord>(m, Morton2D_decode_y_256, 0);
+		x = decodeCoord_LUT<morton, coord, 2, chunk>(m, morton_decode_LUT<2, chunk, 0>::table, 0);
+		y = decodeCoord_LUT<morton, coord, 2, chunk>(m, morton_decode_LUT<2, chunk, 1>::table, 0);
 	}
 
 	// DECODE 2D 64-bit morton code : LUT
-	template<typename morton, typename coord>
+	template<typename morton, typename coord, unsigned int chunk>
 	inline void m2D_d_LUT(const morton m, coord& x, coord& y) {
-		x = morton2D_DecodeCoord_LUT256<morton, coord>(m, Morton2D_decode_x_256, 0);
-		y = morton2D_DecodeCoord_LUT256<morton, coord>(m, Morton2D_decode_x_256, 1);
+		x = decodeCoord_LUT<morton, coord, 2, chunk>(m, morton_decode_LUT<2, chunk>::table, 0);
+		y = decodeCoord_LUT<morton, coord, 2, chunk>(m, morton_decode_LUT<2, chunk>::table, 1);
 	}
 
 	// DECODE 2D Morton code : Shifted LUT (early termination)
@@ -209,32 +174,24 @@ namespace libmorton {
 
 	// HELPER method for Magicbits decoding
 	template<typename morton, typename coord>
-	static inline coord morton2D_GetSecondBits(const morton m) {
-		morton* masks = (sizeof(morton) <= 4) ? reinterpret_cast<morton*>(magicbit2D_masks32) : reinterpret_cast<morton*>(magicbit2D_masks64);
-		morton x = m & masks[5];
-		x = (x ^ (x >> 1)) & masks[4];
-		x = (x ^ (x >> 2)) & masks[3];
-		x = (x ^ (x >> 4)) & masks[2];
-		x = (x ^ (x >> 8)) & masks[1];
-		if (sizeof(morton) > 4) x = (x ^ (x >> 16)) & masks[0];
-		return static_cast<coord>(x);
+	constexpr coord morton2D_GetSecondBits(const morton m) {
+		return static_cast<coord>(magicbits_detail::compact_bits<morton, 2>(m));
 	}
 
 	// DECODE 2D Morton code : Magic bits
 	// This method splits the morton codes bits by using certain patterns (magic bits)
 	template<typename morton, typename coord>
-	inline void m2D_d_magicbits(const morton m, coord& x, coord& y) {
+	constexpr void m2D_d_magicbits(const morton m, coord& x, coord& y) {
 		x = morton2D_GetSecondBits<morton, coord>(m);
 		y = morton2D_GetSecondBits<morton, coord>(m >> 1);
 	}
 
-
 	// DECODE 2D morton code : For loop
 	template<typename morton, typename coord>
-	inline void m2D_d_for(const morton m, coord& x, coord& y) {
+	constexpr void m2D_d_for(const morton m, coord& x, coord& y) {
 		x = 0; y = 0;
 		unsigned int checkbits = sizeof(morton) * 4;
-		for (unsigned int i = 0; i <= checkbits; ++i) {
+		for (unsigned int i = 0; i < checkbits; ++i) {
 			morton selector = 1;
 			unsigned int shift_selector = 2 * i;
 			x |= (m & (selector << shift_selector)) >> i;
@@ -248,9 +205,8 @@ namespace libmorton {
 		x = 0; y = 0;
 		unsigned long firstbit_location = 0;
 		if (!findFirstSetBit<morton>(m, &firstbit_location)) return;
-		float defaultbits = sizeof(morton) * 4;
-		unsigned int checkbits = static_cast<unsigned int>(min(defaultbits, firstbit_location / 2.0f));
-		for (unsigned int i = 0; i <= checkbits; ++i) {
+		unsigned int checkbits = min(static_cast<unsigned int>(sizeof(morton) * 4), static_cast<unsigned int>((firstbit_location + 1) / 2));
+		for (unsigned int i = 0; i < checkbits; ++i) {
 			morton selector = 1;
 			unsigned int shift_selector = 2 * i;
 			x |= (m & (selector << shift_selector)) >> i;
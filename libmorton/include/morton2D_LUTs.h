@@ -5,7 +5,7 @@
 namespace libmorton {
 
 	// LUT for Morton2D encode X
-	static const uint_fast16_t Morton2D_encode_x_256[256] =
+	static const uint16_t Morton2D_encode_x_256[256] =
 	{
 	0, 1, 4, 5, 16, 17, 20, 21,
 	64, 65, 68, 69, 80, 81, 84, 85,
@@ -42,7 +42,7 @@ namespace libmorton {
 	};
 
 	// LUT for Morton2D encode Y
-	static const uint_fast16_t Morton2D_encode_y_256[256] =
+	static const uint16_t Morton2D_encode_y_256[256] =
 	{
 	0, 2, 8, 10, 32, 34, 40, 42,
 	128, 130, 136, 138, 160, 162, 168, 170,
@@ -79,7 +79,7 @@ namespace libmorton {
 	};
 
 	// LUT for Morton2D decode X
-	static const uint_fast8_t Morton2D_decode_x_256[256] = {
+	static const uint8_t Morton2D_decode_x_256[256] = {
 	0,1,0,1,2,3,2,3,0,1,0,1,2,3,2,3,
 	4,5,4,5,6,7,6,7,4,5,4,5,6,7,6,7,
 	0,1,0,1,2,3,2,3,0,1,0,1,2,3,2,3,
@@ -99,7 +99,7 @@ namespace libmorton {
 	};
 
 	// LUT for Morton2D decode Y
-	static const uint_fast8_t Morton2D_decode_y_256[256] = {
+	static const uint8_t Morton2D_decode_y_256[256] = {
 	0,0,1,1,0,0,1,1,2,2,3,3,2,2,3,3,
 	0,0,1,1,0,0,1,1,2,2,3,3,2,2,3,3,
 	4,4,5,5,4,4,5,5,6,6,7,7,6,6,7,7,
@@ -0,0 +1,89 @@
+#pragma once
+
+// Libmorton - Methods to encode/decode N-dimensional morton codes
+// Coordinates are passed as a std::array of N values, coordinate i ends up in bits i, i + N, i + 2N, ... of the
+// morton code. Every coordinate holds sizeof(morton) * 8 / N bits. Masks and lookup tables are generated at compile
+// time for every (N, morton type). For N = 2 and N = 3 they are the same masks and tables the methods in morton2D.h / morton3D.h use.
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+#include "morton_common.h"
+#include "morton_constexpr_LUTs.h"
+#include "morton_BMI.h"
+
+namespace libmorton {
+	namespace nd_detail {
+		// Default decode chunk: a multiple of N of about 12 bits (tables of a few KB)
+		constexpr unsigned int decode_chunk(const size_t N) {
+			return static_cast<unsigned int>(N * (N < 12 ? 12 / N : 1));
+		}
+	}
+
+	// AVAILABLE METHODS FOR ENCODING
+	template<size_t N, typename morton, typename coord, unsigned int chunk = 8> inline morton mND_e_LUT(const std::array<coord, N>& c);
+	template<size_t N, typename morton, typename coord> constexpr morton mND_e_magicbits(const std::array<coord, N>& c);
+
+	// AVAILABLE METHODS FOR DECODING
+	template<size_t N, typename morton, typename coord, unsigned int chunk = nd_detail::decode_chunk(N)> inline void mND_d_LUT(const morton m, std::array<coord, N>& c);
+	template<size_t N, typename morton, typename coord> inline void mND_d_magicbits(const morton m, std::array<coord, N>& c);
+
+	// ENCODE ND Morton code : LookUpTable (LUT)
+	// chunk: coordinate bits per table lookup (tables of 2^chunk entries, see morton_constexpr_LUTs.h)
+	template<size_t N, typename morton, typename coord, unsigned int chunk>
+	inline morton mND_e_LUT(const std::array<coord, N>& c) {
+		morton answer = 0;
+		for (size_t i = 0; i < N; ++i) {
+			answer |= encodeCoord_LUT<morton, coord, N, chunk>(c[i], morton_encode_LUT<N, chunk>::table, static_cast<unsigned int>(i));
+		}
+		return answer;
+	}
+
+	// ENCODE ND Morton code : Magic bits method
+	template<size_t N, typename morton, typename coord>
+	constexpr morton mND_e_magicbits(const std::array<coord, N>& c) {
+		morton answer = 0;
+		for (size_t i = 0; i < N; ++i) {
+			answer |= magicbits_detail::split_bits<morton, N>(static_cast<morton>(c[i])) << i;
+		}
+		return answer;
+	}
+
+	// DECODE ND Morton code : LookUpTable (LUT)
+	// chunk: morton code bits per table lookup, a multiple of N
+	template<size_t N, typename morton, typename coord, unsigned int chunk>
+	inline void mND_d_LUT(const morton m, std::array<coord, N>& c) {
+		for (size_t i = 0; i < N; ++i) {
+			c[i] = decodeCoord_LUT<morton, coord, N, chunk>(m, morton_decode_LUT<N, chunk>::table, static_cast<unsigned int>(i));
+		}
+	}
+
+	// DECODE ND Morton code : Magic bits method
+	template<size_t N, typename morton, typename coord>
+	inline void mND_d_magicbits(const morton m, std::array<coord, N>& c) {
+		for (size_t i = 0; i < N; ++i) {
+			c[i] = static_cast<coord>(magicbits_detail::compact_bits<morton, N>(m >> i));
+		}
+	}
+
+#if defined(__BMI2__) || __AVX2__ || LIBMORTON_X86_DISPATCH
+	// ENCODE ND Morton code : BMI2 instruction set (pdep)
+	// Only call this after checking the host CPU supports BMI2 (see morton_dispatch.h)
+	template<size_t N, typename morton, typename coord>
+	LIBMORTON_TARGET("bmi2") inline morton mND_e_BMI(const std::array<coord, N>& c) {
+		morton answer = 0;
+		for (size_t i = 0; i < N; ++i) {
+			answer |= bmi2_detail::pdep(static_cast<morton>(c[i]), static_cast<morton>(magicbits_detail::masks<morton, N>::spread << i));
+		}
+		return answer;
+	}
+
+	// DECODE ND Morton code : BMI2 instruction set (pext)
+	template<size_t N, typename morton, typename coord>
+	LIBMORTON_TARGET("bmi2") inline void mND_d_BMI(const morton m, std::array<coord, N>& c) {
+		for (size_t i = 0; i < N; ++i) {
+			c[i] = static_cast<coord>(bmi2_detail::pext(m, static_cast<morton>(magicbits_detail::masks<morton, N>::spread << i)));
+		}
+	}
+#endif
+}
@@ -0,0 +1,316 @@
+#pragma once
+
+// Libmorton - Batch methods to encode/decode arrays of morton codes using the AVX2 instruction set
+// Decoding writes the coordinates to separate x, y (and z) arrays, the neighbor methods one array per neighbor.
+// Each call processes 8 (32-bit codes) or 4 (64-bit codes) coordinate tuples per iteration using
+// a vectorized version of the magic bits method, and finishes the remaining tail with the scalar version.
+
+#include "morton_common.h"
+#if defined(__AVX2__) || LIBMORTON_X86_DISPATCH
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "morton2D.h"
+#include "morton3D.h"
+#include "morton_neighbors.h"
+
+namespace libmorton {
+
+	namespace avx2_detail {
+		// Split the lower 16 bits of every 32-bit lane by 1 bit (2D, 32-bit morton codes)
+		LIBMORTON_TARGET("avx2") inline __m256i splitBy2bits_epi32(__m256i x) noexcept {
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi32(x, 8)), _mm256_set1_epi32(0x00FF00FF));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi32(x, 4)), _mm256_set1_epi32(0x0F0F0F0F));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi32(x, 2)), _mm256_set1_epi32(0x33333333));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi32(x, 1)), _mm256_set1_epi32(0x55555555));
+			return x;
+		}
+
+		// Split the lower 32 bits of every 64-bit lane by 1 bit (2D, 64-bit morton codes)
+		LIBMORTON_TARGET("avx2") inline __m256i splitBy2bits_epi64(__m256i x) noexcept {
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 16)), _mm256_set1_epi64x(0x0000FFFF0000FFFF));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 8)), _mm256_set1_epi64x(0x00FF00FF00FF00FF));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 4)), _mm256_set1_epi64x(0x0F0F0F0F0F0F0F0F));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 2)), _mm256_set1_epi64x(0x3333333333333333));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 1)), _mm256_set1_epi64x(0x5555555555555555));
+			return x;
+		}
+
+		// Split the lower 10 bits of every 32-bit lane by 2 bits (3D, 32-bit morton codes)
+		LIBMORTON_TARGET("avx2") inline __m256i splitBy3bits_epi32(__m256i x) noexcept {
+			x = _mm256_and_si256(x, _mm256_set1_epi32(0x000003FF));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi32(x, 16)), _mm256_set1_epi32(0x030000FF));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi32(x, 8)), _mm256_set1_epi32(0x0300F00F));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi32(x, 4)), _mm256_set1_epi32(0x030C30C3));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi32(x, 2)), _mm256_set1_epi32(0x09249249));
+			return x;
+		}
+
+		// Split the lower 21 bits of every 64-bit lane by 2 bits (3D, 64-bit morton codes)
+		LIBMORTON_TARGET("avx2") inline __m256i splitBy3bits_epi64(__m256i x) noexcept {
+			x = _mm256_and_si256(x, _mm256_set1_epi64x(0x1FFFFF));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 32)), _mm256_set1_epi64x(0x1F00000000FFFF));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 16)), _mm256_set1_epi64x(0x1F0000FF0000FF));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 8)), _mm256_set1_epi64x(0x100F00F00F00F00F));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 4)), _mm256_set1_epi64x(0x10C30C30C30C30C3));
+			x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 2)), _mm256_set1_epi64x(0x1249249249249249));
+			return x;
+		}
+
+		// Get every second bit of every 32-bit lane (2D, 32-bit morton codes)
+		LIBMORTON_TARGET("avx2") inline __m256i getSecondBits_epi32(__m256i m) noexcept {
+			__m256i x = _mm256_and_si256(m, _mm256_set1_epi32(0x55555555));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi32(x, 1)), _mm256_set1_epi32(0x33333333));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi32(x, 2)), _mm256_set1_epi32(0x0F0F0F0F));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi32(x, 4)), _mm256_set1_epi32(0x00FF00FF));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi32(x, 8)), _mm256_set1_epi32(0x0000FFFF));
+			return x;
+		}
+
+		// Get every second bit of every 64-bit lane (2D, 64-bit morton codes)
+		LIBMORTON_TARGET("avx2") inline __m256i getSecondBits_epi64(__m256i m) noexcept {
+			__m256i x = _mm256_and_si256(m, _mm256_set1_epi64x(0x5555555555555555));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi64(x, 1)), _mm256_set1_epi64x(0x3333333333333333));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi64(x, 2)), _mm256_set1_epi64x(0x0F0F0F0F0F0F0F0F));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi64(x, 4)), _mm256_set1_epi64x(0x00FF00FF00FF00FF));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi64(x, 8)), _mm256_set1_epi64x(0x0000FFFF0000FFFF));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi64(x, 16)), _mm256_set1_epi64x(0x00000000FFFFFFFF));
+			return x;
+		}
+
+		// Get every third bit of every 32-bit lane (3D, 32-bit morton codes)
+		LIBMORTON_TARGET("avx2") inline __m256i getThirdBits_epi32(__m256i m) noexcept {
+			__m256i x = _mm256_and_si256(m, _mm256_set1_epi32(0x09249249));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi32(x, 2)), _mm256_set1_epi32(0x030C30C3));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi32(x, 4)), _mm256_set1_epi32(0x0300F00F));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi32(x, 8)), _mm256_set1_epi32(0x030000FF));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi32(x, 16)), _mm256_set1_epi32(0x000003FF));
+			return x;
+		}
+
+		// Get every third bit of every 64-bit lane (3D, 64-bit morton codes)
+		LIBMORTON_TARGET("avx2") inline __m256i getThirdBits_epi64(__m256i m) noexcept {
+			__m256i x = _mm256_and_si256(m, _mm256_set1_epi64x(0x1249249249249249));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi64(x, 2)), _mm256_set1_epi64x(0x10C30C30C30C30C3));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi64(x, 4)), _mm256_set1_epi64x(0x100F00F00F00F00F));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi64(x, 8)), _mm256_set1_epi64x(0x1F0000FF0000FF));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi64(x, 16)), _mm256_set1_epi64x(0x1F00000000FFFF));
+			x = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi64(x, 32)), _mm256_set1_epi64x(0x1FFFFF));
+			return x;
+		}
+
+		// Zero-extend 8 16-bit coordinates to 32-bit lanes
+		LIBMORTON_TARGET("avx2") inline __m256i load_epu16_epi32(const uint16_t* c) noexcept {
+			return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(c)));
+		}
+
+		// Zero-extend 4 32-bit coordinates to 64-bit lanes
+		LIBMORTON_TARGET("avx2") inline __m256i load_epu32_epi64(const uint32_t* c) noexcept {
+			return _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(c)));
+		}
+
+		// Narrow 8 32-bit lanes (each holding at most 16 bits) to 8 16-bit coordinates
+		LIBMORTON_TARGET("avx2") inline void store_epi32_epu16(uint16_t* c, __m256i v) noexcept {
+			__m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), 0x08);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(c), _mm256_castsi256_si128(packed));
+		}
+
+		// Narrow 4 64-bit lanes (each holding at most 32 bits) to 4 32-bit coordinates
+		LIBMORTON_TARGET("avx2") inline void store_epi64_epu32(uint32_t* c, __m256i v) noexcept {
+			__m256i packed = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(c), _mm256_castsi256_si128(packed));
+		}
+	}  // namespace avx2_detail
+
+	// ENCODE 2D 32-bit morton codes (batch) : AVX2
+	LIBMORTON_TARGET("avx2") inline void m2D_e_AVX2(const uint16_t* x, const uint16_t* y, uint32_t* out, size_t n) {
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256i mx = avx2_detail::splitBy2bits_epi32(avx2_detail::load_epu16_epi32(x + i));
+			__m256i my = avx2_detail::splitBy2bits_epi32(avx2_detail::load_epu16_epi32(y + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_or_si256(mx, _mm256_slli_epi32(my, 1)));
+		}
+		for (; i < n; ++i) {
+			out[i] = static_cast<uint32_t>(m2D_e_magicbits<uint_fast32_t, uint_fast16_t>(x[i], y[i]));
+		}
+	}
+
+	// ENCODE 2D 64-bit morton codes (batch) : AVX2
+	LIBMORTON_TARGET("avx2") inline void m2D_e_AVX2(const uint32_t* x, const uint32_t* y, uint64_t* out, size_t n) {
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m256i mx = avx2_detail::splitBy2bits_epi64(avx2_detail::load_epu32_epi64(x + i));
+			__m256i my = avx2_detail::splitBy2bits_epi64(avx2_detail::load_epu32_epi64(y + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_or_si256(mx, _mm256_slli_epi64(my, 1)));
+		}
+		for (; i < n; ++i) {
+			out[i] = static_cast<uint64_t>(m2D_e_magicbits<uint_fast64_t, uint_fast32_t>(x[i], y[i]));
+		}
+	}
+
+	// ENCODE 3D 32-bit morton codes (batch) : AVX2
+	LIBMORTON_TARGET("avx2") inline void m3D_e_AVX2(const uint16_t* x, const uint16_t* y, const uint16_t* z, uint32_t* out, size_t n) {
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256i mx = avx2_detail::splitBy3bits_epi32(avx2_detail::load_epu16_epi32(x + i));
+			__m256i my = avx2_detail::splitBy3bits_epi32(avx2_detail::load_epu16_epi32(y + i));
+			__m256i mz = avx2_detail::splitBy3bits_epi32(avx2_detail::load_epu16_epi32(z + i));
+			__m256i m = _mm256_or_si256(mx, _mm256_or_si256(_mm256_slli_epi32(my, 1), _mm256_slli_epi32(mz, 2)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), m);
+		}
+		for (; i < n; ++i) {
+			out[i] = static_cast<uint32_t>(m3D_e_magicbits<uint_fast32_t, uint_fast16_t>(x[i], y[i], z[i]));
+		}
+	}
+
+	// ENCODE 3D 64-bit morton codes (batch) : AVX2
+	LIBMORTON_TARGET("avx2") inline void m3D_e_AVX2(const uint32_t* x, const uint32_t* y, const uint32_t* z, uint64_t* out, size_t n) {
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m256i mx = avx2_detail::splitBy3bits_epi64(avx2_detail::load_epu32_epi64(x + i));
+			__m256i my = avx2_detail::splitBy3bits_epi64(avx2_detail::load_epu32_epi64(y + i));
+			__m256i mz = avx2_detail::splitBy3bits_epi64(avx2_detail::load_epu32_epi64(z + i));
+			__m256i m = _mm256_or_si256(mx, _mm256_or_si256(_mm256_slli_epi64(my, 1), _mm256_slli_epi64(mz, 2)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), m);
+		}
+		for (; i < n; ++i) {
+			out[i] = static_cast<uint64_t>(m3D_e_magicbits<uint_fast64_t, uint_fast32_t>(x[i], y[i], z[i]));
+		}
+	}
+
+	// DECODE 2D 32-bit morton codes (batch) : AVX2
+	LIBMORTON_TARGET("avx2") inline void m2D_d_AVX2(const uint32_t* m, uint16_t* x, uint16_t* y, size_t n) {
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256i codes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m + i));
+			avx2_detail::store_epi32_epu16(x + i, avx2_detail::getSecondBits_epi32(codes));
+			avx2_detail::store_epi32_epu16(y + i, avx2_detail::getSecondBits_epi32(_mm256_srli_epi32(codes, 1)));
+		}
+		for (; i < n; ++i) {
+			uint_fast16_t xi, yi;
+			m2D_d_magicbits<uint_fast32_t, uint_fast16_t>(m[i], xi, yi);
+			x[i] = static_cast<uint16_t>(xi); y[i] = static_cast<uint16_t>(yi);
+		}
+	}
+
+	// DECODE 2D 64-bit morton codes (batch) : AVX2
+	LIBMORTON_TARGET("avx2") inline void m2D_d_AVX2(const uint64_t* m, uint32_t* x, uint32_t* y, size_t n) {
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m256i codes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m + i));
+			avx2_detail::store_epi64_epu32(x + i, avx2_detail::getSecondBits_epi64(codes));
+			avx2_detail::store_epi64_epu32(y + i, avx2_detail::getSecondBits_epi64(_mm256_srli_epi64(codes, 1)));
+		}
+		for (; i < n; ++i) {
+			uint_fast32_t xi, yi;
+			m2D_d_magicbits<uint_fast64_t, uint_fast32_t>(m[i], xi, yi);
+			x[i] = static_cast<uint32_t>(xi); y[i] = static_cast<uint32_t>(yi);
+		}
+	}
+
+	// DECODE 3D 32-bit morton codes (batch) : AVX2
+	LIBMORTON_TARGET("avx2") inline void m3D_d_AVX2(const uint32_t* m, uint16_t* x, uint16_t* y, uint16_t* z, size_t n) {
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256i codes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m + i));
+			avx2_detail::store_epi32_epu16(x + i, avx2_detail::getThirdBits_epi32(codes));
+			avx2_detail::store_epi32_epu16(y + i, avx2_detail::getThirdBits_epi32(_mm256_srli_epi32(codes, 1)));
+			avx2_detail::store_epi32_epu16(z + i, avx2_detail::getThirdBits_epi32(_mm256_srli_epi32(codes, 2)));
+		}
+		for (; i < n; ++i) {
+			uint_fast16_t xi, yi, zi;
+			m3D_d_magicbits<uint_fast32_t, uint_fast16_t>(m[i] & 0x3FFFFFFF, xi, yi, zi); // 10 bits per coordinate, like the vector lanes
+			x[i] = static_cast<uint16_t>(xi); y[i] = static_cast<uint16_t>(yi); z[i] = static_cast<uint16_t>(zi);
+		}
+	}
+
+	// DECODE 3D 64-bit morton codes (batch) : AVX2
+	LIBMORTON_TARGET("avx2") inline void m3D_d_AVX2(const uint64_t* m, uint32_t* x, uint32_t* y, uint32_t* z, size_t n) {
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m256i codes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m + i));
+			avx2_detail::store_epi64_epu32(x + i, avx2_detail::getThirdBits_epi64(codes));
+			avx2_detail::store_epi64_epu32(y + i, avx2_detail::getThirdBits_epi64(_mm256_srli_epi64(codes, 1)));
+			avx2_detail::store_epi64_epu32(z + i, avx2_detail::getThirdBits_epi64(_mm256_srli_epi64(codes, 2)));
+		}
+		for (; i < n; ++i) {
+			uint_fast32_t xi, yi, zi;
+			m3D_d_magicbits<uint_fast64_t, uint_fast32_t>(m[i], xi, yi, zi);
+			x[i] = static_cast<uint32_t>(xi); y[i] = static_cast<uint32_t>(yi); z[i] = static_cast<uint32_t>(zi);
+		}
+	}
+
+	namespace avx2_detail {
+		// Boundary flags (see morton_neighbors.h) of code l, from the masks of the codes where each coordinate is 0 / the largest
+		inline unsigned int boundary_flags(const int lo[3], const int hi[3], const unsigned int l) {
+			unsigned int flags = 0;
+			for (unsigned int axis = 0; axis < 3; ++axis) {
+				flags |= (((lo[axis] >> l) & 1) | (((hi[axis] >> l) & 1) << 1)) << (2 * axis);
+			}
+			return flags;
+		}
+	}
+
+	// NEIGHBORS of 3D 32-bit morton codes (batch) : AVX2
+	LIBMORTON_TARGET("avx2") inline void m3D_neighbors_AVX2(const uint32_t* m, size_t n, const morton_stencil stencil, const uint32_t max_code, uint32_t* out, uint32_t* valid) {
+		const neighbors_detail::stencil_table& t = neighbors_detail::stencil_LUT<>::table;
+		const unsigned int k = static_cast<unsigned int>(stencil);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256i codes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m + i));
+			__m256i steps[3][3];
+			int lo[3], hi[3];
+			for (unsigned int axis = 0; axis < 3; ++axis) {
+				const uint32_t lane = dilated_detail::lane<uint32_t, 3>(axis);
+				const __m256i one = _mm256_set1_epi32(1 << axis);
+				const __m256i c = _mm256_and_si256(codes, _mm256_set1_epi32(static_cast<int>(lane)));
+				steps[axis][0] = _mm256_and_si256(_mm256_sub_epi32(c, one), _mm256_set1_epi32(static_cast<int>(lane)));
+				steps[axis][1] = c;
+				steps[axis][2] = _mm256_and_si256(_mm256_add_epi32(_mm256_or_si256(codes, _mm256_set1_epi32(static_cast<int>(~lane))), one), _mm256_set1_epi32(static_cast<int>(lane)));
+				// Coordinates use at most 30 bits, so the signed compare works
+				lo[axis] = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(c, _mm256_setzero_si256())));
+				hi[axis] = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(max_code & lane)), c)));
+			}
+			for (unsigned int j = 0; j < k; ++j) {
+				const int8_t* d = t.offset[j];
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + j * n + i), _mm256_or_si256(_mm256_or_si256(steps[0][d[0] + 1], steps[1][d[1] + 1]), steps[2][d[2] + 1]));
+			}
+			for (unsigned int l = 0; l < 8; ++l) {
+				valid[i + l] = t.valid[avx2_detail::boundary_flags(lo, hi, l)] & ((1u << k) - 1);
+			}
+		}
+		neighbors_detail::neighbors<uint32_t>(m, i, n, stencil, max_code, out, valid);
+	}
+
+	// NEIGHBORS of 3D 64-bit morton codes (batch) : AVX2
+	LIBMORTON_TARGET("avx2") inline void m3D_neighbors_AVX2(const uint64_t* m, size_t n, const morton_stencil stencil, const uint64_t max_code, uint64_t* out, uint32_t* valid) {
+		const neighbors_detail::stencil_table& t = neighbors_detail::stencil_LUT<>::table;
+		const unsigned int k = static_cast<unsigned int>(stencil);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m256i codes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m + i));
+			__m256i steps[3][3];
+			int lo[3], hi[3];
+			for (unsigned int axis = 0; axis < 3; ++axis) {
+				const uint64_t lane = dilated_detail::lane<uint64_t, 3>(axis);
+				const __m256i one = _mm256_set1_epi64x(int64_t(1) << axis);
+				const __m256i c = _mm256_and_si256(codes, _mm256_set1_epi64x(static_cast<int64_t>(lane)));
+				steps[axis][0] = _mm256_and_si256(_mm256_sub_epi64(c, one), _mm256_set1_epi64x(static_cast<int64_t>(lane)));
+				steps[axis][1] = c;
+				steps[axis][2] = _mm256_and_si256(_mm256_add_epi64(_mm256_or_si256(codes, _mm256_set1_epi64x(static_cast<int64_t>(~lane))), one), _mm256_set1_epi64x(static_cast<int64_t>(lane)));
+				// Coordinates use at most 63 bits, so the signed compare works
+				lo[axis] = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(c, _mm256_setzero_si256())));
+				hi[axis] = ~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<int64_t>(max_code & lane)), c)));
+			}
+			for (unsigned int j = 0; j < k; ++j) {
+				const int8_t* d = t.offset[j];
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + j * n + i), _mm256_or_si256(_mm256_or_si256(steps[0][d[0] + 1], steps[1][d[1] + 1]), steps[2][d[2] + 1]));
+			}
+			for (unsigned int l = 0; l < 4; ++l) {
+				valid[i + l] = t.valid[avx2_detail::boundary_flags(lo, hi, l)] & ((1u << k) - 1);
+			}
+		}
+		neighbors_detail::neighbors<uint64_t>(m, i, n, stencil, max_code, out, valid);
+	}
+}
+#endif
@@ -1,60 +1,108 @@
 #pragma once
-#if defined(__BMI2__) || __AVX2__
+#include "morton_common.h"
+#if defined(__BMI2__) || __AVX2__ || LIBMORTON_X86_DISPATCH
 #include <immintrin.h>
 #include <stdint.h>
 
 namespace libmorton {
 
 	namespace bmi2_detail {
-		inline uint32_t pdep(uint32_t source, uint32_t mask) noexcept {
+		LIBMORTON_TARGET("bmi2") inline uint32_t pdep(uint32_t source, uint32_t mask) noexcept {
 			return _pdep_u32(source, mask);
 		}
-		inline uint64_t pdep(uint64_t source, uint64_t mask) noexcept {
+		LIBMORTON_TARGET("bmi2") inline uint64_t pdep(uint64_t source, uint64_t mask) noexcept {
 			return _pdep_u64(source, mask);
 		}
-		inline uint32_t pext(uint32_t source, uint32_t mask) noexcept {
+		LIBMORTON_TARGET("bmi2") inline uint32_t pext(uint32_t source, uint32_t mask) noexcept {
 			return _pext_u32(source, mask);
 		}
-		inline uint64_t pext(uint64_t source, uint64_t mask) noexcept {
+		LIBMORTON_TARGET("bmi2") inline uint64_t pext(uint64_t source, uint64_t mask) noexcept {
 			return _pext_u64(source, mask);
 		}
+#if LIBMORTON_HAS_UINT128
+		// 128-bit codes: one pdep/pext per 64-bit half, the high half takes the bits the low half's mask has no room for
+		LIBMORTON_TARGET("bmi2") inline morton128_t pdep(morton128_t source, morton128_t mask) noexcept {
+			const uint64_t mask_lo = static_cast<uint64_t>(mask);
+			const uint64_t lo = _pdep_u64(static_cast<uint64_t>(source), mask_lo);
+			const uint64_t hi = _pdep_u64(static_cast<uint64_t>(source >> __builtin_popcountll(mask_lo)), static_cast<uint64_t>(mask >> 64));
+			return (static_cast<morton128_t>(hi) << 64) | lo;
+		}
+		LIBMORTON_TARGET("bmi2") inline morton128_t pext(morton128_t source, morton128_t mask) noexcept {
+			const uint64_t mask_lo = static_cast<uint64_t>(mask);
+			const uint64_t lo = _pext_u64(static_cast<uint64_t>(source), mask_lo);
+			const uint64_t hi = _pext_u64(static_cast<uint64_t>(source >> 64), static_cast<uint64_t>(mask >> 64));
+			return (static_cast<morton128_t>(hi) << __builtin_popcountll(mask_lo)) | lo;
+		}
+#endif
 	}  // namespace bmi2_detail
 
 #define BMI_2D_X_MASK 0x5555555555555555
 #define BMI_2D_Y_MASK 0xAAAAAAAAAAAAAAAA
+#define BMI_3D_X_MASK 0x9249249249249249
+#define BMI_3D_Y_MASK 0x2492492492492492
+#define BMI_3D_Z_MASK 0x4924924924924924
+
+	namespace bmi2_detail {
+		// Bits of every axis in a morton code
+		template<typename morton>
+		struct masks {
+			static constexpr morton x2D = static_cast<morton>(BMI_2D_X_MASK);
+			static constexpr morton y2D = static_cast<morton>(BMI_2D_Y_MASK);
+			static constexpr morton x3D = static_cast<morton>(BMI_3D_X_MASK);
+			static constexpr morton y3D = static_cast<morton>(BMI_3D_Y_MASK);
+			static constexpr morton z3D = static_cast<morton>(BMI_3D_Z_MASK);
+		};
+		template<typename morton> constexpr morton masks<morton>::x2D;
+		template<typename morton> constexpr morton masks<morton>::y2D;
+		template<typename morton> constexpr morton masks<morton>::x3D;
+		template<typename morton> constexpr morton masks<morton>::y3D;
+		template<typename morton> constexpr morton masks<morton>::z3D;
+#if LIBMORTON_HAS_UINT128
+		// 128-bit codes hold 64 bits per axis in 2D, 42 in 3D
+		template<>
+		struct masks<morton128_t> {
+			static constexpr morton128_t x2D = magicbits_detail::masks<morton128_t, 2>::spread;
+			static constexpr morton128_t y2D = magicbits_detail::masks<morton128_t, 2>::spread << 1;
+			static constexpr morton128_t x3D = magicbits_detail::masks<morton128_t, 3>::spread;
+			static constexpr morton128_t y3D = magicbits_detail::masks<morton128_t, 3>::spread << 1;
+			static constexpr morton128_t z3D = magicbits_detail::masks<morton128_t, 3>::spread << 2;
+		};
+		constexpr morton128_t masks<morton128_t>::x2D;
+		constexpr morton128_t masks<morton128_t>::y2D;
+		constexpr morton128_t masks<morton128_t>::x3D;
+		constexpr morton128_t masks<morton128_t>::y3D;
+		constexpr morton128_t masks<morton128_t>::z3D;
+#endif
+	}  // namespace bmi2_detail
 
 	template<typename morton, typename coord>
-	inline morton m2D_e_BMI(const coord x, const coord y) {
+	LIBMORTON_TARGET("bmi2") inline morton m2D_e_BMI(const coord x, const coord y) {
 		morton m = 0;
-		m |= bmi2_detail::pdep(static_cast<morton>(x), static_cast<morton>(BMI_2D_X_MASK))
-			| bmi2_detail::pdep(static_cast<morton>(y), static_cast<morton>(BMI_2D_Y_MASK));
+		m |= bmi2_detail::pdep(static_cast<morton>(x), bmi2_detail::masks<morton>::x2D)
+			| bmi2_detail::pdep(static_cast<morton>(y), bmi2_detail::masks<morton>::y2D);
 		return m;
 	}
 
 	template<typename morton, typename coord>
-	inline void m2D_d_BMI(const morton m, coord& x, coord& y) {
-		x = static_cast<coord>(bmi2_detail::pext(m, static_cast<morton>(BMI_2D_X_MASK)));
-		y = static_cast<coord>(bmi2_detail::pext(m, static_cast<morton>(BMI_2D_Y_MASK)));
+	LIBMORTON_TARGET("bmi2") inline void m2D_d_BMI(const morton m, coord& x, coord& y) {
+		x = static_cast<coord>(bmi2_detail::pext(m, bmi2_detail::masks<morton>::x2D));
+		y = static_cast<coord>(bmi2_detail::pext(m, bmi2_detail::masks<morton>::y2D));
 	}
 
-#define BMI_3D_X_MASK 0x9249249249249249
-#define BMI_3D_Y_MASK 0x2492492492492492
-#define BMI_3D_Z_MASK 0x4924924924924924
-
 	template<typename morton, typename coord>
-	inline morton m3D_e_BMI(const coord x, const coord y, const coord z) {
+	LIBMORTON_TARGET("bmi2") inline morton m3D_e_BMI(const coord x, const coord y, const coord z) {
 		morton m = 0;
-		m |= bmi2_detail::pdep(static_cast<morton>(x), static_cast<morton>(BMI_3D_X_MASK))
-			| bmi2_detail::pdep(static_cast<morton>(y), static_cast<morton>(BMI_3D_Y_MASK))
-			| bmi2_detail::pdep(static_cast<morton>(z), static_cast<morton>(BMI_3D_Z_MASK));
+		m |= bmi2_detail::pdep(static_cast<morton>(x), bmi2_detail::masks<morton>::x3D)
+			| bmi2_detail::pdep(static_cast<morton>(y), bmi2_detail::masks<morton>::y3D)
+			| bmi2_detail::pdep(static_cast<morton>(z), bmi2_detail::masks<morton>::z3D);
 		return m;
 	}
 
 	template<typename morton, typename coord>
-	inline void m3D_d_BMI(const morton m, coord& x, coord& y, coord& z) {
-		x = static_cast<coord>(bmi2_detail::pext(m, static_cast<morton>(BMI_3D_X_MASK)));
-		y = static_cast<coord>(bmi2_detail::pext(m, static_cast<morton>(BMI_3D_Y_MASK)));
-		z = static_cast<coord>(bmi2_detail::pext(m, static_cast<morton>(BMI_3D_Z_MASK)));
+	LIBMORTON_TARGET("bmi2") inline void m3D_d_BMI(const morton m, coord& x, coord& y, coord& z) {
+		x = static_cast<coord>(bmi2_detail::pext(m, bmi2_detail::masks<morton>::x3D));
+		y = static_cast<coord>(bmi2_detail::pext(m, bmi2_detail::masks<morton>::y3D));
+		z = static_cast<coord>(bmi2_detail::pext(m, bmi2_detail::masks<morton>::z3D));
 	}
 }
 #endif
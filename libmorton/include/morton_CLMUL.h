@@ -0,0 +1,50 @@
+#pragma once
+
+// Libmorton - Methods to encode 2D morton codes using carry-less multiplication (PCLMULQDQ)
+// Squaring a polynomial over GF(2) doubles the exponent of every term, so the carry-less square of a coordinate
+// has its bits spread one position apart, just like morton2D_SplitBy2Bits does in 5 shift-and-mask stages.
+// This pays off on CPUs with fast pclmulqdq but microcoded pdep/pext (AMD Zen1/Zen2).
+//
+// There are no 3D or decode methods: a carry-less product can only double bit positions (spreading by 3 is
+// not a product), and gathering the bits back (a square root) is not a product either.
+
+#include "morton_common.h"
+#if LIBMORTON_X86_DISPATCH
+#include <immintrin.h>
+#include <stdint.h>
+
+namespace libmorton {
+
+	namespace clmul_detail {
+		// Morton code in the low bits of v
+		template<typename morton>
+		inline morton to_morton(const __m128i v) {
+			return static_cast<morton>(_mm_cvtsi128_si64(v));
+		}
+#if LIBMORTON_HAS_UINT128
+		template<>
+		inline morton128_t to_morton<morton128_t>(const __m128i v) {
+			const uint64_t lo = static_cast<uint64_t>(_mm_cvtsi128_si64(v));
+			const uint64_t hi = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v)));
+			return (static_cast<morton128_t>(hi) << 64) | lo;
+		}
+#endif
+	}
+
+	// ENCODE 2D Morton code : Carry-less squaring
+	// x goes in the low, y in the high half of one register, then each half is squared.
+	// The square of a 64-bit coordinate fills both halves of the result (128-bit morton codes).
+	template<typename morton, typename coord>
+	LIBMORTON_TARGET("pclmul") inline morton m2D_e_CLMUL(const coord x, const coord y) {
+		static_assert(sizeof(morton) <= 16, "CLMUL methods encode up to 128-bit morton codes");
+		const uint64_t coord_mask = static_cast<uint64_t>(magicbits_detail::masks<morton, 2>::coord);
+		const __m128i v = _mm_set_epi64x(static_cast<int64_t>(y & coord_mask), static_cast<int64_t>(x & coord_mask));
+		const __m128i xx = _mm_clmulepi64_si128(v, v, 0x00);
+		const __m128i yy = _mm_clmulepi64_si128(v, v, 0x11);
+		// Shift yy left by one bit; only a 128-bit code has a bit to carry from the low into the high half
+		__m128i yy_shifted = _mm_slli_epi64(yy, 1);
+		if (sizeof(morton) > 8) { yy_shifted = _mm_or_si128(yy_shifted, _mm_srli_epi64(_mm_slli_si128(yy, 8), 63)); }
+		return clmul_detail::to_morton<morton>(_mm_or_si128(xx, yy_shifted));
+	}
+}
+#endif
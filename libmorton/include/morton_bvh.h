@@ -0,0 +1,203 @@
+#pragma once
+
+// Libmorton - Linear bounding volume hierarchy (LBVH) over sorted morton codes
+// The hierarchy is the binary radix tree of the sorted codes (Karras, "Maximizing Parallelism in the Construction of
+// BVHs, Octrees, and k-d Trees", 2012): n leaves, one per code, and n - 1 internal nodes. Internal node i covers a
+// range of leaves which starts or ends at leaf i, and splits it where the highest bit which differs between its
+// codes changes. Every internal node is found on its own from the codes around it, so they are all found in parallel.
+// Equal codes are told apart by their position, as if it were appended to the code.
+//
+// Boxes are fitted from the leaves up: the thread which finishes the second child of a node fits the node, and goes
+// on with its parent (an atomic counter per node tells which thread came second).
+//
+// Nodes are 32 bytes for float boxes (two per cache line), and the children of a node are next to each other.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "morton_parallel.h"
+#include "morton_quantize.h"
+#include "morton_sort.h"
+#include "morton_tree.h"
+
+namespace libmorton {
+	// Children with this bit set are leaves (the index of the leaf in the other bits), others are internal nodes
+	static const uint32_t morton_bvh_leaf = 0x80000000u;
+
+	// Internal node of a bounding volume hierarchy: its box, and its two children
+	template<typename real>
+	struct morton_bvh_node {
+		morton_aabb<real, 3> box;
+		uint32_t child[2];
+	};
+
+	// Bounding volume hierarchy over n < 2^31 primitives: n - 1 internal nodes and n leaves (leaf i holds code i of
+	// the sorted codes). node 0 is the root, unless there is only one leaf.
+	template<typename real = float, typename morton = uint64_t>
+	struct morton_bvh {
+		std::vector<morton_bvh_node<real>> nodes; // internal nodes
+		std::vector<uint32_t> parents;            // parent of internal node i at i (0 for the root), of leaf i at n - 1 + i
+		std::vector<uint32_t> primitives;         // primitive of every leaf
+		std::vector<morton> codes;                // sorted codes of the leaves (by morton_build_bvh)
+
+		size_t leaves() const { return primitives.size(); }
+		uint32_t root() const { return nodes.empty() ? morton_bvh_leaf : 0; }
+
+		// Visit counters of the internal nodes, while fitting boxes
+		std::unique_ptr<std::atomic<uint32_t>[]> visits;
+		size_t visits_size = 0;
+	};
+
+	namespace bvh_detail {
+		// Length of the common prefix of the codes of leaves i and j, and of i and j after it for equal codes (-1 if j
+		// is not a leaf)
+		template<typename morton>
+		inline int delta(const morton* codes, const int64_t n, const int64_t i, const int64_t j) {
+			static const int bits = static_cast<int>(sizeof(morton) * 8);
+			if (j < 0 || j >= n) { return -1; }
+			const morton x = static_cast<morton>(codes[i] ^ codes[j]);
+			return x != 0 ? bits - static_cast<int>(tree_detail::significant_bits(x))
+				: bits + 64 - static_cast<int>(tree_detail::significant_bits(static_cast<uint64_t>(i ^ j)));
+		}
+
+		// Children of internal node i: the direction of its range, its other end, then the split of the range
+		template<typename morton, typename real>
+		inline void node(const morton* codes, const int64_t n, const int64_t i, morton_bvh_node<real>* nodes, uint32_t* parents) {
+			const int64_t d = delta(codes, n, i, i + 1) > delta(codes, n, i, i - 1) ? 1 : -1;
+			const int minimum = delta(codes, n, i, i - d);
+			int64_t length = 2;
+			while (delta(codes, n, i, i + length * d) > minimum) { length *= 2; }
+			int64_t l = 0;
+			for (int64_t t = length / 2; t >= 1; t /= 2) {
+				if (delta(codes, n, i, i + (l + t) * d) > minimum) { l += t; }
+			}
+			const int64_t j = i + l * d;
+			const int prefix = delta(codes, n, i, j);
+			int64_t s = 0;
+			for (int64_t t = l; t > 1;) {
+				t = (t + 1) / 2;
+				if (delta(codes, n, i, i + (s + t) * d) > prefix) { s += t; }
+			}
+			const int64_t split = i + s * d + std::min<int64_t>(d, 0);
+			const uint32_t left = static_cast<uint32_t>(split), right = static_cast<uint32_t>(split + 1);
+			const bool left_leaf = std::min(i, j) == split, right_leaf = std::max(i, j) == split + 1;
+			nodes[i].child[0] = left_leaf ? left | morton_bvh_leaf : left;
+			nodes[i].child[1] = right_leaf ? right | morton_bvh_leaf : right;
+			parents[left_leaf ? n - 1 + left : left] = static_cast<uint32_t>(i);
+			parents[right_leaf ? n - 1 + right : right] = static_cast<uint32_t>(i);
+		}
+
+		template<typename real>
+		inline void merge(morton_aabb<real, 3>& box, const morton_aabb<real, 3>& other) {
+			for (size_t d = 0; d < 3; ++d) {
+				box.lo[d] = std::min(box.lo[d], other.lo[d]);
+				box.hi[d] = std::max(box.hi[d], other.hi[d]);
+			}
+		}
+
+		// Internal nodes of the radix tree of n sorted codes
+		template<typename real, typename morton>
+		inline void build_tree(const morton* codes, const size_t n, morton_bvh<real, morton>& bvh, morton_executor& executor) {
+			bvh.nodes.resize(n > 0 ? n - 1 : 0);
+			bvh.parents.resize(n > 0 ? 2 * n - 1 : 0);
+			if (n < 2) { return; }
+			bvh.parents[0] = 0;
+			morton_parallel_for(n - 1, [&](const size_t begin, const size_t end) {
+				for (size_t i = begin; i < end; ++i) {
+					node(codes, static_cast<int64_t>(n), static_cast<int64_t>(i), bvh.nodes.data(), bvh.parents.data());
+				}
+			}, executor);
+		}
+	}
+
+	// BUILD RADIX TREE : internal nodes of the hierarchy over n sorted morton codes (uint32_t for 30-bit 3D codes,
+	// uint64_t for 63-bit ones), without boxes (see morton_bvh_refit). primitives: primitive of every leaf, as returned
+	// by morton_sort (nullptr: leaf i is primitive i).
+	template<typename real, typename morton>
+	inline void morton_bvh_build_tree(const morton* codes, const uint32_t* primitives, const size_t n, morton_bvh<real, morton>& bvh, morton_executor& executor = default_executor()) {
+		bvh.primitives.resize(n);
+		morton_parallel_for(n, [&](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; ++i) { bvh.primitives[i] = primitives != nullptr ? primitives[i] : static_cast<uint32_t>(i); }
+		}, executor);
+		bvh_detail::build_tree(codes, n, bvh, executor);
+	}
+
+	// REFIT : boxes of the internal nodes, from the boxes of the primitives (after moving them, the tree stays valid
+	// but gets looser)
+	template<typename real, typename morton>
+	inline void morton_bvh_refit(morton_bvh<real, morton>& bvh, const morton_aabb<real, 3>* boxes, morton_executor& executor = default_executor()) {
+		const size_t n = bvh.leaves(), internal = bvh.nodes.size();
+		if (internal == 0) { return; }
+		if (bvh.visits_size < internal) {
+			bvh.visits.reset(new std::atomic<uint32_t>[internal]);
+			bvh.visits_size = internal;
+		}
+		std::atomic<uint32_t>* visits = bvh.visits.get();
+		morton_parallel_for(internal, [&](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; ++i) { visits[i].store(0, std::memory_order_relaxed); }
+		}, executor);
+		morton_parallel_for(n, [&](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				// The first thread to reach a node leaves, the second one sees the box of the first child
+				for (uint32_t node = bvh.parents[internal + i]; visits[node].fetch_add(1, std::memory_order_acq_rel) != 0; node = bvh.parents[node]) {
+					morton_bvh_node<real>& current = bvh.nodes[node];
+					const uint32_t left = current.child[0], right = current.child[1];
+					morton_aabb<real, 3> box = left & morton_bvh_leaf ? boxes[bvh.primitives[left & ~morton_bvh_leaf]] : bvh.nodes[left].box;
+					bvh_detail::merge(box, right & morton_bvh_leaf ? boxes[bvh.primitives[right & ~morton_bvh_leaf]] : bvh.nodes[right].box);
+					current.box = box;
+					if (node == 0) { break; }
+				}
+			}
+		}, executor);
+	}
+
+	// BUILD BVH : hierarchy over n primitives given by their boxes. The centers of the boxes are quantized in the box
+	// around them and encoded to 3D morton codes (30-bit for uint32_t, 63-bit for uint64_t), sorted, and the tree of
+	// the sorted codes is built and fitted. bvh keeps its memory from one build to the next.
+	template<typename morton = uint64_t, typename real>
+	inline void morton_build_bvh(const morton_aabb<real, 3>* boxes, const size_t n, morton_bvh<real, morton>& bvh, morton_executor& executor = default_executor()) {
+		// Box around the centers
+		morton_aabb<real, 3> empty;
+		for (size_t d = 0; d < 3; ++d) {
+			empty.lo[d] = std::numeric_limits<real>::max();
+			empty.hi[d] = std::numeric_limits<real>::lowest();
+		}
+		morton_aabb<real, 3> bounds = empty;
+		std::mutex lock;
+		morton_parallel_for(n, [&](const size_t begin, const size_t end) {
+			morton_aabb<real, 3> local = empty;
+			for (size_t i = begin; i < end; ++i) {
+				for (size_t d = 0; d < 3; ++d) {
+					const real center = (boxes[i].lo[d] + boxes[i].hi[d]) / 2;
+					local.lo[d] = std::min(local.lo[d], center);
+					local.hi[d] = std::max(local.hi[d], center);
+				}
+			}
+			std::lock_guard<std::mutex> guard(lock);
+			bvh_detail::merge(bounds, local);
+		}, executor);
+
+		// Codes of the centers, a block at a time, then sorted
+		bvh.codes.resize(n);
+		bvh.primitives.resize(n);
+		morton_parallel_for(n, [&](const size_t begin, const size_t end) {
+			real centers[3 * quantize_detail::block];
+			for (size_t b = begin; b < end; b += quantize_detail::block) {
+				const size_t count = std::min(end - b, quantize_detail::block);
+				for (size_t i = 0; i < count; ++i) {
+					for (size_t d = 0; d < 3; ++d) { centers[3 * i + d] = (boxes[b + i].lo[d] + boxes[b + i].hi[d]) / 2; }
+				}
+				m3D_quantize_encode<morton, real>(centers, 3, bounds, bvh.codes.data() + b, count);
+			}
+		}, executor);
+		morton_sort<morton, uint32_t>(bvh.codes.data(), bvh.primitives.data(), n, 0, executor);
+
+		bvh_detail::build_tree(bvh.codes.data(), n, bvh, executor);
+		morton_bvh_refit(bvh, boxes, executor);
+	}
+}
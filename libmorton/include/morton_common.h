@@ -7,7 +7,32 @@
 #include <intrin.h>
 #endif
 
+// On 64-bit x86 with GCC, Clang or MSVC, methods using instruction set extensions (BMI2, AVX2) are compiled
+// for their own target, so they are available even when the including code is built for baseline x86-64.
+// Only call them after checking the host CPU supports them (see morton_dispatch.h).
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define LIBMORTON_X86_DISPATCH 1
+#define LIBMORTON_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define LIBMORTON_X86_DISPATCH 1
+#define LIBMORTON_TARGET(isa)
+#else
+#define LIBMORTON_X86_DISPATCH 0
+#define LIBMORTON_TARGET(isa)
+#endif
+
+// 128-bit morton codes (2D coordinates up to 64 bits, 3D up to 42 bits) where the compiler has a 128-bit integer
+#if defined(__SIZEOF_INT128__)
+#define LIBMORTON_HAS_UINT128 1
+#else
+#define LIBMORTON_HAS_UINT128 0
+#endif
+
 namespace libmorton {
+#if LIBMORTON_HAS_UINT128
+	__extension__ typedef unsigned __int128 morton128_t;
+#endif
+
 	template<typename morton>
 	inline bool findFirstSetBitZeroIdx(const morton x, unsigned long* firstbit_location) {
 #if _MSC_VER && !_WIN64
@@ -32,12 +57,23 @@ namespace libmorton {
 			return false;
 		}
 		else {
-			*firstbit_location = static_cast<unsigned long>((sizeof(morton) * 8) - __builtin_clzll(x) - 1);
+			*firstbit_location = static_cast<unsigned long>(63 - __builtin_clzll(static_cast<unsigned long long>(x)));
 			return true;
 		}
 #endif
 	}
 
+#if LIBMORTON_HAS_UINT128
+	// 128-bit morton codes: scan the high word first
+	inline bool findFirstSetBitZeroIdx(const morton128_t x, unsigned long* firstbit_location) {
+		if (findFirstSetBitZeroIdx(static_cast<uint64_t>(x >> 64), firstbit_location)) {
+			*firstbit_location += 64;
+			return true;
+		}
+		return findFirstSetBitZeroIdx(static_cast<uint64_t>(x), firstbit_location);
+	}
+#endif
+
 	template<typename morton>
 	inline bool findFirstSetBit(const morton x, unsigned long* firstbit_location) {
 		if (findFirstSetBitZeroIdx(x, firstbit_location)) {
@@ -46,4 +82,80 @@ namespace libmorton {
 		}
 		return false;
 	}
+
+	// Magic bits: spread the bits of a coordinate dims positions apart (and back) in log2(bits) shift-and-mask
+	// stages. The masks are compile-time constants for every (morton type, dims), so they become immediates.
+	namespace magicbits_detail {
+		// Bits per coordinate in a morton code
+		template<typename morton, unsigned int dims>
+		constexpr unsigned int coord_bits() { return static_cast<unsigned int>(sizeof(morton) * 8 / dims); }
+
+		// Mask after the stage which leaves the coordinate in chunks of c bits: bit i of the coordinate
+		// sits at (i mod c) + dims * c * floor(i / c)
+		template<typename morton>
+		constexpr morton stage_mask(const unsigned int dims, const unsigned int bits, const unsigned int c) {
+			morton mask = 0;
+			for (unsigned int i = 0; i < bits; ++i) { mask |= static_cast<morton>(1) << ((i % c) + dims * c * (i / c)); }
+			return mask;
+		}
+
+		// Chunk size of the first split stage: largest power of two below bits
+		constexpr unsigned int first_stage(const unsigned int bits) {
+			unsigned int c = 1;
+			while (c * 2 < bits) { c *= 2; }
+			return c;
+		}
+
+		// Split chunks of 2c bits into chunks of c bits, down to single bits
+		template<typename morton, unsigned int dims, unsigned int c>
+		struct split {
+			static constexpr morton mask = stage_mask<morton>(dims, coord_bits<morton, dims>(), c);
+			static constexpr morton apply(const morton x) {
+				return split<morton, dims, c / 2>::apply((x | (x << ((dims - 1) * c))) & mask);
+			}
+		};
+		template<typename morton, unsigned int dims>
+		struct split<morton, dims, 0> {
+			static constexpr morton apply(const morton x) { return x; }
+		};
+		template<typename morton, unsigned int dims, unsigned int c>
+		constexpr morton split<morton, dims, c>::mask;
+
+		// Merge chunks of c bits into chunks of 2c bits, up to the whole coordinate
+		template<typename morton, unsigned int dims, unsigned int c, bool done = (c >= coord_bits<morton, dims>())>
+		struct compact {
+			static constexpr morton mask = stage_mask<morton>(dims, coord_bits<morton, dims>(), 2 * c);
+			static constexpr morton apply(const morton x) {
+				return compact<morton, dims, 2 * c>::apply((x ^ (x >> ((dims - 1) * c))) & mask);
+			}
+		};
+		template<typename morton, unsigned int dims, unsigned int c>
+		struct compact<morton, dims, c, true> {
+			static constexpr morton apply(const morton x) { return x; }
+		};
+		template<typename morton, unsigned int dims, unsigned int c, bool done>
+		constexpr morton compact<morton, dims, c, done>::mask;
+
+		template<typename morton, unsigned int dims>
+		struct masks {
+			static constexpr morton coord = stage_mask<morton>(dims, coord_bits<morton, dims>(), coord_bits<morton, dims>()); // low coord_bits bits
+			static constexpr morton spread = stage_mask<morton>(dims, coord_bits<morton, dims>(), 1); // every dims-th bit
+		};
+		template<typename morton, unsigned int dims>
+		constexpr morton masks<morton, dims>::coord;
+		template<typename morton, unsigned int dims>
+		constexpr morton masks<morton, dims>::spread;
+
+		// Spread the low coord_bits bits of x dims positions apart
+		template<typename morton, unsigned int dims>
+		constexpr morton split_bits(const morton x) {
+			return split<morton, dims, first_stage(coord_bits<morton, dims>())>::apply(x & masks<morton, dims>::coord);
+		}
+
+		// Gather every dims-th bit of m, starting at bit 0
+		template<typename morton, unsigned int dims>
+		constexpr morton compact_bits(const morton m) {
+			return compact<morton, dims, 1>::apply(m & masks<morton, dims>::spread);
+		}
+	}
 }
\ No newline at end of file
@@ -0,0 +1,308 @@
+#pragma once
+
+// Libmorton - Compact Z-order for grids of any extent
+// Morton codes of a grid of X x Y x Z cells span the cube around it, with a side which is a power of 2: a
+// 1000 x 1000 x 300 grid needs codes up to 1024^3. morton3D_compact maps the cells one-to-one to [0, X * Y * Z).
+//
+// Every extent is a sum of powers of 2 (its set bits), so the grid splits into boxes with sides which are powers of
+// 2: 1000 = 512 + 256 + 128 + 64 + 32 + 8 along every axis. The boxes follow each other along x, then y, then z (the
+// largest ones first), and the cells of a box follow each other in Z-order. A box which is not a cube holds its
+// cubes in Z-order along its longest axes, like a morton code whose shorter coordinates have run out of bits. So
+// cells keep the locality of Z-order within the boxes, which hold most of the grid.
+//
+// The box of a coordinate is the highest bit where it differs from the extent. Within a box, the index is the morton
+// code of the offsets with the bits of the shorter axes packed out (one pext with BMI2). Where boxes start, and
+// which bits they keep, are looked up by side in one table per axis. Decoding finds the slab of x which holds the
+// index, then the slab of y in that one, without divisions: the leading bits of the index pick the slab at the start
+// of their bucket, and the first indices of the next slabs are compared against the index.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "morton.h"
+
+namespace libmorton {
+	class morton3D_compact;
+
+	namespace compact_detail {
+		// Boxes have sides up to 2^21
+		static const unsigned int sides = 22;
+
+		// Side of the box of coordinate x < extent (log2): the highest bit where they differ
+		inline unsigned int side(const uint64_t x, const uint64_t extent) {
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<unsigned int>(63 - __builtin_clzll(x ^ extent));
+#else
+			unsigned long bit = 0;
+			findFirstSetBitZeroIdx(x ^ extent, &bit);
+			return static_cast<unsigned int>(bit);
+#endif
+		}
+
+		inline uint64_t low_bits(const unsigned int bits) { return (uint64_t(1) << bits) - 1; }
+
+		// First coordinate of the box of side 2^j along an axis of the given extent
+		inline uint64_t box_start(const uint64_t extent, const unsigned int j) { return extent >> j >> 1 << j << 1; }
+
+		// Bits of the morton codes of the offsets in a box of 2^j[0] x 2^j[1] x 2^j[2] cells
+		inline uint64_t lanes(const unsigned int j[3]) {
+			const uint64_t spread = magicbits_detail::masks<uint64_t, 3>::spread;
+			return (spread & low_bits(3 * j[0])) | ((spread << 1) & low_bits(3 * j[1])) | ((spread << 2) & low_bits(3 * j[2]));
+		}
+
+		// Index of the first cell of the box of side 2^j along an axis (for a box at the start of the slabs of the
+		// other axes), and the bits of the morton codes of the offsets in it along that axis
+		struct box { uint64_t first; uint64_t lane; };
+
+		// Buckets of indices which start the search for a slab
+		static const unsigned int buckets = 256;
+
+		// Cell c in a box of 2^j[0] x 2^j[1] x 2^j[2] cells to the index of the cell in the box: the morton code of its
+		// offsets in the box (its lowest j[a] bits), without the bits of axes which ran out of levels (mask: the bits of
+		// the morton code of the cell which are kept). And back from the index to the offsets.
+		struct split_packer {
+			// Axes by number of levels: a[0] fewest, a[2] most
+			static void order(const unsigned int j[3], unsigned int a[3]) {
+				a[0] = 0; a[1] = 1; a[2] = 2;
+				if (j[a[1]] < j[a[0]]) { const unsigned int t = a[0]; a[0] = a[1]; a[1] = t; }
+				if (j[a[2]] < j[a[1]]) { const unsigned int t = a[1]; a[1] = a[2]; a[2] = t; }
+				if (j[a[1]] < j[a[0]]) { const unsigned int t = a[0]; a[0] = a[1]; a[1] = t; }
+			}
+
+			// 3D code of the levels all axes have, 2D code of the levels two axes have, then the bits of the longest axis
+			static uint64_t pack(const uint32_t c[3], const unsigned int j[3], uint64_t) {
+				const uint32_t o[3] = { c[0] & static_cast<uint32_t>(low_bits(j[0])), c[1] & static_cast<uint32_t>(low_bits(j[1])), c[2] & static_cast<uint32_t>(low_bits(j[2])) };
+				unsigned int a[3];
+				order(j, a);
+				const unsigned int j0 = j[a[0]], j1 = j[a[1]];
+				const uint32_t low = static_cast<uint32_t>(low_bits(j0)), middle = static_cast<uint32_t>(low_bits(j1 - j0));
+				const unsigned int u = a[1] < a[2] ? a[1] : a[2], v = a[1] < a[2] ? a[2] : a[1];
+				uint64_t code = morton3D_64_encode(o[0] & low, o[1] & low, o[2] & low);
+				code |= static_cast<uint64_t>(morton2D_64_encode((o[u] >> j0) & middle, (o[v] >> j0) & middle)) << (3 * j0);
+				code |= static_cast<uint64_t>(o[a[2]] >> j1) << (3 * j0 + 2 * (j1 - j0));
+				return code;
+			}
+
+			static void unpack(const uint64_t code, const unsigned int j[3], uint64_t, uint32_t o[3]) {
+				unsigned int a[3];
+				order(j, a);
+				const unsigned int j0 = j[a[0]], j1 = j[a[1]];
+				const unsigned int u = a[1] < a[2] ? a[1] : a[2], v = a[1] < a[2] ? a[2] : a[1];
+				uint_fast32_t x, y, z, du, dv;
+				morton3D_64_decode(code & low_bits(3 * j0), x, y, z);
+				morton2D_64_decode((code >> (3 * j0)) & low_bits(2 * (j1 - j0)), du, dv);
+				o[0] = static_cast<uint32_t>(x);
+				o[1] = static_cast<uint32_t>(y);
+				o[2] = static_cast<uint32_t>(z);
+				o[u] |= static_cast<uint32_t>(du << j0);
+				o[v] |= static_cast<uint32_t>(dv << j0);
+				o[a[2]] |= static_cast<uint32_t>((code >> (3 * j0 + 2 * (j1 - j0))) << j1);
+			}
+		};
+
+#if defined(__BMI2__) || __AVX2__ || LIBMORTON_X86_DISPATCH
+		// The same with pext / pdep: the mask also drops the bits of the cell above its offsets in the box
+		struct BMI_packer {
+			LIBMORTON_TARGET("bmi2") static uint64_t pack(const uint32_t c[3], const unsigned int*, const uint64_t mask) {
+				return bmi2_detail::pext(m3D_e_BMI<uint64_t, uint32_t>(c[0], c[1], c[2]), mask);
+			}
+			LIBMORTON_TARGET("bmi2") static void unpack(const uint64_t code, const unsigned int*, const uint64_t mask, uint32_t o[3]) {
+				m3D_d_BMI<uint64_t, uint32_t>(bmi2_detail::pdep(code, mask), o[0], o[1], o[2]);
+			}
+		};
+
+		LIBMORTON_TARGET("bmi2") inline uint64_t encode_BMI(const morton3D_compact& c, const uint32_t x, const uint32_t y, const uint32_t z);
+		LIBMORTON_TARGET("bmi2") inline void decode_BMI(const morton3D_compact& c, const uint64_t index, uint32_t& x, uint32_t& y, uint32_t& z);
+#endif
+	}
+
+	// COMPACT Z-ORDER : one-to-one map of the cells of an X x Y x Z grid (extents up to 2^21) to [0, X * Y * Z)
+	class morton3D_compact {
+	public:
+		morton3D_compact(const uint32_t x, const uint32_t y, const uint32_t z) : yz_(uint64_t(y) * z), pdep_(false) {
+			extent_[0] = x;
+			extent_[1] = y;
+			extent_[2] = z;
+			for (unsigned int axis = 0; axis < 3; ++axis) {
+				for (unsigned int j = 0; j < compact_detail::sides; ++j) {
+					boxes_[axis][j].first = compact_detail::box_start(extent_[axis], j) * (axis == 0 ? yz_ : axis == 1 ? z : 1);
+					boxes_[axis][j].lane = static_cast<uint64_t>(magicbits_detail::masks<uint64_t, 3>::spread << axis) & compact_detail::low_bits(3 * j);
+				}
+			}
+			// Slabs of x and y, from the largest one (the highest bit of the extent), then the slab at the start of every
+			// bucket of indices
+			const uint64_t cells[2] = { yz_, z }, end[2] = { size(), uint64_t(y) * z };
+			for (unsigned int axis = 0; axis < 2; ++axis) {
+				unsigned int slab = 0;
+				for (unsigned int j = compact_detail::sides; j-- > 0;) {
+					if (((extent_[axis] >> j) & 1) == 0) { continue; }
+					slab_first_[axis][slab] = compact_detail::box_start(extent_[axis], j) * cells[axis];
+					slab_side_[axis][slab++] = static_cast<uint8_t>(j);
+				}
+				for (; slab <= compact_detail::sides; ++slab) {
+					slab_first_[axis][slab] = UINT64_MAX;
+					slab_side_[axis][slab] = 0;
+				}
+				bucket_shift_[axis] = 0;
+				while (((end[axis] - 1) >> bucket_shift_[axis]) >= compact_detail::buckets) { ++bucket_shift_[axis]; }
+				for (unsigned int b = 0, s = 0; b < compact_detail::buckets; ++b) {
+					while (slab_first_[axis][s + 1] <= (uint64_t(b) << bucket_shift_[axis])) { ++s; }
+					bucket_[axis][b] = static_cast<uint8_t>(s);
+				}
+			}
+#if defined(__BMI2__) || __AVX2__
+			pdep_ = true;
+#elif LIBMORTON_RUNTIME_DISPATCH
+			// pext / pdep wherever the morton.h stubs use them
+			pdep_ = bound_method(morton_slot::m3D_64_encode) == morton_method::BMI2;
+#endif
+		}
+
+		uint32_t extent(const unsigned int axis) const { return static_cast<uint32_t>(extent_[axis]); }
+		uint64_t size() const { return extent_[0] * yz_; }
+		// Whether codes are packed with pext / pdep (chosen when the map is made, see morton_dispatch.h)
+		bool uses_pdep() const { return pdep_; }
+
+		// Index of cell (x, y, z), every coordinate below its extent
+		uint64_t encode(const uint32_t x, const uint32_t y, const uint32_t z) const {
+#if defined(__BMI2__) || __AVX2__ || LIBMORTON_X86_DISPATCH
+			if (pdep_) { return compact_detail::encode_BMI(*this, x, y, z); }
+#endif
+			return encode_with<compact_detail::split_packer>(x, y, z);
+		}
+
+		// Cell of index < size()
+		void decode(const uint64_t index, uint32_t& x, uint32_t& y, uint32_t& z) const {
+#if defined(__BMI2__) || __AVX2__ || LIBMORTON_X86_DISPATCH
+			if (pdep_) {
+				compact_detail::decode_BMI(*this, index, x, y, z);
+				return;
+			}
+#endif
+			decode_with<compact_detail::split_packer>(index, x, y, z);
+		}
+
+		// Indices of n cells, and back
+		void encode_batch(const uint32_t* x, const uint32_t* y, const uint32_t* z, uint64_t* out, const size_t n) const {
+#if defined(__BMI2__) || __AVX2__ || LIBMORTON_X86_DISPATCH
+			if (pdep_) {
+				encode_batch_BMI(x, y, z, out, n);
+				return;
+			}
+#endif
+			for (size_t i = 0; i < n; ++i) { out[i] = encode_with<compact_detail::split_packer>(x[i], y[i], z[i]); }
+		}
+		void decode_batch(const uint64_t* in, uint32_t* x, uint32_t* y, uint32_t* z, const size_t n) const {
+#if defined(__BMI2__) || __AVX2__ || LIBMORTON_X86_DISPATCH
+			if (pdep_) {
+				decode_batch_BMI(in, x, y, z, n);
+				return;
+			}
+#endif
+			for (size_t i = 0; i < n; ++i) { decode_with<compact_detail::split_packer>(in[i], x[i], y[i], z[i]); }
+		}
+
+		// Box of cell (x, y, z): returns the index of its first cell. The sides of the box (log2) go to j, and the bits
+		// of the morton code of the cell which are kept in the box to mask.
+		uint64_t locate(const uint32_t x, const uint32_t y, const uint32_t z, unsigned int j[3], uint64_t& mask) const {
+			j[0] = compact_detail::side(x, extent_[0]);
+			j[1] = compact_detail::side(y, extent_[1]);
+			j[2] = compact_detail::side(z, extent_[2]);
+			const compact_detail::box& bx = boxes_[0][j[0]];
+			const compact_detail::box& by = boxes_[1][j[1]];
+			const compact_detail::box& bz = boxes_[2][j[2]];
+			mask = bx.lane | by.lane | bz.lane;
+			// Slab of x, then slab of y in it, then box of z in that
+			return bx.first + (by.first << j[0]) + (bz.first << (j[0] + j[1]));
+		}
+
+		// Box of an index: returns the index in the box. Its sides go to j, its first cell to start, and the bits kept
+		// to mask. The slab of x is the last one which starts at or below the index: its bucket gives the slab at the
+		// start of the bucket, and few buckets hold the start of another one. The slabs of y in a slab of x 2^j[0]
+		// cells thick start 2^j[0] times further apart than in their table.
+		uint64_t locate(const uint64_t index, unsigned int j[3], uint32_t start[3], uint64_t& mask) const {
+			unsigned int slab_x = bucket_[0][index >> bucket_shift_[0]];
+			while (slab_first_[0][slab_x + 1] <= index) { ++slab_x; }
+			j[0] = slab_side_[0][slab_x];
+			const uint64_t in_slab = index - slab_first_[0][slab_x];
+			const uint64_t row = in_slab >> j[0];
+			unsigned int slab_y = bucket_[1][row >> bucket_shift_[1]];
+			while (slab_first_[1][slab_y + 1] <= row) { ++slab_y; }
+			j[1] = slab_side_[1][slab_y];
+			const uint64_t rest = in_slab - (slab_first_[1][slab_y] << j[0]);
+			j[2] = compact_detail::side(rest >> (j[0] + j[1]), extent_[2]);
+			start[0] = static_cast<uint32_t>(compact_detail::box_start(extent_[0], j[0]));
+			start[1] = static_cast<uint32_t>(compact_detail::box_start(extent_[1], j[1]));
+			start[2] = static_cast<uint32_t>(compact_detail::box_start(extent_[2], j[2]));
+			mask = compact_detail::lanes(j);
+			return rest - (static_cast<uint64_t>(start[2]) << (j[0] + j[1]));
+		}
+
+		// Index of a cell with the given packer (see compact_detail), and back
+		template<typename packer>
+		uint64_t encode_with(const uint32_t x, const uint32_t y, const uint32_t z) const {
+			unsigned int j[3];
+			uint64_t mask;
+			const uint32_t c[3] = { x, y, z };
+			const uint64_t first = locate(x, y, z, j, mask);
+			return first + packer::pack(c, j, mask);
+		}
+
+		template<typename packer>
+		void decode_with(const uint64_t index, uint32_t& x, uint32_t& y, uint32_t& z) const {
+			unsigned int j[3];
+			uint32_t start[3], o[3];
+			uint64_t mask;
+			const uint64_t rest = locate(index, j, start, mask);
+			packer::unpack(rest, j, mask, o);
+			x = start[0] | o[0];
+			y = start[1] | o[1];
+			z = start[2] | o[2];
+		}
+
+	private:
+		uint64_t extent_[3];
+		uint64_t yz_;
+		// First cell of the box of every side along every axis (see compact_detail::box)
+		compact_detail::box boxes_[3][compact_detail::sides];
+		// Index of the first cell of every slab of x, and of every slab of y in a slab of x one cell thick, ascending
+		// (UINT64_MAX after the last one), and the side of every slab (log2)
+		uint64_t slab_first_[2][compact_detail::sides + 1];
+		uint8_t slab_side_[2][compact_detail::sides + 1];
+		// Slab at the start of every bucket of 2^bucket_shift_ indices
+		uint8_t bucket_[2][compact_detail::buckets];
+		unsigned int bucket_shift_[2];
+		bool pdep_;
+
+#if defined(__BMI2__) || __AVX2__ || LIBMORTON_X86_DISPATCH
+		LIBMORTON_TARGET("bmi2") void encode_batch_BMI(const uint32_t* x, const uint32_t* y, const uint32_t* z, uint64_t* out, const size_t n) const {
+			for (size_t i = 0; i < n; ++i) { out[i] = compact_detail::encode_BMI(*this, x[i], y[i], z[i]); }
+		}
+		LIBMORTON_TARGET("bmi2") void decode_batch_BMI(const uint64_t* in, uint32_t* x, uint32_t* y, uint32_t* z, const size_t n) const {
+			for (size_t i = 0; i < n; ++i) { compact_detail::decode_BMI(*this, in[i], x[i], y[i], z[i]); }
+		}
+#endif
+	};
+
+#if defined(__BMI2__) || __AVX2__ || LIBMORTON_X86_DISPATCH
+	namespace compact_detail {
+		// Only called from code built for BMI2, where the packer is inlined
+		LIBMORTON_TARGET("bmi2") inline uint64_t encode_BMI(const morton3D_compact& c, const uint32_t x, const uint32_t y, const uint32_t z) {
+			unsigned int j[3];
+			uint64_t mask;
+			const uint32_t cell[3] = { x, y, z };
+			const uint64_t first = c.locate(x, y, z, j, mask);
+			return first + BMI_packer::pack(cell, j, mask);
+		}
+		LIBMORTON_TARGET("bmi2") inline void decode_BMI(const morton3D_compact& c, const uint64_t index, uint32_t& x, uint32_t& y, uint32_t& z) {
+			unsigned int j[3];
+			uint32_t start[3], o[3];
+			uint64_t mask;
+			const uint64_t rest = c.locate(index, j, start, mask);
+			BMI_packer::unpack(rest, j, mask, o);
+			x = start[0] | o[0];
+			y = start[1] | o[1];
+			z = start[2] | o[2];
+		}
+	}
+#endif
+}
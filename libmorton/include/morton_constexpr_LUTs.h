@@ -0,0 +1,100 @@
+#pragma once
+
+// Libmorton - LookUpTables generated at compile time, for any chunk width
+// The LUT and sLUT methods in morton2D.h / morton3D.h take the chunk width as a template parameter, so you can
+// pick a table size that fits your cache budget: an encode chunk of c bits needs a table of 2^c entries, a decode
+// chunk must be a multiple of the number of dimensions. Tables are static members of class templates, so every
+// program gets one copy of each table it uses, no matter how many translation units use it.
+//
+// Tables of 2^16 entries take a lot of constexpr evaluation steps, you may need to raise your compiler's limit
+// (MSVC: /constexpr:steps, Clang: -fconstexpr-steps).
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+namespace libmorton {
+
+	template<typename element, size_t size>
+	struct morton_LUT {
+		element values[size];
+		constexpr const element& operator[](size_t i) const { return values[i]; }
+	};
+
+	namespace lut_detail {
+		// Smallest unsigned type holding bits bits
+		template<unsigned int bits>
+		using uint_least = typename std::conditional<(bits <= 8), uint8_t,
+			typename std::conditional<(bits <= 16), uint16_t,
+			typename std::conditional<(bits <= 32), uint32_t, uint64_t>::type>::type>::type;
+
+		// Encode table entry i spreads the bits of i dims apart, starting at bit axis:
+		// entry i is entry (i >> 1) moved up one position, plus the lowest bit of i
+		template<typename element, size_t size>
+		constexpr morton_LUT<element, size> make_encode_LUT(const unsigned int dims, const unsigned int axis) {
+			morton_LUT<element, size> lut{};
+			for (size_t i = 1; i < size; ++i) {
+				lut.values[i] = static_cast<element>((lut.values[i >> 1] << dims) | (static_cast<element>(i & 1) << axis));
+			}
+			return lut;
+		}
+
+		// Decode table entry i gathers the bits of i at positions axis, axis + dims, axis + 2 * dims, ...
+		template<typename element, size_t size>
+		constexpr morton_LUT<element, size> make_decode_LUT(const unsigned int dims, const unsigned int axis) {
+			morton_LUT<element, size> lut{};
+			for (size_t i = 1; i < size; ++i) {
+				lut.values[i] = static_cast<element>((lut.values[i >> dims] << 1) | ((i >> axis) & 1));
+			}
+			return lut;
+		}
+	}
+
+	// Encode LUT for chunks of chunk coordinate bits, pre-shifted to axis (0 = x, 1 = y, 2 = z)
+	template<unsigned int dims, unsigned int chunk, unsigned int axis = 0>
+	struct morton_encode_LUT {
+		static_assert(chunk >= 1 && chunk <= 16, "encode chunks are 1 to 16 bits");
+		static_assert(dims * chunk <= 64, "encode table entries hold up to 64 bits");
+		typedef lut_detail::uint_least<dims * chunk> element;
+		static constexpr size_t size = size_t(1) << chunk;
+		static constexpr morton_LUT<element, size> table = lut_detail::make_encode_LUT<element, size>(dims, axis);
+	};
+	template<unsigned int dims, unsigned int chunk, unsigned int axis>
+	constexpr morton_LUT<typename morton_encode_LUT<dims, chunk, axis>::element, morton_encode_LUT<dims, chunk, axis>::size> morton_encode_LUT<dims, chunk, axis>::table;
+
+	// Decode LUT for chunks of chunk morton code bits, returning the bits of axis
+	template<unsigned int dims, unsigned int chunk, unsigned int axis = 0>
+	struct morton_decode_LUT {
+		static_assert(chunk >= dims && chunk <= 16 && chunk % dims == 0, "decode chunks are a multiple of dims, up to 16 bits");
+		typedef lut_detail::uint_least<chunk / dims> element;
+		static constexpr size_t size = size_t(1) << chunk;
+		static constexpr morton_LUT<element, size> table = lut_detail::make_decode_LUT<element, size>(dims, axis);
+	};
+	template<unsigned int dims, unsigned int chunk, unsigned int axis>
+	constexpr morton_LUT<typename morton_decode_LUT<dims, chunk, axis>::element, morton_decode_LUT<dims, chunk, axis>::size> morton_decode_LUT<dims, chunk, axis>::table;
+
+	// HELPER METHOD for LUT encoding: one table lookup per chunk of every coordinate
+	// Coordinates hold sizeof(morton) * 8 / dims bits.
+	template<typename morton, typename coord, unsigned int dims, unsigned int chunk, typename table>
+	inline morton encodeCoord_LUT(const coord c, const table& LUT, const unsigned int startshift) {
+		const unsigned int coord_bits = sizeof(morton) * 8 / dims;
+		const morton chunk_mask = (static_cast<morton>(1) << chunk) - 1;
+		morton answer = 0;
+		for (unsigned int i = 0; i * chunk < coord_bits; ++i) {
+			answer |= static_cast<morton>(LUT[(c >> (i * chunk)) & chunk_mask]) << (i * chunk * dims + startshift);
+		}
+		return answer;
+	}
+
+	// HELPER METHOD for LUT decoding: every lookup yields chunk / dims bits of one coordinate
+	template<typename morton, typename coord, unsigned int dims, unsigned int chunk, typename table>
+	inline coord decodeCoord_LUT(const morton m, const table& LUT, const unsigned int startshift) {
+		const unsigned int code_bits = (sizeof(morton) * 8 / dims) * dims;
+		const morton chunk_mask = (static_cast<morton>(1) << chunk) - 1;
+		morton a = 0;
+		for (unsigned int i = 0; i * chunk < code_bits; ++i) {
+			a |= static_cast<morton>(LUT[(m >> (i * chunk + startshift)) & chunk_mask]) << (i * (chunk / dims));
+		}
+		return static_cast<coord>(a);
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+// Libmorton - Arithmetic on morton codes without decoding them
+// The bits of one coordinate in a morton code form a dilated integer: its bits are spread dims positions apart.
+// Two dilated integers can be added by filling the gaps between their bits with ones, so the carries ripple
+// through them, and masking the gaps out again afterwards. This steps to a neighbouring cell in a few
+// instructions, instead of decoding, adjusting and re-encoding the coordinates.
+//
+// Every coordinate wraps around within its own bits (sizeof(morton) * 8 / dims of them). Adding the morton code of
+// (1, 0, c_max) steps +1 in x and -1 in z. The _overflow versions return a bitmask of the coordinates that wrapped
+// (bit 0 = x, bit 1 = y, bit 2 = z).
+
+#include "morton_common.h"
+
+namespace libmorton {
+	namespace dilated_detail {
+		// Bits of coordinate axis (0 = x, 1 = y, 2 = z) in a dims-dimensional morton code
+		template<typename morton, unsigned int dims>
+		constexpr morton lane(const unsigned int axis) {
+			return static_cast<morton>(magicbits_detail::masks<morton, dims>::spread << axis);
+		}
+
+		// Coordinate axis of a plus coordinate axis of b, other coordinates are cleared
+		template<typename morton, unsigned int dims>
+		constexpr morton add_lane(const morton a, const morton b, const unsigned int axis) {
+			return static_cast<morton>((static_cast<morton>(a | static_cast<morton>(~lane<morton, dims>(axis))) + (b & lane<morton, dims>(axis))) & lane<morton, dims>(axis));
+		}
+
+		// Coordinate axis of a minus coordinate axis of b, other coordinates are cleared
+		template<typename morton, unsigned int dims>
+		constexpr morton sub_lane(const morton a, const morton b, const unsigned int axis) {
+			return static_cast<morton>(((a & lane<morton, dims>(axis)) - (b & lane<morton, dims>(axis))) & lane<morton, dims>(axis));
+		}
+
+		// Add (or subtract) every coordinate of b to the same coordinate of a
+		template<typename morton, unsigned int dims>
+		constexpr morton add(const morton a, const morton b) {
+			morton result = 0;
+			for (unsigned int axis = 0; axis < dims; ++axis) { result |= add_lane<morton, dims>(a, b, axis); }
+			return result;
+		}
+		template<typename morton, unsigned int dims>
+		constexpr morton sub(const morton a, const morton b) {
+			morton result = 0;
+			for (unsigned int axis = 0; axis < dims; ++axis) { result |= sub_lane<morton, dims>(a, b, axis); }
+			return result;
+		}
+
+		// Same, returning the coordinates that wrapped around. Dilated integers compare like the integers they hold.
+		template<typename morton, unsigned int dims>
+		inline unsigned int add_overflow(const morton a, const morton b, morton& result) {
+			unsigned int wrapped = 0;
+			result = 0;
+			for (unsigned int axis = 0; axis < dims; ++axis) {
+				const morton sum = add_lane<morton, dims>(a, b, axis);
+				if (sum < (a & lane<morton, dims>(axis))) { wrapped |= 1u << axis; }
+				result |= sum;
+			}
+			return wrapped;
+		}
+		template<typename morton, unsigned int dims>
+		inline unsigned int sub_overflow(const morton a, const morton b, morton& result) {
+			unsigned int wrapped = 0;
+			result = 0;
+			for (unsigned int axis = 0; axis < dims; ++axis) {
+				if ((b & lane<morton, dims>(axis)) > (a & lane<morton, dims>(axis))) { wrapped |= 1u << axis; }
+				result |= sub_lane<morton, dims>(a, b, axis);
+			}
+			return wrapped;
+		}
+
+		// Add (or subtract) one to coordinate axis, leaving the other coordinates alone
+		template<typename morton, unsigned int dims>
+		constexpr morton inc(const morton m, const unsigned int axis) {
+			return add_lane<morton, dims>(m, static_cast<morton>(static_cast<morton>(1) << axis), axis) | (m & static_cast<morton>(~lane<morton, dims>(axis)));
+		}
+		template<typename morton, unsigned int dims>
+		constexpr morton dec(const morton m, const unsigned int axis) {
+			return sub_lane<morton, dims>(m, static_cast<morton>(static_cast<morton>(1) << axis), axis) | (m & static_cast<morton>(~lane<morton, dims>(axis)));
+		}
+	}
+
+	// ADD / SUBTRACT 2D morton codes : every coordinate of b is added to (subtracted from) the same coordinate of a
+	template<typename morton> constexpr morton m2D_add(const morton a, const morton b) { return dilated_detail::add<morton, 2>(a, b); }
+	template<typename morton> constexpr morton m2D_sub(const morton a, const morton b) { return dilated_detail::sub<morton, 2>(a, b); }
+	template<typename morton> inline unsigned int m2D_add_overflow(const morton a, const morton b, morton& result) { return dilated_detail::add_overflow<morton, 2>(a, b, result); }
+	template<typename morton> inline unsigned int m2D_sub_overflow(const morton a, const morton b, morton& result) { return dilated_detail::sub_overflow<morton, 2>(a, b, result); }
+
+	// INCREMENT / DECREMENT one coordinate (axis 0 = x, 1 = y) of a 2D morton code
+	template<typename morton> constexpr morton m2D_inc(const morton m, const unsigned int axis) { return dilated_detail::inc<morton, 2>(m, axis); }
+	template<typename morton> constexpr morton m2D_dec(const morton m, const unsigned int axis) { return dilated_detail::dec<morton, 2>(m, axis); }
+	template<typename morton> inline bool m2D_inc_overflow(const morton m, const unsigned int axis, morton& result) {
+		result = m2D_inc<morton>(m, axis);
+		return (result & dilated_detail::lane<morton, 2>(axis)) == 0;
+	}
+	template<typename morton> inline bool m2D_dec_overflow(const morton m, const unsigned int axis, morton& result) {
+		result = m2D_dec<morton>(m, axis);
+		return (m & dilated_detail::lane<morton, 2>(axis)) == 0;
+	}
+
+	// ADD / SUBTRACT 3D morton codes : every coordinate of b is added to (subtracted from) the same coordinate of a
+	template<typename morton> constexpr morton m3D_add(const morton a, const morton b) { return dilated_detail::add<morton, 3>(a, b); }
+	template<typename morton> constexpr morton m3D_sub(const morton a, const morton b) { return dilated_detail::sub<morton, 3>(a, b); }
+	template<typename morton> inline unsigned int m3D_add_overflow(const morton a, const morton b, morton& result) { return dilated_detail::add_overflow<morton, 3>(a, b, result); }
+	template<typename morton> inline unsigned int m3D_sub_overflow(const morton a, const morton b, morton& result) { return dilated_detail::sub_overflow<morton, 3>(a, b, result); }
+
+	// INCREMENT / DECREMENT one coordinate (axis 0 = x, 1 = y, 2 = z) of a 3D morton code
+	template<typename morton> constexpr morton m3D_inc(const morton m, const unsigned int axis) { return dilated_detail::inc<morton, 3>(m, axis); }
+	template<typename morton> constexpr morton m3D_dec(const morton m, const unsigned int axis) { return dilated_detail::dec<morton, 3>(m, axis); }
+	template<typename morton> inline bool m3D_inc_overflow(const morton m, const unsigned int axis, morton& result) {
+		result = m3D_inc<morton>(m, axis);
+		return (result & dilated_detail::lane<morton, 3>(axis)) == 0;
+	}
+	template<typename morton> inline bool m3D_dec_overflow(const morton m, const unsigned int axis, morton& result) {
+		result = m3D_dec<morton>(m, axis);
+		return (m & dilated_detail::lane<morton, 3>(axis)) == 0;
+	}
+}
@@ -0,0 +1,469 @@
+#pragma once
+
+// Libmorton - Runtime selection of the methods behind the morton.h stubs
+// The host CPU is inspected once (cpuid), after which every morton.h stub calls the method which is fastest
+// on this host through a table of function pointers. This way, one binary built for baseline x86-64 uses
+// BMI2/AVX2 where they are available, and avoids BMI2 where pdep/pext are microcoded (AMD Zen1/Zen2).
+//
+// The choice can be forced with set_method() / set_batch_method() / bind_method(), or through the
+// LIBMORTON_METHOD and LIBMORTON_BATCH_METHOD environment variables (read once, on first use).
+// Rebinding methods is not thread-safe: do it before other threads start using the morton.h stubs.
+//
+// This is the default in builds for baseline x86-64. Builds for BMI2 select at compile time, so the stubs can be
+// inlined (define LIBMORTON_RUNTIME_DISPATCH to 1 to dispatch there too). Define LIBMORTON_NO_RUNTIME_DISPATCH to
+// select at compile time everywhere.
+
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "morton2D.h"
+#include "morton3D.h"
+#include "morton_BMI.h"
+#include "morton_CLMUL.h"
+#include "morton_AVX2.h"
+#include "morton_neighbors.h"
+#if LIBMORTON_X86_DISPATCH
+#if _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Builds for BMI2 (-mbmi2, -march=haswell) keep the inlined compile-time selection unless LIBMORTON_RUNTIME_DISPATCH
+// is defined to 1
+#if !LIBMORTON_X86_DISPATCH || defined(LIBMORTON_NO_RUNTIME_DISPATCH)
+#undef LIBMORTON_RUNTIME_DISPATCH
+#define LIBMORTON_RUNTIME_DISPATCH 0
+#elif !defined(LIBMORTON_RUNTIME_DISPATCH)
+#if defined(__BMI2__)
+#define LIBMORTON_RUNTIME_DISPATCH 0
+#else
+#define LIBMORTON_RUNTIME_DISPATCH 1
+#endif
+#endif
+
+namespace libmorton {
+
+	// Features of the host CPU which matter for morton encoding/decoding
+	struct cpu_features {
+		bool bmi2 = false;
+		bool avx2 = false; // includes OS support for saving the YMM registers
+		bool slow_pdep = false; // pdep/pext are microcoded (AMD Zen1/Zen+/Zen2, Hygon Dhyana)
+		bool pclmul = false;
+	};
+
+	// Methods which can be bound to the morton.h stubs
+	enum class morton_method {
+		automatic, // fastest method for the host CPU
+		LUT,
+		sLUT,
+		LUT_ET,
+		sLUT_ET,
+		magicbits,
+		BMI2,
+		CLMUL, // 2D encode stubs only
+		AVX2, // batch stubs only
+		loop // batch stubs only: loop over the single-code stubs
+	};
+
+	// The single-code stubs in morton.h, every one of them can be bound to a different method
+	enum class morton_slot {
+		m2D_32_encode, m2D_64_encode, m3D_32_encode, m3D_64_encode,
+		m2D_32_decode, m2D_64_decode, m3D_32_decode, m3D_64_decode,
+#if LIBMORTON_HAS_UINT128
+		m2D_128_encode, m3D_128_encode, m2D_128_decode, m3D_128_decode
+#endif
+	};
+	static const size_t morton_slot_count = LIBMORTON_HAS_UINT128 ? 12 : 8;
+
+	// Function pointers the morton.h stubs call through
+	struct morton_dispatch_table {
+		// Exact-width instantiations: uint_fast16_t/uint_fast32_t are 8 bytes on some platforms (glibc),
+		// which makes the LUT methods loop over chunks that never hold any bits.
+		uint32_t(*m2D_32_encode)(uint16_t, uint16_t);
+		uint64_t(*m2D_64_encode)(uint32_t, uint32_t);
+		uint32_t(*m3D_32_encode)(uint16_t, uint16_t, uint16_t);
+		uint64_t(*m3D_64_encode)(uint32_t, uint32_t, uint32_t);
+		void(*m2D_32_decode)(uint32_t, uint16_t&, uint16_t&);
+		void(*m2D_64_decode)(uint64_t, uint32_t&, uint32_t&);
+		void(*m3D_32_decode)(uint32_t, uint16_t&, uint16_t&, uint16_t&);
+		void(*m3D_64_decode)(uint64_t, uint32_t&, uint32_t&, uint32_t&);
+#if LIBMORTON_HAS_UINT128
+		morton128_t(*m2D_128_encode)(uint64_t, uint64_t);
+		morton128_t(*m3D_128_encode)(uint64_t, uint64_t, uint64_t);
+		void(*m2D_128_decode)(morton128_t, uint64_t&, uint64_t&);
+		void(*m3D_128_decode)(morton128_t, uint64_t&, uint64_t&, uint64_t&);
+#endif
+
+		void(*m2D_32_encode_batch)(const uint16_t*, const uint16_t*, uint32_t*, size_t);
+		void(*m2D_64_encode_batch)(const uint32_t*, const uint32_t*, uint64_t*, size_t);
+		void(*m3D_32_encode_batch)(const uint16_t*, const uint16_t*, const uint16_t*, uint32_t*, size_t);
+		void(*m3D_64_encode_batch)(const uint32_t*, const uint32_t*, const uint32_t*, uint64_t*, size_t);
+		void(*m2D_32_decode_batch)(const uint32_t*, uint16_t*, uint16_t*, size_t);
+		void(*m2D_64_decode_batch)(const uint64_t*, uint32_t*, uint32_t*, size_t);
+		void(*m3D_32_decode_batch)(const uint32_t*, uint16_t*, uint16_t*, uint16_t*, size_t);
+		void(*m3D_64_decode_batch)(const uint64_t*, uint32_t*, uint32_t*, uint32_t*, size_t);
+		void(*m3D_32_neighbors_batch)(const uint32_t*, size_t, morton_stencil, uint32_t, uint32_t*, uint32_t*);
+		void(*m3D_64_neighbors_batch)(const uint64_t*, size_t, morton_stencil, uint64_t, uint64_t*, uint32_t*);
+
+		morton_method methods[morton_slot_count]; // method bound to every single-code slot
+		morton_method batch_method; // AVX2 or loop
+	};
+
+	namespace dispatch_detail {
+#if LIBMORTON_X86_DISPATCH
+		inline void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+#if _MSC_VER
+			int r[4];
+			__cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+			for (int i = 0; i < 4; ++i) { regs[i] = static_cast<unsigned int>(r[i]); }
+#else
+			__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+		}
+
+		// Register state the OS saves on context switches (XCR0)
+		inline uint64_t xgetbv0() {
+#if _MSC_VER
+			return _xgetbv(0);
+#else
+			unsigned int eax, edx;
+			__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+			return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+		}
+#endif
+
+		inline cpu_features detect_cpu_features() {
+			cpu_features f;
+#if LIBMORTON_X86_DISPATCH
+			unsigned int r[4];
+			cpuid(0, 0, r);
+			const unsigned int max_leaf = r[0];
+			char vendor[13];
+			memcpy(vendor, &r[1], 4); memcpy(vendor + 4, &r[3], 4); memcpy(vendor + 8, &r[2], 4);
+			vendor[12] = '\0';
+			if (max_leaf < 1) { return f; }
+
+			cpuid(1, 0, r);
+			unsigned int family = (r[0] >> 8) & 0xF;
+			if (family == 0xF) { family += (r[0] >> 20) & 0xFF; }
+			const bool osxsave = (r[2] >> 27) & 1;
+			const bool avx = (r[2] >> 28) & 1;
+			f.pclmul = (r[2] >> 1) & 1;
+			// BMI2 and AVX2 are only reported in leaf 7
+			if (max_leaf < 7) { return f; }
+			const bool ymm_state = osxsave && avx && ((xgetbv0() & 0x6) == 0x6);
+
+			cpuid(7, 0, r);
+			f.bmi2 = (r[1] >> 8) & 1;
+			f.avx2 = ymm_state && ((r[1] >> 5) & 1);
+
+			const bool amd = strcmp(vendor, "AuthenticAMD") == 0 || strcmp(vendor, "HygonGenuine") == 0;
+			f.slow_pdep = f.bmi2 && amd && (family == 0x17 || family == 0x18);
+#endif
+			return f;
+		}
+	}
+
+	// Features of the host CPU (detected once)
+	inline const cpu_features& host_cpu_features() {
+		static const cpu_features features = dispatch_detail::detect_cpu_features();
+		return features;
+	}
+
+	inline const char* method_name(const morton_method m) {
+		switch (m) {
+		case morton_method::LUT: return "LUT";
+		case morton_method::sLUT: return "sLUT";
+		case morton_method::LUT_ET: return "LUT_ET";
+		case morton_method::sLUT_ET: return "sLUT_ET";
+		case morton_method::magicbits: return "magicbits";
+		case morton_method::BMI2: return "BMI2";
+		case morton_method::CLMUL: return "CLMUL";
+		case morton_method::AVX2: return "AVX2";
+		case morton_method::loop: return "loop";
+		default: return "automatic";
+		}
+	}
+
+	// Parse a method name (case insensitive), as returned by method_name()
+	inline bool parse_method(const char* name, morton_method& m) {
+		const morton_method all[] = { morton_method::automatic, morton_method::LUT, morton_method::sLUT, morton_method::LUT_ET,
+			morton_method::sLUT_ET, morton_method::magicbits, morton_method::BMI2, morton_method::CLMUL, morton_method::AVX2, morton_method::loop };
+		for (morton_method candidate : all) {
+			const char* a = name;
+			const char* b = method_name(candidate);
+			while (*a && *b && tolower(static_cast<unsigned char>(*a)) == tolower(static_cast<unsigned char>(*b))) { ++a; ++b; }
+			if (*a == '\0' && *b == '\0') {
+				m = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	inline const char* slot_name(const morton_slot slot) {
+		static const char* names[morton_slot_count] = {
+			"m2D_32_encode", "m2D_64_encode", "m3D_32_encode", "m3D_64_encode",
+			"m2D_32_decode", "m2D_64_decode", "m3D_32_decode", "m3D_64_decode",
+#if LIBMORTON_HAS_UINT128
+			"m2D_128_encode", "m3D_128_encode", "m2D_128_decode", "m3D_128_decode"
+#endif
+		};
+		return names[static_cast<size_t>(slot)];
+	}
+
+	// Parse a slot name, as returned by slot_name()
+	inline bool parse_slot(const char* name, morton_slot& slot) {
+		for (size_t i = 0; i < morton_slot_count; ++i) {
+			if (strcmp(name, slot_name(static_cast<morton_slot>(i))) == 0) {
+				slot = static_cast<morton_slot>(i);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Can method m run on the host CPU?
+	inline bool method_supported(const morton_method m) {
+		switch (m) {
+		case morton_method::BMI2: return host_cpu_features().bmi2;
+		case morton_method::CLMUL: return host_cpu_features().pclmul;
+		case morton_method::AVX2: return host_cpu_features().avx2;
+		default: return true;
+		}
+	}
+
+	// Fastest single-code method for the host CPU
+	inline morton_method best_method() {
+		const cpu_features& f = host_cpu_features();
+		if (f.bmi2 && !f.slow_pdep) { return morton_method::BMI2; }
+		return f.slow_pdep ? morton_method::magicbits : morton_method::sLUT;
+	}
+
+	// Fastest batch method for the host CPU
+	inline morton_method best_batch_method() {
+		return host_cpu_features().avx2 ? morton_method::AVX2 : morton_method::loop;
+	}
+
+	namespace dispatch_detail {
+		template<typename morton, typename coord> using encode2D_f = morton(*)(coord, coord);
+		template<typename morton, typename coord> using decode2D_f = void(*)(morton, coord&, coord&);
+		template<typename morton, typename coord> using encode3D_f = morton(*)(coord, coord, coord);
+		template<typename morton, typename coord> using decode3D_f = void(*)(morton, coord&, coord&, coord&);
+
+		// Single-code method implementations (nullptr if a method has none)
+		template<typename morton, typename coord>
+		inline encode2D_f<morton, coord> encode2D(const morton_method m) {
+			switch (m) {
+			case morton_method::LUT: return &m2D_e_LUT<morton, coord>;
+			case morton_method::sLUT: return &m2D_e_sLUT<morton, coord>;
+			case morton_method::LUT_ET: return &m2D_e_LUT_ET<morton, coord>;
+			case morton_method::sLUT_ET: return &m2D_e_sLUT_ET<morton, coord>;
+			case morton_method::magicbits: return &m2D_e_magicbits<morton, coord>;
+#if LIBMORTON_X86_DISPATCH
+			case morton_method::BMI2: return &m2D_e_BMI<morton, coord>;
+			case morton_method::CLMUL: return &m2D_e_CLMUL<morton, coord>;
+#endif
+			default: return nullptr;
+			}
+		}
+
+		template<typename morton, typename coord>
+		inline decode2D_f<morton, coord> decode2D(const morton_method m) {
+			switch (m) {
+			case morton_method::LUT: return &m2D_d_LUT<morton, coord>;
+			case morton_method::sLUT: return &m2D_d_sLUT<morton, coord>;
+			case morton_method::LUT_ET: return &m2D_d_LUT_ET<morton, coord>;
+			case morton_method::sLUT_ET: return &m2D_d_sLUT_ET<morton, coord>;
+			case morton_method::magicbits: return &m2D_d_magicbits<morton, coord>;
+#if LIBMORTON_X86_DISPATCH
+			case morton_method::BMI2: return &m2D_d_BMI<morton, coord>;
+#endif
+			default: return nullptr;
+			}
+		}
+
+		template<typename morton, typename coord>
+		inline encode3D_f<morton, coord> encode3D(const morton_method m) {
+			switch (m) {
+			case morton_method::LUT: return &m3D_e_LUT<morton, coord>;
+			case morton_method::sLUT: return &m3D_e_sLUT<morton, coord>;
+			case morton_method::LUT_ET: return &m3D_e_LUT_ET<morton, coord>;
+			case morton_method::sLUT_ET: return &m3D_e_sLUT_ET<morton, coord>;
+			case morton_method::magicbits: return &m3D_e_magicbits<morton, coord>;
+#if LIBMORTON_X86_DISPATCH
+			case morton_method::BMI2: return &m3D_e_BMI<morton, coord>;
+#endif
+			default: return nullptr;
+			}
+		}
+
+		template<typename morton, typename coord>
+		inline decode3D_f<morton, coord> decode3D(const morton_method m) {
+			switch (m) {
+			case morton_method::LUT: return &m3D_d_LUT<morton, coord>;
+			case morton_method::sLUT: return &m3D_d_sLUT<morton, coord>;
+			case morton_method::LUT_ET: return &m3D_d_LUT_ET<morton, coord>;
+			case morton_method::sLUT_ET: return &m3D_d_sLUT_ET<morton, coord>;
+			case morton_method::magicbits: return &m3D_d_magicbits<morton, coord>;
+#if LIBMORTON_X86_DISPATCH
+			case morton_method::BMI2: return &m3D_d_BMI<morton, coord>;
+#endif
+			default: return nullptr;
+			}
+		}
+
+		template<typename F>
+		inline bool bind(F& target, const F implementation) {
+			if (implementation == nullptr) { return false; }
+			target = implementation;
+			return true;
+		}
+
+		inline bool bind_method(morton_dispatch_table& t, const morton_slot slot, morton_method m) {
+			if (m == morton_method::automatic) { m = best_method(); }
+			if (!method_supported(m)) { return false; }
+			bool bound = false;
+			switch (slot) {
+			case morton_slot::m2D_32_encode: bound = bind(t.m2D_32_encode, encode2D<uint32_t, uint16_t>(m)); break;
+			case morton_slot::m2D_64_encode: bound = bind(t.m2D_64_encode, encode2D<uint64_t, uint32_t>(m)); break;
+			case morton_slot::m3D_32_encode: bound = bind(t.m3D_32_encode, encode3D<uint32_t, uint16_t>(m)); break;
+			case morton_slot::m3D_64_encode: bound = bind(t.m3D_64_encode, encode3D<uint64_t, uint32_t>(m)); break;
+			case morton_slot::m2D_32_decode: bound = bind(t.m2D_32_decode, decode2D<uint32_t, uint16_t>(m)); break;
+			case morton_slot::m2D_64_decode: bound = bind(t.m2D_64_decode, decode2D<uint64_t, uint32_t>(m)); break;
+			case morton_slot::m3D_32_decode: bound = bind(t.m3D_32_decode, decode3D<uint32_t, uint16_t>(m)); break;
+			case morton_slot::m3D_64_decode: bound = bind(t.m3D_64_decode, decode3D<uint64_t, uint32_t>(m)); break;
+#if LIBMORTON_HAS_UINT128
+			case morton_slot::m2D_128_encode: bound = bind(t.m2D_128_encode, encode2D<morton128_t, uint64_t>(m)); break;
+			case morton_slot::m3D_128_encode: bound = bind(t.m3D_128_encode, encode3D<morton128_t, uint64_t>(m)); break;
+			case morton_slot::m2D_128_decode: bound = bind(t.m2D_128_decode, decode2D<morton128_t, uint64_t>(m)); break;
+			case morton_slot::m3D_128_decode: bound = bind(t.m3D_128_decode, decode3D<morton128_t, uint64_t>(m)); break;
+#endif
+			}
+			if (bound) { t.methods[static_cast<size_t>(slot)] = m; }
+			return bound;
+		}
+
+		inline morton_dispatch_table& table();
+
+		// Batch fallbacks: loop over the single-code slots
+		inline void m2D_32_encode_loop(const uint16_t* x, const uint16_t* y, uint32_t* out, size_t n) {
+			const auto encode = table().m2D_32_encode;
+			for (size_t i = 0; i < n; ++i) { out[i] = encode(x[i], y[i]); }
+		}
+		inline void m2D_64_encode_loop(const uint32_t* x, const uint32_t* y, uint64_t* out, size_t n) {
+			const auto encode = table().m2D_64_encode;
+			for (size_t i = 0; i < n; ++i) { out[i] = encode(x[i], y[i]); }
+		}
+		inline void m3D_32_encode_loop(const uint16_t* x, const uint16_t* y, const uint16_t* z, uint32_t* out, size_t n) {
+			const auto encode = table().m3D_32_encode;
+			for (size_t i = 0; i < n; ++i) { out[i] = encode(x[i], y[i], z[i]); }
+		}
+		inline void m3D_64_encode_loop(const uint32_t* x, const uint32_t* y, const uint32_t* z, uint64_t* out, size_t n) {
+			const auto encode = table().m3D_64_encode;
+			for (size_t i = 0; i < n; ++i) { out[i] = encode(x[i], y[i], z[i]); }
+		}
+		inline void m2D_32_decode_loop(const uint32_t* m, uint16_t* x, uint16_t* y, size_t n) {
+			const auto decode = table().m2D_32_decode;
+			for (size_t i = 0; i < n; ++i) { decode(m[i], x[i], y[i]); }
+		}
+		inline void m2D_64_decode_loop(const uint64_t* m, uint32_t* x, uint32_t* y, size_t n) {
+			const auto decode = table().m2D_64_decode;
+			for (size_t i = 0; i < n; ++i) { decode(m[i], x[i], y[i]); }
+		}
+		inline void m3D_32_decode_loop(const uint32_t* m, uint16_t* x, uint16_t* y, uint16_t* z, size_t n) {
+			const auto decode = table().m3D_32_decode;
+			for (size_t i = 0; i < n; ++i) { decode(m[i], x[i], y[i], z[i]); }
+		}
+		inline void m3D_64_decode_loop(const uint64_t* m, uint32_t* x, uint32_t* y, uint32_t* z, size_t n) {
+			const auto decode = table().m3D_64_decode;
+			for (size_t i = 0; i < n; ++i) { decode(m[i], x[i], y[i], z[i]); }
+		}
+
+		inline bool bind_batch_method(morton_dispatch_table& t, morton_method m) {
+			if (m == morton_method::automatic) { m = best_batch_method(); }
+			if (!method_supported(m)) { return false; }
+#if LIBMORTON_X86_DISPATCH
+			if (m == morton_method::AVX2) {
+				t.m2D_32_encode_batch = &m2D_e_AVX2; t.m2D_64_encode_batch = &m2D_e_AVX2;
+				t.m3D_32_encode_batch = &m3D_e_AVX2; t.m3D_64_encode_batch = &m3D_e_AVX2;
+				t.m2D_32_decode_batch = &m2D_d_AVX2; t.m2D_64_decode_batch = &m2D_d_AVX2;
+				t.m3D_32_decode_batch = &m3D_d_AVX2; t.m3D_64_decode_batch = &m3D_d_AVX2;
+				t.m3D_32_neighbors_batch = &m3D_neighbors_AVX2; t.m3D_64_neighbors_batch = &m3D_neighbors_AVX2;
+				t.batch_method = m;
+				return true;
+			}
+#endif
+			t.m2D_32_encode_batch = &m2D_32_encode_loop; t.m2D_64_encode_batch = &m2D_64_encode_loop;
+			t.m3D_32_encode_batch = &m3D_32_encode_loop; t.m3D_64_encode_batch = &m3D_64_encode_loop;
+			t.m2D_32_decode_batch = &m2D_32_decode_loop; t.m2D_64_decode_batch = &m2D_64_decode_loop;
+			t.m3D_32_decode_batch = &m3D_32_decode_loop; t.m3D_64_decode_batch = &m3D_64_decode_loop;
+			t.m3D_32_neighbors_batch = &m3D_neighbors<uint32_t>; t.m3D_64_neighbors_batch = &m3D_neighbors<uint64_t>;
+			t.batch_method = morton_method::loop;
+			return true;
+		}
+
+		// Fastest methods for the host CPU, unless overridden by the environment
+		inline morton_dispatch_table make_table() {
+			morton_dispatch_table t;
+			for (size_t slot = 0; slot < morton_slot_count; ++slot) {
+				bind_method(t, static_cast<morton_slot>(slot), morton_method::automatic);
+			}
+			bind_batch_method(t, morton_method::automatic);
+
+			morton_method m;
+			const char* forced = getenv("LIBMORTON_METHOD");
+			if (forced != nullptr && parse_method(forced, m)) {
+				for (size_t slot = 0; slot < morton_slot_count; ++slot) {
+					bind_method(t, static_cast<morton_slot>(slot), m);
+				}
+			}
+			const char* forced_batch = getenv("LIBMORTON_BATCH_METHOD");
+			if (forced_batch != nullptr && parse_method(forced_batch, m)) {
+				bind_batch_method(t, m);
+			}
+			return t;
+		}
+
+		inline morton_dispatch_table& table() {
+			static morton_dispatch_table t = make_table();
+			return t;
+		}
+	}
+
+	// Bind method m to one of the single-code stubs. Returns false (and keeps the current method)
+	// if m is not available for that stub or not supported by the host CPU.
+	inline bool bind_method(const morton_slot slot, const morton_method m) {
+		return dispatch_detail::bind_method(dispatch_detail::table(), slot, m);
+	}
+
+	// Bind method m to all single-code stubs. Returns false if m is not available for some of them
+	// (e.g. CLMUL, which only encodes 2D): those keep their current method.
+	inline bool set_method(const morton_method m) {
+		if (!method_supported(m) || m == morton_method::AVX2) { return false; }
+		bool ok = true;
+		for (size_t slot = 0; slot < morton_slot_count; ++slot) {
+			ok &= bind_method(static_cast<morton_slot>(slot), m);
+		}
+		return ok;
+	}
+
+	// Bind method m to the batch stubs: AVX2, loop or automatic. Any single-code method also makes the
+	// batch stubs loop over the single-code stubs (the neighbor stubs then use m3D_neighbors).
+	inline bool set_batch_method(const morton_method m) {
+		return dispatch_detail::bind_batch_method(dispatch_detail::table(), m);
+	}
+
+	inline morton_method bound_method(const morton_slot slot) {
+		return dispatch_detail::table().methods[static_cast<size_t>(slot)];
+	}
+
+	inline morton_method bound_batch_method() {
+		return dispatch_detail::table().batch_method;
+	}
+}
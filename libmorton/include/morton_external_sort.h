@@ -0,0 +1,444 @@
+#pragma once
+
+// Libmorton - External sort of files of fixed size records by the 3D morton codes of their positions
+// For point files which do not fit in memory. The input is sorted in two phases:
+// - Runs: the input is read one run (as many records as fit in the memory budget) at a time, encoded on the
+//   threads of the default executor (see morton_parallel.h), sorted and written to a temporary file. Records are
+//   spread into buckets together with their codes, and sorted bucket by bucket in the cache. The next run is read
+//   on another thread meanwhile, and the previous one written while this one is encoded. An input which fits in one
+//   run is written straight to the output.
+// - Merge: the runs are merged, reading and encoding a block of every run at a time (ahead, on other threads), into
+//   the output.
+//   If there are more runs than blocks fit in the memory budget, groups of runs are merged into longer runs first.
+//
+// Codes are computed by a morton_record_key, which encodes the position stored in a batch of records:
+// morton_quantized_key for float / double positions in a bounding box, morton_coordinate_key for uint32_t
+// coordinates, or your own. The sort is stable. Files are read and written sequentially with buffered stdio calls
+// (no mmap or seeks), so this works on every platform, and for files larger than the address space.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "morton.h"
+#include "morton_parallel.h"
+#include "morton_quantize.h"
+#include "morton_sort.h"
+
+namespace libmorton {
+	// Computes the codes of n records of record_size bytes each. Called from several threads at once.
+	typedef std::function<void(const unsigned char* records, size_t record_size, size_t n, uint64_t* codes)> morton_record_key;
+
+	struct morton_external_sort_options {
+		// Bytes of memory to use for records, codes and buffers (the radix sort of a run included)
+		size_t memory = size_t(1) << 30;
+		// Largest read while merging: the blocks of every run, and of the output. Blocks get smaller (down to 64KB) if
+		// that lets all runs be merged in one pass.
+		size_t block = size_t(1) << 20;
+		// Runs go to temp_prefix + ".run0", ".run1", ... (default: next to the output)
+		std::string temp_prefix;
+	};
+
+	namespace external_detail {
+		// Positions gathered per block by the keys
+		static const size_t block = 256;
+		// Smallest block read while merging: smaller reads lose disk bandwidth (more than an extra merge pass costs)
+		static const size_t min_merge_block = size_t(1) << 16;
+
+		// Closes the file on scope exit
+		struct file {
+			FILE* f;
+			file(const std::string& path, const char* mode) : f(fopen(path.c_str(), mode)) {}
+			~file() { if (f != nullptr) { fclose(f); } }
+			file(const file&) = delete;
+			file& operator=(const file&) = delete;
+		};
+
+		// Read up to bytes bytes: fewer only at the end of the file (or on an error, see ferror)
+		inline size_t read(FILE* f, unsigned char* data, const size_t bytes) {
+			size_t done = 0;
+			while (done < bytes) {
+				const size_t got = fread(data + done, 1, bytes - done, f);
+				if (got == 0) { break; }
+				done += got;
+			}
+			return done;
+		}
+
+		inline bool write(FILE* f, const unsigned char* data, const size_t bytes) {
+			return bytes == 0 || fwrite(data, 1, bytes, f) == bytes;
+		}
+
+		// Removes the files on scope exit
+		struct temp_files {
+			std::vector<std::string> paths;
+			~temp_files() { for (size_t i = 0; i < paths.size(); ++i) { remove(paths[i].c_str()); } }
+		};
+
+		// Buckets of records are spread further until they hold about this many, then sorted by insertion
+		static const size_t small_bucket = 16;
+		// Records are spread through a buffer of bucket_buffer bytes per bucket if they and their codes take more than
+		// cache_block bytes
+		static const size_t cache_block = size_t(1) << 20;
+		static const size_t bucket_buffer = 256;
+		// Most buckets to spread records into at once
+		static const unsigned int max_bucket_bits = 10;
+
+		inline unsigned int highest_bit(const uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<unsigned int>(63 - __builtin_clzll(x));
+#else
+			unsigned long bit = 0;
+			findFirstSetBitZeroIdx(x, &bit);
+			return static_cast<unsigned int>(bit);
+#endif
+		}
+
+		// Spread records begin .. end - 1 of a and their codes into the buckets of their digit in b, from offsets on.
+		// Out of the cache, records go through a small buffer per bucket, like the codes of the radix sort.
+		inline void spread(const unsigned char* a, const uint64_t* a_codes, unsigned char* b, uint64_t* b_codes, const size_t begin, const size_t end,
+			const size_t record_size, const unsigned int shift, const size_t buckets, size_t* offsets) {
+			if ((end - begin) * (record_size + sizeof(uint64_t)) <= cache_block) {
+				for (size_t i = begin; i < end; ++i) {
+					const size_t to = offsets[(a_codes[i] >> shift) & (buckets - 1)]++;
+					memcpy(b + to * record_size, a + i * record_size, record_size);
+					b_codes[to] = a_codes[i];
+				}
+				return;
+			}
+			const size_t buffered = std::max<size_t>(1, bucket_buffer / record_size);
+			std::vector<unsigned char> record_buffer(buckets * buffered * record_size);
+			std::vector<uint64_t> code_buffer(buckets * buffered);
+			std::vector<size_t> fill(buckets, 0);
+			for (size_t i = begin; i < end; ++i) {
+				const size_t d = (a_codes[i] >> shift) & (buckets - 1);
+				memcpy(&record_buffer[(d * buffered + fill[d]) * record_size], a + i * record_size, record_size);
+				code_buffer[d * buffered + fill[d]] = a_codes[i];
+				if (++fill[d] == buffered) {
+					memcpy(b + offsets[d] * record_size, &record_buffer[d * buffered * record_size], buffered * record_size);
+					std::copy_n(&code_buffer[d * buffered], buffered, b_codes + offsets[d]);
+					offsets[d] += buffered;
+					fill[d] = 0;
+				}
+			}
+			for (size_t d = 0; d < buckets; ++d) {
+				memcpy(b + offsets[d] * record_size, &record_buffer[d * buffered * record_size], fill[d] * record_size);
+				std::copy_n(&code_buffer[d * buffered], fill[d], b_codes + offsets[d]);
+			}
+		}
+
+		// Sort the n records of a by their codes, into b if into_b or else back into a (the other one is scratch space,
+		// as are the codes). Records move together with their codes, most significant digit first: they are spread into
+		// buckets by the highest bits where their codes differ (stable, like the radix sort), and every bucket is sorted
+		// the same way, down to buckets of a few records. Buckets soon fit in the cache, so no record is fetched from
+		// far away, as gathering a whole run through a permutation would (a cache and TLB miss per record).
+		// parallel: spread slices of the records, then sort the buckets, on the threads of the default executor.
+		inline void sort_records(unsigned char* a, uint64_t* a_codes, unsigned char* b, uint64_t* b_codes, const size_t n, const size_t record_size,
+			const bool into_b, const bool parallel) {
+			if (n <= small_bucket) {
+				// Stable insertion sort of the positions of the records, which are then gathered into b
+				unsigned char order[small_bucket];
+				for (size_t i = 0; i < n; ++i) {
+					size_t j = i;
+					for (; j > 0 && a_codes[order[j - 1]] > a_codes[i]; --j) { order[j] = order[j - 1]; }
+					order[j] = static_cast<unsigned char>(i);
+				}
+				for (size_t i = 0; i < n; ++i) { memcpy(b + i * record_size, a + order[i] * record_size, record_size); }
+				if (!into_b) { memcpy(a, b, n * record_size); }
+				return;
+			}
+			uint64_t common_bits = ~uint64_t(0), any_bits = 0;
+			for (size_t i = 0; i < n; ++i) {
+				common_bits &= a_codes[i];
+				any_bits |= a_codes[i];
+			}
+			const uint64_t differ = common_bits ^ any_bits;
+			if (differ == 0) {
+				if (into_b) { memcpy(b, a, n * record_size); }
+				return;
+			}
+
+			unsigned int bits = 1;
+			while (bits < max_bucket_bits && (n >> bits) > small_bucket) { ++bits; }
+			const unsigned int top = highest_bit(differ) + 1;
+			const unsigned int shift = top > bits ? top - bits : 0;
+			const size_t buckets = size_t(1) << bits;
+			size_t start[(size_t(1) << max_bucket_bits) + 1] = {};
+			const unsigned int threads = parallel ? sort_detail::thread_count(n, 0, default_executor()) : 1;
+			if (threads == 1) {
+				size_t offsets[size_t(1) << max_bucket_bits];
+				for (size_t i = 0; i < n; ++i) { ++start[((a_codes[i] >> shift) & (buckets - 1)) + 1]; }
+				for (size_t d = 0; d < buckets; ++d) { start[d + 1] += start[d]; }
+				std::copy_n(start, buckets, offsets);
+				spread(a, a_codes, b, b_codes, 0, n, record_size, shift, buckets, offsets);
+			}
+			else {
+				// Every slice spreads to its own part of every bucket
+				const auto slice_begin = [n, threads](const unsigned int t) { return n / threads * t + std::min<size_t>(t, n % threads); };
+				std::vector<size_t> offsets(threads * buckets, 0);
+				sort_detail::run_threads(threads, default_executor(), [&](const unsigned int t) {
+					size_t* c = &offsets[t * buckets];
+					for (size_t i = slice_begin(t); i < slice_begin(t + 1); ++i) { ++c[(a_codes[i] >> shift) & (buckets - 1)]; }
+				});
+				size_t sum = 0;
+				for (size_t d = 0; d < buckets; ++d) {
+					start[d] = sum;
+					for (unsigned int t = 0; t < threads; ++t) {
+						const size_t c = offsets[t * buckets + d];
+						offsets[t * buckets + d] = sum;
+						sum += c;
+					}
+				}
+				start[buckets] = n;
+				sort_detail::run_threads(threads, default_executor(), [&](const unsigned int t) {
+					spread(a, a_codes, b, b_codes, slice_begin(t), slice_begin(t + 1), record_size, shift, buckets, &offsets[t * buckets]);
+				});
+			}
+
+			const auto bucket = [&](const size_t d) {
+				const size_t first = start[d], count = start[d + 1] - start[d];
+				sort_records(b + first * record_size, b_codes + first, a + first * record_size, a_codes + first, count, record_size, !into_b, false);
+			};
+			if (parallel) { default_executor().run(buckets, bucket); }
+			else {
+				for (size_t d = 0; d < buckets; ++d) { bucket(d); }
+			}
+		}
+
+		// Sort the input into runs of run_records records. An input which fits in one run is written to output, and
+		// leaves no runs to merge.
+		inline bool make_runs(const std::string& input, const std::string& output, const size_t record_size, const morton_record_key& key, const size_t run_records,
+			const std::string& prefix, temp_files& temps, std::vector<std::string>& runs) {
+			file in(input, "rb");
+			if (in.f == nullptr) { return false; }
+			const size_t run_bytes = run_records * record_size;
+			// Not initialized: the pages a small input does not use are never touched. The run in current is sorted
+			// into sorted (once the last one is written from there) while the next one is read into next.
+			std::unique_ptr<unsigned char[]> current(new unsigned char[run_bytes]), next(new unsigned char[run_bytes]), sorted(new unsigned char[run_bytes]);
+			std::unique_ptr<uint64_t[]> codes(new uint64_t[run_records]), spare_codes(new uint64_t[run_records]);
+
+			std::future<size_t> reading = std::async(std::launch::async, [&] { return read(in.f, next.get(), run_bytes); });
+			std::future<bool> writing;
+			while (true) {
+				const size_t bytes = reading.get();
+				if (ferror(in.f) || bytes % record_size != 0) {
+					if (writing.valid()) { writing.wait(); }
+					return false;
+				}
+				if (bytes == 0 && !runs.empty()) { break; }
+				current.swap(next);
+				const bool last = bytes < run_bytes;
+				if (!last) { reading = std::async(std::launch::async, [&] { return read(in.f, next.get(), run_bytes); }); }
+
+				const size_t n = bytes / record_size;
+				morton_parallel_for(n, [&](size_t b, size_t e) { key(current.get() + b * record_size, record_size, e - b, codes.get() + b); });
+				if (writing.valid() && !writing.get()) {
+					if (!last) { reading.wait(); }
+					return false;
+				}
+				sort_records(current.get(), codes.get(), sorted.get(), spare_codes.get(), n, record_size, true, true);
+				const bool only = last && runs.empty();
+				const std::string path = only ? output : prefix + ".run" + std::to_string(temps.paths.size());
+				if (!only) {
+					runs.push_back(path);
+					temps.paths.push_back(path);
+				}
+				const unsigned char* data = sorted.get();
+				writing = std::async(std::launch::async, [data, path, bytes] {
+					file out(path, "wb");
+					return out.f != nullptr && write(out.f, data, bytes) && fflush(out.f) == 0;
+				});
+				if (last) { break; }
+			}
+			return !writing.valid() || writing.get();
+		}
+
+		// A run being merged: the block of records being merged with their codes, and the next block being read and encoded
+		struct merge_input {
+			FILE* f = nullptr;
+			std::vector<unsigned char> records, next;
+			std::vector<uint64_t> codes, next_codes;
+			size_t count = 0, position = 0;
+			std::future<size_t> reading;
+		};
+
+		inline size_t less(const std::pair<uint64_t, size_t>& a, const std::pair<uint64_t, size_t>& b) {
+			return static_cast<size_t>(a.first < b.first) | (static_cast<size_t>(a.first == b.first) & static_cast<size_t>(a.second < b.second));
+		}
+
+		// Merge the runs (in order, for a stable sort) into output
+		inline bool merge(const std::vector<std::string>& runs, const std::string& output, const size_t record_size, const morton_record_key& key, const size_t block_records) {
+			const size_t block_bytes = block_records * record_size;
+			std::vector<merge_input> inputs(runs.size());
+			std::vector<std::unique_ptr<file>> files;
+			bool ok = true;
+			const auto start_read = [&](merge_input& input) {
+				input.reading = std::async(std::launch::async, [&input, &key, block_bytes, record_size] {
+					const size_t bytes = read(input.f, input.next.data(), block_bytes);
+					key(input.next.data(), record_size, bytes / record_size, input.next_codes.data());
+					return bytes;
+				});
+			};
+			// Swap in the block read ahead and start reading the next one; false at the end of the run
+			const auto refill = [&](merge_input& input) {
+				const size_t bytes = input.reading.get();
+				ok &= !ferror(input.f) && bytes % record_size == 0;
+				input.count = ok ? bytes / record_size : 0;
+				input.position = 0;
+				if (input.count == 0) { return false; }
+				input.records.swap(input.next);
+				input.codes.swap(input.next_codes);
+				start_read(input);
+				return true;
+			};
+
+			// Tournament tree of the runs by their next code (ties: earliest run first). Every inner node holds the run
+			// which lost the match there, and winner the run which won them all: after taking a record from it, only
+			// the matches on its way to the root are played again, without branches on the codes, which are as good as
+			// random. Finished runs get the largest code and the number of leaves added to theirs, so they lose to every
+			// other run.
+			size_t leaves = 1;
+			while (leaves < runs.size()) { leaves *= 2; }
+			std::vector<std::pair<uint64_t, size_t>> next(leaves);
+			for (size_t r = 0; r < runs.size(); ++r) {
+				files.emplace_back(new file(runs[r], "rb"));
+				if (files.back()->f == nullptr) { ok = false; break; }
+				merge_input& input = inputs[r];
+				input.f = files.back()->f;
+				input.records.resize(block_bytes);
+				input.next.resize(block_bytes);
+				input.codes.resize(block_records);
+				input.next_codes.resize(block_records);
+				start_read(input);
+			}
+			if (!ok) {
+				// Leave the output alone, once the runs already opened are no longer read
+				for (size_t r = 0; r < inputs.size(); ++r) {
+					if (inputs[r].reading.valid()) { inputs[r].reading.wait(); }
+				}
+				return false;
+			}
+			for (size_t r = 0; r < leaves; ++r) {
+				const bool more = r < runs.size() && refill(inputs[r]);
+				next[r] = more ? std::make_pair(inputs[r].codes[0], r) : std::make_pair(~uint64_t(0), leaves + r);
+			}
+			std::vector<size_t> loser(leaves), winners(2 * leaves);
+			for (size_t r = 0; r < leaves; ++r) { winners[leaves + r] = r; }
+			for (size_t node = leaves - 1; node > 0; --node) {
+				const size_t a = winners[2 * node], b = winners[2 * node + 1];
+				const bool a_wins = less(next[a], next[b]) != 0;
+				winners[node] = a_wins ? a : b;
+				loser[node] = a_wins ? b : a;
+			}
+			size_t winner = leaves > 1 ? winners[1] : 0;
+
+			file out(output, "wb");
+			ok &= out.f != nullptr;
+			std::vector<unsigned char> buffer(block_bytes), written(block_bytes);
+			size_t filled = 0;
+			std::future<bool> writing;
+			while (ok && next[winner].second < leaves) {
+				merge_input& input = inputs[winner];
+				memcpy(buffer.data() + filled, input.records.data() + input.position * record_size, record_size);
+				filled += record_size;
+				if (filled == block_bytes) {
+					if (writing.valid()) { ok &= writing.get(); }
+					buffer.swap(written);
+					writing = std::async(std::launch::async, [&, filled] { return write(out.f, written.data(), filled); });
+					filled = 0;
+				}
+				if (++input.position < input.count || refill(input)) { next[winner].first = input.codes[input.position]; }
+				else { next[winner] = std::make_pair(~uint64_t(0), leaves + winner); }
+				for (size_t node = (winner + leaves) / 2; node > 0; node /= 2) {
+					const size_t other = loser[node];
+					const size_t swap = less(next[other], next[winner]);
+					loser[node] = swap ? winner : other;
+					winner = swap ? other : winner;
+				}
+			}
+			if (writing.valid()) { ok &= writing.get(); }
+			for (size_t r = 0; r < inputs.size(); ++r) {
+				if (inputs[r].reading.valid()) { inputs[r].reading.wait(); }
+			}
+			return ok && out.f != nullptr && write(out.f, buffer.data(), filled) && fflush(out.f) == 0;
+		}
+
+		// Gather the positions of records into blocks, and encode them
+		template<typename T, typename function>
+		inline void encode_positions(const unsigned char* records, const size_t record_size, const size_t offset, const size_t n, uint64_t* codes, const function& encode) {
+			T x[block], y[block], z[block];
+			for (size_t begin = 0; begin < n; begin += block) {
+				const size_t count = std::min(block, n - begin);
+				for (size_t i = 0; i < count; ++i) {
+					const unsigned char* p = records + (begin + i) * record_size + offset;
+					memcpy(&x[i], p, sizeof(T));
+					memcpy(&y[i], p + sizeof(T), sizeof(T));
+					memcpy(&z[i], p + 2 * sizeof(T), sizeof(T));
+				}
+				encode(x, y, z, codes + begin, count);
+			}
+		}
+	}
+
+	// Key of records with a float / double position x, y, z at byte offset, quantized in box (see morton_quantize.h)
+	template<typename real>
+	inline morton_record_key morton_quantized_key(const size_t offset, const morton_aabb<real, 3>& box) {
+		return [offset, box](const unsigned char* records, size_t record_size, size_t n, uint64_t* codes) {
+			external_detail::encode_positions<real>(records, record_size, offset, n, codes, [&box](const real* x, const real* y, const real* z, uint64_t* out, size_t count) {
+				m3D_quantize_encode<uint64_t, real>(x, y, z, box, out, count);
+			});
+		};
+	}
+
+	// Key of records with uint32_t coordinates x, y, z (below 2^21) at byte offset
+	inline morton_record_key morton_coordinate_key(const size_t offset) {
+		return [offset](const unsigned char* records, size_t record_size, size_t n, uint64_t* codes) {
+			external_detail::encode_positions<uint32_t>(records, record_size, offset, n, codes, [](const uint32_t* x, const uint32_t* y, const uint32_t* z, uint64_t* out, size_t count) {
+				morton3D_64_encode_batch(x, y, z, out, count);
+			});
+		};
+	}
+
+	// EXTERNAL SORT : write the records of input (record_size bytes each) to output, sorted by their key
+	// Returns false if a file cannot be read or written, or if the input size is not a multiple of record_size.
+	inline bool morton_external_sort(const std::string& input, const std::string& output, const size_t record_size, const morton_record_key& key,
+		const morton_external_sort_options& options = morton_external_sort_options()) {
+		if (record_size == 0) { return false; }
+		const std::string prefix = options.temp_prefix.empty() ? output : options.temp_prefix;
+		external_detail::temp_files temps;
+		std::vector<std::string> runs;
+
+		// Per record of a run: three copies (being read, being sorted, sorted and written) and two codes
+		const size_t run_records = std::max<size_t>(1, std::min<size_t>(options.memory / (3 * record_size + 16), std::numeric_limits<uint32_t>::max()));
+		if (!external_detail::make_runs(input, output, record_size, key, run_records, prefix, temps, runs)) { return false; }
+		if (runs.empty()) { return true; }
+
+		// Per run merged: a block being merged and one being read, with their codes; two output blocks
+		const size_t per_record = 2 * (record_size + sizeof(uint64_t));
+		const size_t largest = std::max<size_t>(1, options.block / record_size);
+		const size_t one_pass = options.memory / ((runs.size() + 1) * per_record);
+		const size_t smallest = std::max<size_t>(1, external_detail::min_merge_block / record_size);
+		const size_t block_records = std::max(std::min(largest, one_pass), std::min(largest, smallest));
+		const size_t fan_in = std::max<size_t>(2, options.memory / (block_records * per_record) - 1);
+		while (runs.size() > fan_in) {
+			std::vector<std::string> merged;
+			for (size_t first = 0; first < runs.size(); first += fan_in) {
+				const std::vector<std::string> group(runs.begin() + first, runs.begin() + std::min(runs.size(), first + fan_in));
+				merged.push_back(prefix + ".run" + std::to_string(temps.paths.size()));
+				temps.paths.push_back(merged.back());
+				if (!external_detail::merge(group, merged.back(), record_size, key, block_records)) { return false; }
+				for (size_t r = 0; r < group.size(); ++r) { remove(group[r].c_str()); }
+			}
+			runs.swap(merged);
+		}
+		return external_detail::merge(runs, output, record_size, key, block_records);
+	}
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+// Libmorton - Dense 2D / 3D grid stored in Z-order
+// morton_grid<T, 3> holds a cube of side x side x side elements (side a power of 2), element (x, y, z) at index
+// morton3D_64_encode(x, y, z); morton_grid<T, 2> holds a square the same way. Elements are accessed by coordinates
+// (encoded with the morton.h methods picked for this CPU) or by morton code.
+//
+// Iterating over the grid with begin() / end() visits the elements in Z-order, which is the order they are stored in.
+// x_major_begin() / x_major_end() visit them with x changing fastest, then y, then z (the order of a row-major array):
+// the iterator steps to the next element with a dilated increment of the code (see morton_dilated.h) instead of
+// encoding every position. Sub-box views iterate the same way over a part of the grid.
+//
+// copy_from / copy_to convert from / to row-major arrays 2 x 2 (x 2) elements at a time: these blocks are contiguous
+// in Z-order, and only one code is computed for every block.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#include "morton.h"
+#include "morton_dilated.h"
+
+namespace libmorton {
+	namespace grid_detail {
+		// Encode coordinates with the morton.h methods, by number of dimensions
+		template<unsigned int dims> struct codec;
+		template<> struct codec<2> {
+			static uint64_t encode(const std::array<uint32_t, 2>& c) { return morton2D_64_encode(c[0], c[1]); }
+		};
+		template<> struct codec<3> {
+			static uint64_t encode(const std::array<uint32_t, 3>& c) { return morton3D_64_encode(c[0], c[1], c[2]); }
+		};
+
+		// Smallest power of 2 not below side
+		inline uint32_t round_side(const uint32_t side) {
+			uint32_t rounded = 1;
+			while (rounded < side) { rounded <<= 1; }
+			return rounded;
+		}
+	}
+
+	// Iterator over a box of a grid in x-major order: x changes fastest, then y, then z
+	template<typename T, unsigned int dims>
+	class morton_box_iterator {
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef typename std::remove_const<T>::type value_type;
+		typedef ptrdiff_t difference_type;
+		typedef T* pointer;
+		typedef T& reference;
+
+		morton_box_iterator() : data_(nullptr), code_(0), first_(), extent_(), at_(), position_(0) {}
+		// Iterator at the first element of the box lo .. lo + extent - 1 of the grid data
+		morton_box_iterator(T* data, const std::array<uint32_t, dims>& lo, const std::array<uint32_t, dims>& extent)
+			: data_(data), code_(grid_detail::codec<dims>::encode(lo)), first_(), extent_(extent), at_(), position_(0) {
+			for (unsigned int axis = 0; axis < dims; ++axis) {
+				std::array<uint32_t, dims> corner = {};
+				corner[axis] = lo[axis];
+				first_[axis] = grid_detail::codec<dims>::encode(corner);
+			}
+		}
+		// Iterator past the last element of a box of size elements (only compares with other iterators)
+		explicit morton_box_iterator(const size_t size) : data_(nullptr), code_(0), first_(), extent_(), at_(), position_(size) {}
+
+		reference operator*() const { return data_[code_]; }
+		pointer operator->() const { return data_ + code_; }
+		morton_box_iterator& operator++() {
+			++position_;
+			if (++at_[0] < extent_[0]) {
+				code_ = dilated_detail::inc<uint64_t, dims>(code_, 0);
+				return *this;
+			}
+			// Back to the start of the box along x, and on to the next y (then z)
+			for (unsigned int axis = 0; axis < dims; ++axis) {
+				if (axis > 0 && ++at_[axis] < extent_[axis]) {
+					code_ = dilated_detail::inc<uint64_t, dims>(code_, axis);
+					return *this;
+				}
+				at_[axis] = 0;
+				code_ = (code_ & ~dilated_detail::lane<uint64_t, dims>(axis)) | first_[axis];
+			}
+			return *this;
+		}
+		morton_box_iterator operator++(int) {
+			morton_box_iterator before = *this;
+			++*this;
+			return before;
+		}
+		bool operator==(const morton_box_iterator& other) const { return position_ == other.position_; }
+		bool operator!=(const morton_box_iterator& other) const { return position_ != other.position_; }
+
+		// Morton code of the element, and its coordinates relative to the box
+		uint64_t code() const { return code_; }
+		uint32_t coordinate(const unsigned int axis) const { return at_[axis]; }
+
+	private:
+		T* data_;
+		uint64_t code_;
+		std::array<uint64_t, dims> first_; // code of the lowest coordinate of the box on every axis
+		std::array<uint32_t, dims> extent_;
+		std::array<uint32_t, dims> at_;
+		size_t position_;
+	};
+
+	// View of the box lo .. lo + extent - 1 of a grid (T const for read-only views)
+	template<typename T, unsigned int dims>
+	class morton_grid_view {
+	public:
+		typedef morton_box_iterator<T, dims> iterator;
+
+		morton_grid_view(T* data, const std::array<uint32_t, dims>& lo, const std::array<uint32_t, dims>& extent) : data_(data), lo_(lo), extent_(extent) {}
+
+		uint32_t extent(const unsigned int axis) const { return extent_[axis]; }
+		size_t size() const {
+			size_t count = 1;
+			for (unsigned int axis = 0; axis < dims; ++axis) { count *= extent_[axis]; }
+			return count;
+		}
+
+		// Element at coordinates relative to the box
+		template<typename... coords>
+		T& operator()(const coords... c) const {
+			static_assert(sizeof...(coords) == dims, "one coordinate per dimension");
+			std::array<uint32_t, dims> at = { { static_cast<uint32_t>(c)... } };
+			for (unsigned int axis = 0; axis < dims; ++axis) { at[axis] += lo_[axis]; }
+			return data_[grid_detail::codec<dims>::encode(at)];
+		}
+
+		// Elements in x-major order
+		iterator begin() const { return size() == 0 ? end() : iterator(data_, lo_, extent_); }
+		iterator end() const { return iterator(size()); }
+
+		// Copy from / to a row-major array of extent(0) x extent(1) (x extent(2)) elements
+		template<typename U>
+		void copy_from(const U* src) const {
+			for (iterator it = begin(); it != end(); ++it, ++src) { *it = *src; }
+		}
+		template<typename U>
+		void copy_to(U* dst) const {
+			for (iterator it = begin(); it != end(); ++it, ++dst) { *dst = *it; }
+		}
+		template<typename U>
+		void fill(const U& value) const {
+			for (iterator it = begin(); it != end(); ++it) { *it = value; }
+		}
+
+	private:
+		T* data_;
+		std::array<uint32_t, dims> lo_;
+		std::array<uint32_t, dims> extent_;
+	};
+
+	// Dense grid of side^dims elements in Z-order (dims = 2 or 3)
+	template<typename T, unsigned int dims = 3>
+	class morton_grid {
+		static_assert(dims == 2 || dims == 3, "morton grids are 2D or 3D");
+	public:
+		typedef T* iterator;
+		typedef const T* const_iterator;
+		typedef morton_box_iterator<T, dims> x_major_iterator;
+		typedef morton_box_iterator<const T, dims> const_x_major_iterator;
+
+		// Grid of side^dims elements, side rounded up to a power of 2 (up to 2^21 for 3D grids, 2^32 for 2D grids)
+		explicit morton_grid(const uint32_t side = 0, const T& value = T())
+			: side_(side == 0 ? 0 : grid_detail::round_side(side)), elements_(volume(side_), value) {}
+
+		uint32_t side() const { return side_; }
+		size_t size() const { return elements_.size(); }
+		T* data() { return elements_.data(); }
+		const T* data() const { return elements_.data(); }
+
+		// Element by morton code
+		T& operator[](const uint64_t code) { return elements_[code]; }
+		const T& operator[](const uint64_t code) const { return elements_[code]; }
+
+		// Element by coordinates
+		template<typename... coords>
+		T& operator()(const coords... c) { return elements_[encode(c...)]; }
+		template<typename... coords>
+		const T& operator()(const coords... c) const { return elements_[encode(c...)]; }
+
+		// Elements in Z-order
+		iterator begin() { return elements_.data(); }
+		iterator end() { return elements_.data() + elements_.size(); }
+		const_iterator begin() const { return elements_.data(); }
+		const_iterator end() const { return elements_.data() + elements_.size(); }
+
+		// Elements in x-major order
+		x_major_iterator x_major_begin() { return all().begin(); }
+		x_major_iterator x_major_end() { return all().end(); }
+		const_x_major_iterator x_major_begin() const { return all().begin(); }
+		const_x_major_iterator x_major_end() const { return all().end(); }
+
+		// View of the box lo .. lo + extent - 1
+		morton_grid_view<T, dims> view(const std::array<uint32_t, dims>& lo, const std::array<uint32_t, dims>& extent) {
+			return morton_grid_view<T, dims>(elements_.data(), lo, extent);
+		}
+		morton_grid_view<const T, dims> view(const std::array<uint32_t, dims>& lo, const std::array<uint32_t, dims>& extent) const {
+			return morton_grid_view<const T, dims>(elements_.data(), lo, extent);
+		}
+
+		void fill(const T& value) { std::fill(elements_.begin(), elements_.end(), value); }
+
+		// Copy from / to a row-major array of side^dims elements (x changing fastest)
+		void copy_from(const T* src) { convert<const T, T>(src, elements_.data(), true); }
+		void copy_to(T* dst) const { convert<const T, T>(elements_.data(), dst, false); }
+
+	private:
+		uint32_t side_;
+		std::vector<T> elements_;
+
+		static size_t volume(const uint32_t side) {
+			size_t count = 1;
+			for (unsigned int axis = 0; axis < dims; ++axis) { count *= side; }
+			return count;
+		}
+
+		template<typename... coords>
+		static uint64_t encode(const coords... c) {
+			static_assert(sizeof...(coords) == dims, "one coordinate per dimension");
+			return grid_detail::codec<dims>::encode({ { static_cast<uint32_t>(c)... } });
+		}
+
+		morton_grid_view<T, dims> all() { return view(std::array<uint32_t, dims>(), full()); }
+		morton_grid_view<const T, dims> all() const { return view(std::array<uint32_t, dims>(), full()); }
+		std::array<uint32_t, dims> full() const {
+			std::array<uint32_t, dims> extent;
+			extent.fill(side_);
+			return extent;
+		}
+
+		// Blocks of 2 x 2 (x 2) elements: rows of two elements of (y, z), (y + 1, z), (y, z + 1), (y + 1, z + 1), one
+		// after the other in Z-order. The next block along x is 2 further in x: a dilated add.
+		template<typename from, typename to>
+		void convert(from* src, to* dst, const bool to_grid) const {
+			if (side_ == 1) { dst[0] = src[0]; }
+			if (side_ < 2) { return; }
+			const size_t side = side_, plane = dims == 3 ? side * side : 0;
+			const uint64_t step = uint64_t(1) << dims;
+			for (size_t z = 0; z < (dims == 3 ? side : 1); z += 2) {
+				for (size_t y = 0; y < side; y += 2) {
+					std::array<uint32_t, dims> corner = {};
+					corner[1] = static_cast<uint32_t>(y);
+					if (dims == 3) { corner[dims - 1] = static_cast<uint32_t>(z); }
+					uint64_t code = grid_detail::codec<dims>::encode(corner);
+					const size_t row = z * plane + y * side;
+					for (size_t x = 0; x < side; x += 2, code = dilated_detail::add<uint64_t, dims>(code, step)) {
+						for (size_t r = 0; r < (size_t(1) << (dims - 1)); ++r) {
+							const size_t linear = row + (r & 1) * side + (r >> 1) * plane + x;
+							const size_t z_order = code + 2 * r;
+							if (to_grid) {
+								dst[z_order] = src[linear];
+								dst[z_order + 1] = src[linear + 1];
+							}
+							else {
+								dst[linear] = src[z_order];
+								dst[linear + 1] = src[z_order + 1];
+							}
+						}
+					}
+				}
+			}
+		}
+	};
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+// Libmorton - Methods to generate the neighbors of 3D morton codes in bulk
+// The x, y and z bits of a neighbor are x - 1, x or x + 1 (same for y and z), so after computing those 9 dilated
+// integers once per code (see morton_dilated.h), every neighbor costs two ORs.
+//
+// Neighbor j of m[i] goes to out[j * n + i]: out holds one array of n codes per neighbor, like the batch decoders
+// write one array per coordinate. Neighbors are ordered by the number of coordinates that change: the first 6 share
+// a face with the cell, the next 12 an edge, the last 8 a corner (see m3D_neighbor_offset).
+// Bit j of valid[i] tells whether neighbor j of m[i] lies in the domain, the box from (0, 0, 0) to the coordinates of
+// max_code (pass the code of (xsize - 1, ysize - 1, zsize - 1), or ~0 for the whole coordinate range).
+// Neighbors outside the domain are written too, with their coordinates wrapped around.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "morton_common.h"
+#include "morton_dilated.h"
+
+namespace libmorton {
+	// Number of neighbors: cells sharing a face (6), a face or an edge (18), or a face, edge or corner (26)
+	enum class morton_stencil : unsigned int { face = 6, edge = 18, corner = 26 };
+
+	namespace neighbors_detail {
+		struct stencil_table {
+			int8_t offset[26][3];
+			uint8_t boundary[26]; // boundary flags which put neighbor j outside the domain
+			uint32_t valid[64]; // valid neighbors for every combination of boundary flags
+		};
+
+		// Boundary flags of a cell: bit 2 * axis is set if its coordinate is 0, bit 2 * axis + 1 if it is the largest in the domain
+		constexpr stencil_table make_stencil_table() {
+			stencil_table t{};
+			unsigned int j = 0;
+			for (int changed = 1; changed <= 3; ++changed) {
+				for (int dz = -1; dz <= 1; ++dz) {
+					for (int dy = -1; dy <= 1; ++dy) {
+						for (int dx = -1; dx <= 1; ++dx) {
+							const int d[3] = { dx, dy, dz };
+							if ((dx != 0) + (dy != 0) + (dz != 0) != changed) { continue; }
+							for (unsigned int axis = 0; axis < 3; ++axis) {
+								t.offset[j][axis] = static_cast<int8_t>(d[axis]);
+								if (d[axis] != 0) { t.boundary[j] |= static_cast<uint8_t>(1u << (2 * axis + (d[axis] > 0))); }
+							}
+							++j;
+						}
+					}
+				}
+			}
+			for (unsigned int flags = 0; flags < 64; ++flags) {
+				for (j = 0; j < 26; ++j) {
+					if ((t.boundary[j] & flags) == 0) { t.valid[flags] |= 1u << j; }
+				}
+			}
+			return t;
+		}
+
+		template<typename unused = void>
+		struct stencil_LUT {
+			static constexpr stencil_table table = make_stencil_table();
+		};
+		template<typename unused>
+		constexpr stencil_table stencil_LUT<unused>::table;
+
+		// Coordinate axis minus one, as is and plus one, and the boundary flags of the coordinate
+		template<typename morton>
+		inline unsigned int axis_steps(const morton m, const morton max_code, const unsigned int axis, morton steps[3]) {
+			const morton lane = dilated_detail::lane<morton, 3>(axis);
+			steps[0] = dilated_detail::sub_lane<morton, 3>(m, static_cast<morton>(static_cast<morton>(1) << axis), axis);
+			steps[1] = m & lane;
+			steps[2] = dilated_detail::add_lane<morton, 3>(m, static_cast<morton>(static_cast<morton>(1) << axis), axis);
+			return (static_cast<unsigned int>(steps[1] == 0) | (static_cast<unsigned int>(steps[1] >= (max_code & lane)) << 1)) << (2 * axis);
+		}
+
+		// Neighbors of m[begin .. n-1], neighbor j of m[i] goes to out[j * n + i]
+		template<typename morton>
+		inline void neighbors(const morton* m, size_t begin, size_t n, const morton_stencil stencil, const morton max_code, morton* out, uint32_t* valid) {
+			const stencil_table& t = stencil_LUT<>::table;
+			const unsigned int k = static_cast<unsigned int>(stencil);
+			for (size_t i = begin; i < n; ++i) {
+				morton x[3], y[3], z[3];
+				const unsigned int flags = axis_steps<morton>(m[i], max_code, 0, x) | axis_steps<morton>(m[i], max_code, 1, y) | axis_steps<morton>(m[i], max_code, 2, z);
+				for (unsigned int j = 0; j < k; ++j) {
+					out[j * n + i] = x[t.offset[j][0] + 1] | y[t.offset[j][1] + 1] | z[t.offset[j][2] + 1];
+				}
+				valid[i] = t.valid[flags] & ((1u << k) - 1);
+			}
+		}
+	}
+
+	// Coordinate offsets (-1, 0 or 1) of neighbor j
+	inline void m3D_neighbor_offset(const unsigned int j, int& dx, int& dy, int& dz) {
+		const int8_t* d = neighbors_detail::stencil_LUT<>::table.offset[j];
+		dx = d[0]; dy = d[1]; dz = d[2];
+	}
+
+	// NEIGHBORS of 3D morton codes (batch) : dilated integer arithmetic
+	template<typename morton>
+	inline void m3D_neighbors(const morton* m, size_t n, const morton_stencil stencil, const morton max_code, morton* out, uint32_t* valid) {
+		neighbors_detail::neighbors<morton>(m, 0, n, stencil, max_code, out, valid);
+	}
+}
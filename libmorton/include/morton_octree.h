@@ -0,0 +1,171 @@
+#pragma once
+
+// Libmorton - Linear octree over sorted 3D morton codes
+// Every point is found in the cells of levels 0 .. 21 holding its code (see morton_tree.h). The octree has the root
+// as node, and every non-empty child of a node with more than max_points points (leaves hold at most max_points
+// points, unless they are cells of the deepest level). Nodes are stored in depth-first order, which is the order of
+// their first points, so they are built in parallel without a pointer tree:
+// - A cell of level L holds more than max_points points if max_points + 1 consecutive codes share it, so the level
+//   of the leaf of point i is one deeper than the deepest level shared by any max_points + 1 codes around i (a
+//   sliding window maximum of common_level(code[j], code[j + max_points])).
+// - The nodes which start at point i are its cells from one level below common_level(code[i - 1], code[i]) down to
+//   its leaf; a prefix sum over blocks of points gives their positions.
+// - The subtree of a node ends at the first node with a larger key than its last code: found by galloping search, only
+//   for the nodes which have children.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "morton_parallel.h"
+#include "morton_tree.h"
+
+namespace libmorton {
+	// Nodes of a linear octree, in depth-first order (node 0 is the root), index: type of point and node indices
+	template<typename index = uint32_t>
+	struct morton_octree {
+		std::vector<uint64_t> keys;       // anchor code of every node (see morton_tree.h)
+		std::vector<uint8_t> levels;      // level of every node, 0 for the root
+		std::vector<uint8_t> child_masks; // bit i set if child i of the node is a node, 0 for leaves
+		std::vector<index> points;        // first point of every node, and the number of points after the last node
+		std::vector<index> next;          // first node after the subtree of every node (the node count for the last ones)
+
+		size_t size() const { return keys.size(); }
+		bool leaf(const size_t node) const { return child_masks[node] == 0; }
+		// Points of a node: point_begin(node) .. point_end(node) - 1
+		index point_begin(const size_t node) const { return points[node]; }
+		index point_end(const size_t node) const { return points[next[node]]; }
+		// The first child of a node is the next node, every next child comes after the subtree of the one before
+		size_t first_child(const size_t node) const { return node + 1; }
+		size_t next_sibling(const size_t node) const { return next[node]; }
+		// Bytes taken by the node arrays
+		size_t memory() const { return size() * (sizeof(uint64_t) + 2 * sizeof(uint8_t) + 2 * sizeof(index)) + sizeof(index); }
+	};
+
+	namespace octree_detail {
+		// Points per task
+		static const size_t block = size_t(1) << 16;
+		static const int levels = static_cast<int>(m3D_levels<uint64_t>());
+
+		// Call f(begin, end) for blocks of items covering [0, n) on the threads of executor
+		template<typename function>
+		inline void for_blocks(const size_t n, morton_executor& executor, const function& f) {
+			executor.run((n + block - 1) / block, [&](const size_t t) { f(t * block, std::min(n, (t + 1) * block)); });
+		}
+
+		// Level of the cell of point i which begins at i (one below the deepest cell it shares with point i - 1)
+		inline int start_level(const uint64_t* codes, const size_t i) {
+			return i == 0 ? 0 : static_cast<int>(m3D_common_level<uint64_t>(codes[i - 1], codes[i])) + 1;
+		}
+
+		// First node after node with a key above last: galloping search, as most subtrees are small
+		inline size_t subtree_end(const uint64_t* keys, const size_t nodes, const size_t node, const uint64_t last) {
+			size_t low = node + 1, step = 1;
+			while (low + step < nodes && keys[low + step] <= last) {
+				low += step;
+				step *= 2;
+			}
+			return static_cast<size_t>(std::upper_bound(keys + low, keys + std::min(nodes, low + step), last) - keys);
+		}
+
+		// Leaf level of every point: one below the deepest level shared by codes j and j + max_points, over the windows
+		// j = i - max_points .. i of max_points + 1 codes holding point i (the root if it is in none). Tasks of at least
+		// k = max_points + 1 points take the sliding window maximum (van Herk / Gil-Werman) over the windows of their
+		// points, from prefix maxima from the start of every span of k windows and suffix maxima to its end: at most
+		// twice as many windows as points, which stay in the cache.
+		inline void leaf_levels(const uint64_t* codes, const size_t n, const size_t max_points, int8_t* leaf, morton_executor& executor) {
+			if (max_points >= n) {
+				std::fill(leaf, leaf + n, int8_t(0));
+				return;
+			}
+			const size_t windows = n - max_points, k = max_points + 1;
+			const size_t points = std::max(block, k);
+			executor.run((n + points - 1) / points, [&](const size_t task) {
+				const size_t begin = task * points, end = std::min(n, begin + points), length = end - begin + max_points;
+				std::vector<int8_t> prefix(length), suffix(length);
+				// Window j = begin - max_points + t, -1 where there is no window of max_points + 1 codes
+				for (size_t t = 0, r = 0; t < length; ++t, r = r + 1 == k ? 0 : r + 1) {
+					const size_t j = begin + t - max_points; // wraps around below 0
+					const int8_t w = begin + t >= max_points && j < windows ? static_cast<int8_t>(m3D_common_level<uint64_t>(codes[j], codes[j + max_points])) : int8_t(-1);
+					prefix[t] = r == 0 ? w : std::max(w, prefix[t - 1]);
+					suffix[t] = w;
+				}
+				// Suffix maxima restart at the last item of every span (r: position of t in its span)
+				for (size_t t = length - 1, r = (length - 1) % k; t-- > 0;) {
+					r = r == 0 ? k - 1 : r - 1;
+					if (r != k - 1) { suffix[t] = std::max(suffix[t], suffix[t + 1]); }
+				}
+				for (size_t i = begin; i < end; ++i) {
+					const int level = std::max(suffix[i - begin], prefix[i - begin + max_points]);
+					leaf[i] = static_cast<int8_t>(std::min(levels, level + 1));
+				}
+			});
+		}
+	}
+
+	// BUILD OCTREE : linear octree over n morton codes sorted in ascending order, with leaves of at most max_points
+	// points (max_points >= 1; more only in cells of the deepest level). Built on the threads of executor.
+	template<typename index = uint32_t>
+	inline morton_octree<index> morton_build_octree(const uint64_t* codes, const size_t n, const size_t max_points, morton_executor& executor = default_executor()) {
+		using namespace octree_detail;
+		morton_octree<index> tree;
+		tree.points.assign(1, static_cast<index>(n));
+		if (n == 0) { return tree; }
+		const size_t blocks = (n + block - 1) / block;
+
+		// Leaf level of every point, and the nodes starting in every block, then the position of the first one
+		std::unique_ptr<int8_t[]> leaf(new int8_t[n]);
+		leaf_levels(codes, n, max_points, leaf.get(), executor);
+		std::vector<size_t> offsets(blocks + 1, 0);
+		for_blocks(n, executor, [&](const size_t begin, const size_t end) {
+			size_t count = 0;
+			for (size_t i = begin; i < end; ++i) { count += static_cast<size_t>(std::max(0, leaf[i] - start_level(codes, i) + 1)); }
+			offsets[begin / block + 1] = count;
+		});
+		for (size_t b = 0; b < blocks; ++b) { offsets[b + 1] += offsets[b]; }
+		const size_t nodes = offsets[blocks];
+		tree.keys.resize(nodes);
+		tree.levels.resize(nodes);
+		tree.child_masks.resize(nodes);
+		tree.points.resize(nodes + 1);
+		tree.next.resize(nodes);
+		tree.points[nodes] = static_cast<index>(n);
+
+		// Nodes of every point, parents first; leaves end where the next node starts
+		for_blocks(n, executor, [&](const size_t begin, const size_t end) {
+			size_t node = offsets[begin / block];
+			for (size_t i = begin; i < end; ++i) {
+				for (int level = start_level(codes, i); level <= leaf[i]; ++level, ++node) {
+					tree.keys[node] = m3D_cell<uint64_t>(codes[i], static_cast<unsigned int>(level));
+					tree.levels[node] = static_cast<uint8_t>(level);
+					tree.child_masks[node] = level < leaf[i] ? 1 : 0;
+					tree.points[node] = static_cast<index>(i);
+					tree.next[node] = static_cast<index>(node + 1);
+				}
+			}
+		});
+
+		// Subtrees of the nodes with children end at the first node beyond their last code
+		for_blocks(nodes, executor, [&](const size_t begin, const size_t end) {
+			for (size_t node = begin; node < end; ++node) {
+				if (tree.child_masks[node] == 0) { continue; }
+				const uint64_t last = m3D_cell_last<uint64_t>(tree.keys[node], tree.levels[node]);
+				tree.next[node] = static_cast<index>(subtree_end(tree.keys.data(), nodes, node, last));
+			}
+		});
+		// Child masks, following the children from one subtree to the next
+		for_blocks(nodes, executor, [&](const size_t begin, const size_t end) {
+			for (size_t node = begin; node < end; ++node) {
+				if (tree.child_masks[node] == 0) { continue; }
+				const unsigned int child_level = tree.levels[node] + 1u;
+				uint8_t mask = 0;
+				for (size_t child = node + 1; child < tree.next[node]; child = tree.next[child]) {
+					mask = static_cast<uint8_t>(mask | (1u << m3D_child_index<uint64_t>(tree.keys[child], child_level)));
+				}
+				tree.child_masks[node] = mask;
+			}
+		});
+		return tree;
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+// Libmorton - Morton codes of signed integer and IEEE-754 float / double coordinates
+// Coordinates are first mapped to unsigned integers in the same order (the sign bit of integers is flipped, negative
+// floats have all their bits flipped and positive floats only their sign bit), then interleaved. Codes compare in
+// Z-order over the raw values: no offset or bounding box is needed, so the box queries and the radix sort work on
+// them as they are. -0.0 sorts just below +0.0, NaNs sort below -infinity (negative) or above +infinity (positive).
+//
+// Coordinates get 16 / 32 / 64 bits in 2D (32 / 64 / 128-bit codes) and 10 / 21 / 42 bits in 3D. Wider coordinates
+// keep only their highest bits, which keeps the order but makes nearby values share a cell: decoding returns the
+// smallest value of that cell (other than NaN). 32-bit floats fit 64-bit codes exactly in 2D, and 128-bit codes
+// in 3D (where the compiler has them, see morton_common.h).
+
+#include <stdint.h>
+#include <string.h>
+#include <limits>
+#include <type_traits>
+#include "morton.h"
+
+namespace libmorton {
+	namespace ordered_detail {
+		// Map T to unsigned integers of the same width, in the same order
+		template<typename T, typename enable = void> struct ordered;
+		template<typename T> struct ordered<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+			typedef typename std::make_unsigned<T>::type type;
+			static const type sign = std::is_signed<T>::value ? static_cast<type>(type(1) << (std::numeric_limits<type>::digits - 1)) : 0;
+			static type map(const T v) { return static_cast<type>(static_cast<type>(v) ^ sign); }
+			static T unmap(const type u) { return static_cast<T>(static_cast<type>(u ^ sign)); }
+		};
+		template<typename T> struct ordered<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+			static_assert(std::numeric_limits<T>::is_iec559 && (sizeof(T) == 4 || sizeof(T) == 8), "floating point coordinates must be IEEE-754 float or double");
+			typedef typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type type;
+			static const unsigned int top = std::numeric_limits<type>::digits - 1;
+			static type map(const T v) {
+				type b;
+				memcpy(&b, &v, sizeof(b));
+				return b ^ (static_cast<type>(type(0) - (b >> top)) | static_cast<type>(type(1) << top));
+			}
+			static T unmap(const type u) {
+				const type b = u ^ (static_cast<type>((u >> top) - 1) | static_cast<type>(type(1) << top));
+				T v;
+				memcpy(&v, &b, sizeof(v));
+				return v;
+			}
+		};
+
+		// The morton.h methods and their coordinate width, by code width and number of dimensions
+		template<typename morton, size_t dims> struct codec;
+		template<> struct codec<uint32_t, 2> {
+			static const unsigned int bits = 16;
+			static uint32_t encode(const uint64_t c[2]) { return static_cast<uint32_t>(morton2D_32_encode(static_cast<uint_fast16_t>(c[0]), static_cast<uint_fast16_t>(c[1]))); }
+			static void decode(const uint32_t m, uint64_t c[2]) { uint_fast16_t x, y; morton2D_32_decode(m, x, y); c[0] = x; c[1] = y; }
+		};
+		template<> struct codec<uint64_t, 2> {
+			static const unsigned int bits = 32;
+			static uint64_t encode(const uint64_t c[2]) { return static_cast<uint64_t>(morton2D_64_encode(static_cast<uint_fast32_t>(c[0]), static_cast<uint_fast32_t>(c[1]))); }
+			static void decode(const uint64_t m, uint64_t c[2]) { uint_fast32_t x, y; morton2D_64_decode(m, x, y); c[0] = x; c[1] = y; }
+		};
+		template<> struct codec<uint32_t, 3> {
+			static const unsigned int bits = 10;
+			static uint32_t encode(const uint64_t c[3]) { return static_cast<uint32_t>(morton3D_32_encode(static_cast<uint_fast16_t>(c[0]), static_cast<uint_fast16_t>(c[1]), static_cast<uint_fast16_t>(c[2]))); }
+			static void decode(const uint32_t m, uint64_t c[3]) { uint_fast16_t x, y, z; morton3D_32_decode(m, x, y, z); c[0] = x; c[1] = y; c[2] = z; }
+		};
+		template<> struct codec<uint64_t, 3> {
+			static const unsigned int bits = 21;
+			static uint64_t encode(const uint64_t c[3]) { return static_cast<uint64_t>(morton3D_64_encode(static_cast<uint_fast32_t>(c[0]), static_cast<uint_fast32_t>(c[1]), static_cast<uint_fast32_t>(c[2]))); }
+			static void decode(const uint64_t m, uint64_t c[3]) { uint_fast32_t x, y, z; morton3D_64_decode(m, x, y, z); c[0] = x; c[1] = y; c[2] = z; }
+		};
+#if LIBMORTON_HAS_UINT128
+		template<> struct codec<morton128_t, 2> {
+			static const unsigned int bits = 64;
+			static morton128_t encode(const uint64_t c[2]) { return morton2D_128_encode(c[0], c[1]); }
+			static void decode(const morton128_t m, uint64_t c[2]) { uint_fast64_t x, y; morton2D_128_decode(m, x, y); c[0] = x; c[1] = y; }
+		};
+		template<> struct codec<morton128_t, 3> {
+			static const unsigned int bits = 42;
+			static morton128_t encode(const uint64_t c[3]) { return morton3D_128_encode(c[0], c[1], c[2]); }
+			static void decode(const morton128_t m, uint64_t c[3]) { uint_fast64_t x, y, z; morton3D_128_decode(m, x, y, z); c[0] = x; c[1] = y; c[2] = z; }
+		};
+#endif
+
+		// Coordinate of the code for value v: its highest bits if it does not fit
+		template<typename morton, size_t dims, typename T>
+		inline uint64_t to_coord(const T v) {
+			typedef ordered<T> map;
+			const unsigned int width = std::numeric_limits<typename map::type>::digits;
+			const unsigned int shift = width > codec<morton, dims>::bits ? width - codec<morton, dims>::bits : 0;
+			return static_cast<uint64_t>(map::map(v)) >> shift;
+		}
+
+		// Smallest value with coordinate c: the NaNs below -infinity are skipped if the cell holds -infinity as well
+		template<typename morton, size_t dims, typename T>
+		inline T from_coord(const uint64_t c) {
+			typedef ordered<T> map;
+			typedef typename map::type type;
+			const unsigned int width = std::numeric_limits<type>::digits;
+			const unsigned int shift = width > codec<morton, dims>::bits ? width - codec<morton, dims>::bits : 0;
+			const type u = static_cast<type>(c << shift);
+			const type lowest = map::map(std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest());
+			const type last = static_cast<type>(u | static_cast<type>((type(1) << shift) - 1));
+			return map::unmap(u < lowest && last >= lowest ? lowest : u);
+		}
+	}
+
+	// ENCODE 2D morton code : signed integer / float / double coordinates, in their order
+	template<typename morton, typename T>
+	inline morton m2D_e_ordered(const T x, const T y) {
+		const uint64_t c[2] = { ordered_detail::to_coord<morton, 2, T>(x), ordered_detail::to_coord<morton, 2, T>(y) };
+		return ordered_detail::codec<morton, 2>::encode(c);
+	}
+
+	// ENCODE 3D morton code : signed integer / float / double coordinates, in their order
+	template<typename morton, typename T>
+	inline morton m3D_e_ordered(const T x, const T y, const T z) {
+		const uint64_t c[3] = { ordered_detail::to_coord<morton, 3, T>(x), ordered_detail::to_coord<morton, 3, T>(y), ordered_detail::to_coord<morton, 3, T>(z) };
+		return ordered_detail::codec<morton, 3>::encode(c);
+	}
+
+	// DECODE 2D morton code : signed integer / float / double coordinates, in their order
+	template<typename morton, typename T>
+	inline void m2D_d_ordered(const morton m, T& x, T& y) {
+		uint64_t c[2];
+		ordered_detail::codec<morton, 2>::decode(m, c);
+		x = ordered_detail::from_coord<morton, 2, T>(c[0]);
+		y = ordered_detail::from_coord<morton, 2, T>(c[1]);
+	}
+
+	// DECODE 3D morton code : signed integer / float / double coordinates, in their order
+	template<typename morton, typename T>
+	inline void m3D_d_ordered(const morton m, T& x, T& y, T& z) {
+		uint64_t c[3];
+		ordered_detail::codec<morton, 3>::decode(m, c);
+		x = ordered_detail::from_coord<morton, 3, T>(c[0]);
+		y = ordered_detail::from_coord<morton, 3, T>(c[1]);
+		z = ordered_detail::from_coord<morton, 3, T>(c[2]);
+	}
+}
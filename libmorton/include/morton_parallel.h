@@ -0,0 +1,200 @@
+#pragma once
+
+// Libmorton - Multithreaded batch methods
+// The input is split into chunks of a few thousand codes, which are handed out to the threads of an executor: a
+// persistent thread pool (morton_thread_pool) by default, or anything implementing morton_executor, such as a
+// wrapper around the task system of an application.
+//
+// The threads of a pool stay awake for a short while after every call, so calls in a loop do not pay for waking
+// them up. Calls with fewer than two chunks of codes run on the calling thread. The calling thread always takes
+// part in the work, and a call made from inside a task runs on the thread of that task.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "morton.h"
+
+namespace libmorton {
+	// Runs tasks in parallel
+	class morton_executor {
+	public:
+		virtual ~morton_executor() {}
+		// Number of tasks which can run at the same time
+		virtual unsigned int concurrency() const = 0;
+		// Call task(i) for every i < tasks, and return once they have all finished
+		virtual void run(size_t tasks, const std::function<void(size_t)>& task) = 0;
+	};
+
+	namespace parallel_detail {
+		// Whether the calling thread is running a task of a morton_thread_pool
+		inline bool& in_task() {
+			static thread_local bool flag = false;
+			return flag;
+		}
+	}
+
+	// A pool of threads which run the tasks of one call at a time, with the calling thread
+	class morton_thread_pool : public morton_executor {
+	public:
+		// threads: number of threads including the calling one (0: one per hardware thread)
+		explicit morton_thread_pool(unsigned int threads = 0) {
+			if (threads == 0) { threads = std::thread::hardware_concurrency(); }
+			for (unsigned int t = 1; t < threads; ++t) { workers_.emplace_back(&morton_thread_pool::work, this); }
+		}
+
+		~morton_thread_pool() {
+			{
+				std::lock_guard<std::mutex> guard(lock_);
+				stop_ = true;
+			}
+			wake_.notify_all();
+			for (size_t t = 0; t < workers_.size(); ++t) { workers_[t].join(); }
+		}
+
+		morton_thread_pool(const morton_thread_pool&) = delete;
+		morton_thread_pool& operator=(const morton_thread_pool&) = delete;
+
+		unsigned int concurrency() const override { return static_cast<unsigned int>(workers_.size() + 1); }
+
+		void run(size_t tasks, const std::function<void(size_t)>& task) override {
+			if (workers_.empty() || tasks < 2 || parallel_detail::in_task()) {
+				for (size_t i = 0; i < tasks; ++i) { task(i); }
+				return;
+			}
+			std::lock_guard<std::mutex> one_call(call_lock_);
+			{
+				std::lock_guard<std::mutex> guard(lock_);
+				task_ = &task;
+				tasks_ = tasks;
+				next_ = 0;
+				done_ = 0;
+				generation_.fetch_add(1, std::memory_order_release);
+			}
+			wake_.notify_all();
+			execute();
+			std::unique_lock<std::mutex> guard(lock_);
+			finished_.wait(guard, [this] { return done_ == tasks_ && active_ == 0; });
+			task_ = nullptr;
+		}
+
+	private:
+		// Time the workers keep polling for the next call before they go to sleep
+		static std::chrono::microseconds spin_time() { return std::chrono::microseconds(200); }
+
+		// Run tasks until there are none left
+		void execute() {
+			parallel_detail::in_task() = true;
+			for (size_t i = next_.fetch_add(1); i < tasks_; i = next_.fetch_add(1)) {
+				(*task_)(i);
+				done_.fetch_add(1);
+			}
+			parallel_detail::in_task() = false;
+		}
+
+		void work() {
+			uint64_t seen = 0;
+			while (true) {
+				const auto spin_end = std::chrono::steady_clock::now() + spin_time();
+				while (generation_.load(std::memory_order_acquire) == seen && std::chrono::steady_clock::now() < spin_end) { std::this_thread::yield(); }
+				{
+					std::unique_lock<std::mutex> guard(lock_);
+					wake_.wait(guard, [&] { return stop_ || generation_.load(std::memory_order_relaxed) != seen; });
+					if (stop_) { return; }
+					seen = generation_.load(std::memory_order_relaxed);
+					if (task_ == nullptr) { continue; }
+					++active_;
+				}
+				execute();
+				{
+					std::lock_guard<std::mutex> guard(lock_);
+					--active_;
+				}
+				finished_.notify_all();
+			}
+		}
+
+		std::vector<std::thread> workers_;
+		std::mutex call_lock_; // one call at a time
+		std::mutex lock_;
+		std::condition_variable wake_, finished_;
+		std::atomic<uint64_t> generation_{ 0 };
+		const std::function<void(size_t)>* task_ = nullptr;
+		size_t tasks_ = 0;
+		std::atomic<size_t> next_{ 0 }, done_{ 0 };
+		unsigned int active_ = 0; // workers running tasks of the current call
+		bool stop_ = false;
+	};
+
+	namespace parallel_detail {
+		// Codes per task: the coordinates and codes of a chunk fit in the L2 cache
+		static const size_t chunk = size_t(1) << 14;
+
+		inline std::atomic<morton_executor*>& default_executor() {
+			static std::atomic<morton_executor*> executor{ nullptr };
+			return executor;
+		}
+
+	}
+
+	// The executor of the parallel methods: a pool with one thread per hardware thread, created on first use, unless
+	// another one was set with set_default_executor
+	inline morton_executor& default_executor() {
+		morton_executor* executor = parallel_detail::default_executor().load();
+		if (executor != nullptr) { return *executor; }
+		static morton_thread_pool pool;
+		return pool;
+	}
+
+	// Set the executor of the parallel methods (nullptr: back to the default pool). Do this while no parallel method runs.
+	inline void set_default_executor(morton_executor* executor) {
+		parallel_detail::default_executor().store(executor);
+	}
+
+	// Call f(begin, end) on the threads of executor, for consecutive ranges of a few thousand codes covering [0, n)
+	template<typename function>
+	inline void morton_parallel_for(const size_t n, const function& f, morton_executor& executor = default_executor()) {
+		const size_t chunk = parallel_detail::chunk;
+		if (n < 2 * chunk || executor.concurrency() < 2) {
+			f(size_t(0), n);
+			return;
+		}
+		executor.run((n + chunk - 1) / chunk, [&](const size_t t) { f(t * chunk, std::min(n, (t + 1) * chunk)); });
+	}
+
+	// PARALLEL BATCH ENCODING
+	// Encode n coordinate tuples from separate x, y (and z) arrays into out, on the threads of executor
+	inline void morton2D_32_encode_batch_parallel(const uint16_t* x, const uint16_t* y, uint32_t* out, size_t n, morton_executor& executor = default_executor()) {
+		morton_parallel_for(n, [&](size_t b, size_t e) { morton2D_32_encode_batch(x + b, y + b, out + b, e - b); }, executor);
+	}
+	inline void morton2D_64_encode_batch_parallel(const uint32_t* x, const uint32_t* y, uint64_t* out, size_t n, morton_executor& executor = default_executor()) {
+		morton_parallel_for(n, [&](size_t b, size_t e) { morton2D_64_encode_batch(x + b, y + b, out + b, e - b); }, executor);
+	}
+	inline void morton3D_32_encode_batch_parallel(const uint16_t* x, const uint16_t* y, const uint16_t* z, uint32_t* out, size_t n, morton_executor& executor = default_executor()) {
+		morton_parallel_for(n, [&](size_t b, size_t e) { morton3D_32_encode_batch(x + b, y + b, z + b, out + b, e - b); }, executor);
+	}
+	inline void morton3D_64_encode_batch_parallel(const uint32_t* x, const uint32_t* y, const uint32_t* z, uint64_t* out, size_t n, morton_executor& executor = default_executor()) {
+		morton_parallel_for(n, [&](size_t b, size_t e) { morton3D_64_encode_batch(x + b, y + b, z + b, out + b, e - b); }, executor);
+	}
+
+	// PARALLEL BATCH DECODING
+	// Decode n morton codes into separate x, y (and z) arrays, on the threads of executor
+	inline void morton2D_32_decode_batch_parallel(const uint32_t* m, uint16_t* x, uint16_t* y, size_t n, morton_executor& executor = default_executor()) {
+		morton_parallel_for(n, [&](size_t b, size_t e) { morton2D_32_decode_batch(m + b, x + b, y + b, e - b); }, executor);
+	}
+	inline void morton2D_64_decode_batch_parallel(const uint64_t* m, uint32_t* x, uint32_t* y, size_t n, morton_executor& executor = default_executor()) {
+		morton_parallel_for(n, [&](size_t b, size_t e) { morton2D_64_decode_batch(m + b, x + b, y + b, e - b); }, executor);
+	}
+	inline void morton3D_32_decode_batch_parallel(const uint32_t* m, uint16_t* x, uint16_t* y, uint16_t* z, size_t n, morton_executor& executor = default_executor()) {
+		morton_parallel_for(n, [&](size_t b, size_t e) { morton3D_32_decode_batch(m + b, x + b, y + b, z + b, e - b); }, executor);
+	}
+	inline void morton3D_64_decode_batch_parallel(const uint64_t* m, uint32_t* x, uint32_t* y, uint32_t* z, size_t n, morton_executor& executor = default_executor()) {
+		morton_parallel_for(n, [&](size_t b, size_t e) { morton3D_64_decode_batch(m + b, x + b, y + b, z + b, e - b); }, executor);
+	}
+}
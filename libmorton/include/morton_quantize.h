@@ -0,0 +1,172 @@
+#pragma once
+
+// Libmorton - Methods to encode float / double positions in a bounding box, and to decode codes to positions
+// Every coordinate is scaled to the cells of the box (2^21 per axis for 3D 64-bit codes, 2^10 for 3D 32-bit codes,
+// 2^32 and 2^16 for 2D), rounded down and clamped to the box: positions on the upper faces of the box, or outside it,
+// go to the outer cells. NaN goes to cell 0. Decoding returns the center of the cell of the code.
+//
+// Positions are read from separate x, y (and z) arrays, or from one array of structures: position i at
+// p[i * stride], p[i * stride + 1] (and p[i * stride + 2]). They are quantized one block at a time into coordinates
+// which stay in cache, and encoded with the morton.h batch methods (so with AVX2 where the CPU supports it):
+// one pass over the positions and the codes.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <limits>
+#include <type_traits>
+#include "morton.h"
+
+namespace libmorton {
+	// Axis aligned bounding box
+	template<typename real, size_t dims>
+	struct morton_aabb {
+		real lo[dims];
+		real hi[dims];
+	};
+
+	namespace quantize_detail {
+		// Positions quantized / dequantized per block
+		static const size_t block = 256;
+
+		// The morton.h batch methods and their coordinate width, by code width and number of dimensions
+		template<typename morton, size_t dims> struct batch;
+		template<> struct batch<uint32_t, 2> {
+			typedef uint16_t coord;
+			static const unsigned int bits = 16;
+			static void encode(coord* const c[2], uint32_t* out, size_t n) { morton2D_32_encode_batch(c[0], c[1], out, n); }
+			static void decode(const uint32_t* m, coord* const c[2], size_t n) { morton2D_32_decode_batch(m, c[0], c[1], n); }
+		};
+		template<> struct batch<uint64_t, 2> {
+			typedef uint32_t coord;
+			static const unsigned int bits = 32;
+			static void encode(coord* const c[2], uint64_t* out, size_t n) { morton2D_64_encode_batch(c[0], c[1], out, n); }
+			static void decode(const uint64_t* m, coord* const c[2], size_t n) { morton2D_64_decode_batch(m, c[0], c[1], n); }
+		};
+		template<> struct batch<uint32_t, 3> {
+			typedef uint16_t coord;
+			static const unsigned int bits = 10;
+			static void encode(coord* const c[3], uint32_t* out, size_t n) { morton3D_32_encode_batch(c[0], c[1], c[2], out, n); }
+			static void decode(const uint32_t* m, coord* const c[3], size_t n) { morton3D_32_decode_batch(m, c[0], c[1], c[2], n); }
+		};
+		template<> struct batch<uint64_t, 3> {
+			typedef uint32_t coord;
+			static const unsigned int bits = 21;
+			static void encode(coord* const c[3], uint64_t* out, size_t n) { morton3D_64_encode_batch(c[0], c[1], c[2], out, n); }
+			static void decode(const uint64_t* m, coord* const c[3], size_t n) { morton3D_64_decode_batch(m, c[0], c[1], c[2], n); }
+		};
+
+		// Arithmetic type of the scaling: real, or double if real cannot hold every cell index exactly
+		template<typename real, unsigned int bits>
+		using calc = typename std::conditional<(bits >= std::numeric_limits<real>::digits), double, real>::type;
+
+		template<typename morton, size_t dims, typename real>
+		inline void quantize_encode(const real* const in[dims], const size_t stride, const morton_aabb<real, dims>& box, morton* out, const size_t n) {
+			typedef batch<morton, dims> methods;
+			typedef typename methods::coord coord;
+			typedef calc<real, methods::bits> calc_t;
+			const calc_t cells = static_cast<calc_t>(uint64_t(1) << methods::bits);
+			const calc_t top = cells - 1;
+			calc_t lo[dims], scale[dims];
+			for (size_t d = 0; d < dims; ++d) {
+				lo[d] = static_cast<calc_t>(box.lo[d]);
+				scale[d] = box.hi[d] > box.lo[d] ? cells / (static_cast<calc_t>(box.hi[d]) - lo[d]) : 0;
+			}
+			coord c[dims][block];
+			coord* cp[dims];
+			for (size_t d = 0; d < dims; ++d) { cp[d] = c[d]; }
+			for (size_t begin = 0; begin < n; begin += block) {
+				const size_t count = n - begin < block ? n - begin : block;
+				for (size_t d = 0; d < dims; ++d) {
+					const real* p = in[d] + begin * stride;
+					for (size_t i = 0; i < count; ++i) {
+						const calc_t v = (static_cast<calc_t>(p[i * stride]) - lo[d]) * scale[d];
+						c[d][i] = static_cast<coord>(v > 0 ? (v < top ? v : top) : 0);
+					}
+				}
+				methods::encode(cp, out + begin, count);
+			}
+		}
+
+		template<typename morton, size_t dims, typename real>
+		inline void decode_dequantize(const morton* m, const morton_aabb<real, dims>& box, real* const out[dims], const size_t stride, const size_t n) {
+			typedef batch<morton, dims> methods;
+			typedef typename methods::coord coord;
+			typedef calc<real, methods::bits> calc_t;
+			const calc_t cells = static_cast<calc_t>(uint64_t(1) << methods::bits);
+			calc_t lo[dims], width[dims];
+			for (size_t d = 0; d < dims; ++d) {
+				width[d] = (static_cast<calc_t>(box.hi[d]) - static_cast<calc_t>(box.lo[d])) / cells;
+				lo[d] = static_cast<calc_t>(box.lo[d]) + width[d] / 2;
+			}
+			coord c[dims][block];
+			coord* cp[dims];
+			for (size_t d = 0; d < dims; ++d) { cp[d] = c[d]; }
+			for (size_t begin = 0; begin < n; begin += block) {
+				const size_t count = n - begin < block ? n - begin : block;
+				methods::decode(m + begin, cp, count);
+				for (size_t d = 0; d < dims; ++d) {
+					real* p = out[d] + begin * stride;
+					for (size_t i = 0; i < count; ++i) {
+						p[i * stride] = static_cast<real>(lo[d] + static_cast<calc_t>(c[d][i]) * width[d]);
+					}
+				}
+			}
+		}
+	}
+
+	// QUANTIZE AND ENCODE 2D positions (batch) : separate x and y arrays
+	template<typename morton, typename real>
+	inline void m2D_quantize_encode(const real* x, const real* y, const morton_aabb<real, 2>& box, morton* out, const size_t n) {
+		const real* const in[2] = { x, y };
+		quantize_detail::quantize_encode<morton, 2, real>(in, 1, box, out, n);
+	}
+
+	// QUANTIZE AND ENCODE 2D positions (batch) : position i at p[i * stride], p[i * stride + 1]
+	template<typename morton, typename real>
+	inline void m2D_quantize_encode(const real* p, const size_t stride, const morton_aabb<real, 2>& box, morton* out, const size_t n) {
+		const real* const in[2] = { p, p + 1 };
+		quantize_detail::quantize_encode<morton, 2, real>(in, stride, box, out, n);
+	}
+
+	// QUANTIZE AND ENCODE 3D positions (batch) : separate x, y and z arrays
+	template<typename morton, typename real>
+	inline void m3D_quantize_encode(const real* x, const real* y, const real* z, const morton_aabb<real, 3>& box, morton* out, const size_t n) {
+		const real* const in[3] = { x, y, z };
+		quantize_detail::quantize_encode<morton, 3, real>(in, 1, box, out, n);
+	}
+
+	// QUANTIZE AND ENCODE 3D positions (batch) : position i at p[i * stride], p[i * stride + 1], p[i * stride + 2]
+	template<typename morton, typename real>
+	inline void m3D_quantize_encode(const real* p, const size_t stride, const morton_aabb<real, 3>& box, morton* out, const size_t n) {
+		const real* const in[3] = { p, p + 1, p + 2 };
+		quantize_detail::quantize_encode<morton, 3, real>(in, stride, box, out, n);
+	}
+
+	// DECODE 2D morton codes to cell centers (batch) : separate x and y arrays
+	template<typename morton, typename real>
+	inline void m2D_decode_dequantize(const morton* m, const morton_aabb<real, 2>& box, real* x, real* y, const size_t n) {
+		real* const out[2] = { x, y };
+		quantize_detail::decode_dequantize<morton, 2, real>(m, box, out, 1, n);
+	}
+
+	// DECODE 2D morton codes to cell centers (batch) : position i at p[i * stride], p[i * stride + 1]
+	template<typename morton, typename real>
+	inline void m2D_decode_dequantize(const morton* m, const morton_aabb<real, 2>& box, real* p, const size_t stride, const size_t n) {
+		real* const out[2] = { p, p + 1 };
+		quantize_detail::decode_dequantize<morton, 2, real>(m, box, out, stride, n);
+	}
+
+	// DECODE 3D morton codes to cell centers (batch) : separate x, y and z arrays
+	template<typename morton, typename real>
+	inline void m3D_decode_dequantize(const morton* m, const morton_aabb<real, 3>& box, real* x, real* y, real* z, const size_t n) {
+		real* const out[3] = { x, y, z };
+		quantize_detail::decode_dequantize<morton, 3, real>(m, box, out, 1, n);
+	}
+
+	// DECODE 3D morton codes to cell centers (batch) : position i at p[i * stride], p[i * stride + 1], p[i * stride + 2]
+	template<typename morton, typename real>
+	inline void m3D_decode_dequantize(const morton* m, const morton_aabb<real, 3>& box, real* p, const size_t stride, const size_t n) {
+		real* const out[3] = { p, p + 1, p + 2 };
+		quantize_detail::decode_dequantize<morton, 3, real>(m, box, out, stride, n);
+	}
+}
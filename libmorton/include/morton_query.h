@@ -0,0 +1,316 @@
+#pragma once
+
+// Libmorton - Box queries on sorted arrays of morton codes
+// All morton codes of the points inside a box lie between the codes of its min and max corners, but so do many
+// codes outside the box. BIGMIN is the smallest code inside the box that is larger than a given code (LITMAX the
+// largest code inside the box smaller than it), computed without decoding (Tropf and Herzog, 1981). A box query
+// walks the sorted array, and on every code outside the box jumps ahead to BIGMIN with a galloping search, so it
+// touches about as many codes as it returns.
+//
+// Boxes are given by the morton codes of their min and max corners (coordinate by coordinate min <= max).
+//
+// For sorted storage (databases, key-value stores) a box can also be turned into the list of contiguous ranges of
+// morton codes which cover it, to be read with a few sequential range scans.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "morton_common.h"
+#include "morton_dilated.h"
+
+namespace libmorton {
+	namespace query_detail {
+		// Bits of the coordinate holding bit b, from bit b down
+		template<typename morton, unsigned int dims>
+		inline morton lane_below(const unsigned int b) {
+			const morton below = static_cast<morton>((static_cast<morton>(1) << b) | ((static_cast<morton>(1) << b) - 1));
+			return static_cast<morton>(dilated_detail::lane<morton, dims>(b % dims) & below);
+		}
+
+		// Set bit b and clear the lower bits of its coordinate ("1000...")
+		template<typename morton, unsigned int dims>
+		inline morton load_1000(const morton m, const unsigned int b) {
+			return static_cast<morton>((m & static_cast<morton>(~lane_below<morton, dims>(b))) | (static_cast<morton>(1) << b));
+		}
+
+		// Clear bit b and set the lower bits of its coordinate ("0111...")
+		template<typename morton, unsigned int dims>
+		inline morton load_0111(const morton m, const unsigned int b) {
+			return static_cast<morton>((m | lane_below<morton, dims>(b)) & static_cast<morton>(~(static_cast<morton>(1) << b)));
+		}
+
+		// Highest bit where code, min_code and max_code are not all equal (bits above it decide nothing)
+		template<typename morton>
+		inline int first_bit(const morton code, const morton min_code, const morton max_code) {
+			const morton differ = static_cast<morton>((code ^ min_code) | (code ^ max_code));
+			unsigned long b = 0;
+			return findFirstSetBitZeroIdx(differ, &b) ? static_cast<int>(b) : -1;
+		}
+
+		template<typename morton, unsigned int dims>
+		inline morton bigmin(const morton code, morton min_code, morton max_code) {
+			morton result = max_code;
+			for (int b = first_bit<morton>(code, min_code, max_code); b >= 0; --b) {
+				const morton bit = static_cast<morton>(1) << b;
+				switch (((code & bit) ? 4 : 0) | ((min_code & bit) ? 2 : 0) | ((max_code & bit) ? 1 : 0)) {
+				case 1: // 001: the box straddles code in this coordinate, BIGMIN is in its upper half
+					result = load_1000<morton, dims>(min_code, static_cast<unsigned int>(b));
+					max_code = load_0111<morton, dims>(max_code, static_cast<unsigned int>(b));
+					break;
+				case 3: // 011: the whole box is above code
+					return min_code;
+				case 4: // 100: the whole box is below code
+					return result;
+				case 5: // 101: code is in the upper half of the box
+					min_code = load_1000<morton, dims>(min_code, static_cast<unsigned int>(b));
+					break;
+				default: break;
+				}
+			}
+			return result;
+		}
+
+		template<typename morton, unsigned int dims>
+		inline morton litmax(const morton code, morton min_code, morton max_code) {
+			morton result = min_code;
+			for (int b = first_bit<morton>(code, min_code, max_code); b >= 0; --b) {
+				const morton bit = static_cast<morton>(1) << b;
+				switch (((code & bit) ? 4 : 0) | ((min_code & bit) ? 2 : 0) | ((max_code & bit) ? 1 : 0)) {
+				case 1: // 001: code is in the lower half of the box
+					max_code = load_0111<morton, dims>(max_code, static_cast<unsigned int>(b));
+					break;
+				case 3: // 011: the whole box is above code
+					return result;
+				case 4: // 100: the whole box is below code
+					return max_code;
+				case 5: // 101: the box straddles code in this coordinate, LITMAX is in its lower half
+					result = load_0111<morton, dims>(max_code, static_cast<unsigned int>(b));
+					min_code = load_1000<morton, dims>(min_code, static_cast<unsigned int>(b));
+					break;
+				default: break;
+				}
+			}
+			return result;
+		}
+
+		template<typename morton, unsigned int dims>
+		inline bool in_box(const morton code, const morton min_code, const morton max_code) {
+			for (unsigned int axis = 0; axis < dims; ++axis) {
+				const morton lane = dilated_detail::lane<morton, dims>(axis);
+				if ((code & lane) < (min_code & lane) || (code & lane) > (max_code & lane)) { return false; }
+			}
+			return true;
+		}
+
+		// First index in [begin, n) with codes[index] >= value: doubling steps, then a binary search
+		template<typename morton>
+		inline size_t gallop(const morton* codes, size_t begin, const size_t n, const morton value) {
+			size_t step = 1;
+			size_t end = begin;
+			while (end < n && codes[end] < value) {
+				begin = end + 1;
+				end += step;
+				step *= 2;
+			}
+			if (end > n) { end = n; }
+			while (begin < end) {
+				const size_t mid = begin + (end - begin) / 2;
+				if (codes[mid] < value) { begin = mid + 1; }
+				else { end = mid; }
+			}
+			return begin;
+		}
+
+		template<typename morton, unsigned int dims, typename visitor>
+		inline size_t box_query(const morton* codes, const size_t n, const morton min_code, const morton max_code, visitor&& visit) {
+			size_t found = 0;
+			size_t i = gallop<morton>(codes, 0, n, min_code);
+			while (i < n && codes[i] <= max_code) {
+				if (in_box<morton, dims>(codes[i], min_code, max_code)) {
+					visit(i);
+					++found;
+					++i;
+				}
+				else {
+					i = gallop<morton>(codes, i + 1, n, bigmin<morton, dims>(codes[i], min_code, max_code));
+				}
+			}
+			return found;
+		}
+	}
+
+	// BIGMIN / LITMAX 2D : smallest (largest) morton code inside the box which is larger (smaller) than code
+	// code must lie between min_code and max_code, outside the box
+	template<typename morton> inline morton m2D_bigmin(const morton code, const morton min_code, const morton max_code) { return query_detail::bigmin<morton, 2>(code, min_code, max_code); }
+	template<typename morton> inline morton m2D_litmax(const morton code, const morton min_code, const morton max_code) { return query_detail::litmax<morton, 2>(code, min_code, max_code); }
+	// Whether code lies inside the box, without decoding it
+	template<typename morton> inline bool m2D_in_box(const morton code, const morton min_code, const morton max_code) { return query_detail::in_box<morton, 2>(code, min_code, max_code); }
+
+	// BIGMIN / LITMAX 3D : smallest (largest) morton code inside the box which is larger (smaller) than code
+	// code must lie between min_code and max_code, outside the box
+	template<typename morton> inline morton m3D_bigmin(const morton code, const morton min_code, const morton max_code) { return query_detail::bigmin<morton, 3>(code, min_code, max_code); }
+	template<typename morton> inline morton m3D_litmax(const morton code, const morton min_code, const morton max_code) { return query_detail::litmax<morton, 3>(code, min_code, max_code); }
+	// Whether code lies inside the box, without decoding it
+	template<typename morton> inline bool m3D_in_box(const morton code, const morton min_code, const morton max_code) { return query_detail::in_box<morton, 3>(code, min_code, max_code); }
+
+	// BOX QUERY on n sorted morton codes : calls visit(i) for every index i (in increasing order) with codes[i] in the box
+	// Returns the number of codes found.
+	template<typename morton, typename visitor>
+	inline size_t m2D_box_query(const morton* codes, const size_t n, const morton min_code, const morton max_code, visitor&& visit) {
+		return query_detail::box_query<morton, 2>(codes, n, min_code, max_code, visit);
+	}
+	template<typename morton, typename visitor>
+	inline size_t m3D_box_query(const morton* codes, const size_t n, const morton min_code, const morton max_code, visitor&& visit) {
+		return query_detail::box_query<morton, 3>(codes, n, min_code, max_code, visit);
+	}
+
+	// Range of morton codes, lo and hi included
+	template<typename morton>
+	struct morton_range {
+		morton lo;
+		morton hi;
+	};
+
+	namespace query_detail {
+		// Cube of side 2^level at corner, in the morton code order of its children (bit axis of the child index picks the upper half of that axis)
+		template<unsigned int dims>
+		struct cube {
+			uint64_t corner[dims];
+
+			cube child(const unsigned int level, const unsigned int index) const {
+				cube c;
+				for (unsigned int axis = 0; axis < dims; ++axis) {
+					c.corner[axis] = corner[axis] + (((index >> axis) & 1) ? (uint64_t(1) << (level - 1)) : 0);
+				}
+				return c;
+			}
+		};
+
+		enum class overlap { none, inside, partial };
+
+		template<unsigned int dims>
+		inline overlap cube_overlap(const cube<dims>& c, const unsigned int level, const uint64_t lo[dims], const uint64_t hi[dims]) {
+			const uint64_t last = (level == 64) ? ~uint64_t(0) : (uint64_t(1) << level) - 1;
+			bool inside = true;
+			for (unsigned int axis = 0; axis < dims; ++axis) {
+				if (c.corner[axis] > hi[axis] || c.corner[axis] + last < lo[axis]) { return overlap::none; }
+				inside &= c.corner[axis] >= lo[axis] && c.corner[axis] + last <= hi[axis];
+			}
+			return inside ? overlap::inside : overlap::partial;
+		}
+
+		// Append the codes of a cube to ranges, extending the last range if they follow it
+		template<typename morton, unsigned int dims>
+		inline void append_cube(const cube<dims>& c, const unsigned int level, std::vector<morton_range<morton> >& ranges) {
+			morton code = 0;
+			for (unsigned int axis = 0; axis < dims; ++axis) {
+				code |= static_cast<morton>(magicbits_detail::split_bits<morton, dims>(static_cast<morton>(c.corner[axis])) << axis);
+			}
+			const unsigned int code_bits = dims * level;
+			const morton code_last = (code_bits >= sizeof(morton) * 8) ? static_cast<morton>(~morton(0)) : static_cast<morton>((morton(1) << code_bits) - 1);
+			if (!ranges.empty() && static_cast<morton>(ranges.back().hi + 1) == code) { ranges.back().hi = static_cast<morton>(code + code_last); }
+			else { ranges.push_back(morton_range<morton>{ code, static_cast<morton>(code + code_last) }); }
+		}
+
+		// Exact cover: depth first, in morton code order
+		template<typename morton, unsigned int dims>
+		inline void exact_ranges(const cube<dims>& c, const unsigned int level, const uint64_t lo[dims], const uint64_t hi[dims], std::vector<morton_range<morton> >& ranges) {
+			switch (cube_overlap<dims>(c, level, lo, hi)) {
+			case overlap::none: return;
+			case overlap::inside: append_cube<morton, dims>(c, level, ranges); return;
+			case overlap::partial:
+				for (unsigned int child = 0; child < (1u << dims); ++child) {
+					exact_ranges<morton, dims>(c.child(level, child), level - 1, lo, hi, ranges);
+				}
+			}
+		}
+
+		// Merge the ranges separated by the smallest gaps, until there are at most max_ranges left
+		template<typename morton>
+		inline void merge_ranges(std::vector<morton_range<morton> >& ranges, const size_t max_ranges) {
+			if (max_ranges == 0 || ranges.size() <= max_ranges) { return; }
+			std::vector<morton> gaps(ranges.size() - 1);
+			for (size_t i = 0; i + 1 < ranges.size(); ++i) { gaps[i] = static_cast<morton>(ranges[i + 1].lo - ranges[i].hi); }
+			// Keep the max_ranges - 1 largest gaps (and, of equal gaps, the first ones)
+			std::vector<morton> sorted_gaps(gaps);
+			const size_t keep = max_ranges - 1;
+			std::nth_element(sorted_gaps.begin(), sorted_gaps.end() - 1 - keep, sorted_gaps.end());
+			const morton threshold = *(sorted_gaps.end() - 1 - keep);
+			size_t above = 0;
+			for (size_t i = 0; i < gaps.size(); ++i) { above += gaps[i] > threshold; }
+			size_t equal_kept = keep - above;
+			size_t out = 0;
+			for (size_t i = 1; i < ranges.size(); ++i) {
+				const morton gap = gaps[i - 1];
+				if (gap > threshold || (gap == threshold && equal_kept > 0)) {
+					if (gap == threshold) { --equal_kept; }
+					ranges[++out] = ranges[i];
+				}
+				else { ranges[out].hi = ranges[i].hi; }
+			}
+			ranges.resize(out + 1);
+		}
+
+		// Approximate cover: breadth first, until more than max_ranges * 2^dims cubes straddle the box. Those are
+		// covered whole, after which the ranges separated by the smallest gaps are merged.
+		template<typename morton, unsigned int dims>
+		inline void capped_ranges(const uint64_t lo[dims], const uint64_t hi[dims], std::vector<morton_range<morton> >& ranges, const size_t max_ranges) {
+			std::vector<cube<dims> > partial(1, cube<dims>{}), next;
+			unsigned int level = magicbits_detail::coord_bits<morton, dims>();
+			if (cube_overlap<dims>(partial[0], level, lo, hi) != overlap::partial) { partial.clear(); }
+			for (; !partial.empty(); --level) {
+				if (partial.size() > (max_ranges << dims)) {
+					for (size_t i = 0; i < partial.size(); ++i) { append_cube<morton, dims>(partial[i], level, ranges); }
+					break;
+				}
+				next.clear();
+				for (size_t i = 0; i < partial.size(); ++i) {
+					for (unsigned int child = 0; child < (1u << dims); ++child) {
+						const cube<dims> c = partial[i].child(level, child);
+						switch (cube_overlap<dims>(c, level - 1, lo, hi)) {
+						case overlap::none: break;
+						case overlap::inside: append_cube<morton, dims>(c, level - 1, ranges); break;
+						case overlap::partial: next.push_back(c); break;
+						}
+					}
+				}
+				partial.swap(next);
+			}
+			// Cubes were appended level by level: sort them, and join the ones which follow each other
+			std::sort(ranges.begin(), ranges.end(), [](const morton_range<morton>& a, const morton_range<morton>& b) { return a.lo < b.lo; });
+			size_t out = 0;
+			for (size_t i = 1; i < ranges.size(); ++i) {
+				if (static_cast<morton>(ranges[out].hi + 1) == ranges[i].lo) { ranges[out].hi = ranges[i].hi; }
+				else { ranges[++out] = ranges[i]; }
+			}
+			if (!ranges.empty()) { ranges.resize(out + 1); }
+			merge_ranges<morton>(ranges, max_ranges);
+		}
+		template<typename morton, unsigned int dims>
+		inline void box_ranges(const uint64_t lo[dims], const uint64_t hi[dims], std::vector<morton_range<morton> >& ranges, const size_t max_ranges) {
+			ranges.clear();
+			if (max_ranges == 0) { exact_ranges<morton, dims>(cube<dims>{}, magicbits_detail::coord_bits<morton, dims>(), lo, hi, ranges); }
+			else { capped_ranges<morton, dims>(lo, hi, ranges, max_ranges); }
+		}
+	}
+
+	// BOX TO RANGES 2D : the sorted, disjoint ranges of morton codes which cover the box [x0, x1] x [y0, y1] exactly
+	// Their number grows with the surface of the box. With max_ranges > 0, there are at most max_ranges ranges,
+	// which may also cover cells outside the box.
+	template<typename morton, typename coord>
+	inline void m2D_box_ranges(const coord x0, const coord y0, const coord x1, const coord y1, std::vector<morton_range<morton> >& ranges, const size_t max_ranges = 0) {
+		const uint64_t lo[2] = { x0, y0 };
+		const uint64_t hi[2] = { x1, y1 };
+		query_detail::box_ranges<morton, 2>(lo, hi, ranges, max_ranges);
+	}
+
+	// BOX TO RANGES 3D : the sorted, disjoint ranges of morton codes which cover the box [x0, x1] x [y0, y1] x [z0, z1] exactly
+	// With max_ranges > 0, there are at most max_ranges ranges, which may also cover cells outside the box.
+	template<typename morton, typename coord>
+	inline void m3D_box_ranges(const coord x0, const coord y0, const coord z0, const coord x1, const coord y1, const coord z1, std::vector<morton_range<morton> >& ranges, const size_t max_ranges = 0) {
+		const uint64_t lo[3] = { x0, y0, z0 };
+		const uint64_t hi[3] = { x1, y1, z1 };
+		query_detail::box_ranges<morton, 3>(lo, hi, ranges, max_ranges);
+	}
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+// Libmorton - Radix sort for morton codes
+// Sorts uint32_t / uint64_t morton codes (least significant digit first, 8-bit digits), optionally together with a
+// permutation: perm[i] is the position in the input of the code which ends up at position i, so attribute arrays
+// can be gathered afterwards (see morton_gather).
+//
+// Digits which are the same in every code are skipped. Spatially clustered data shares its high digits, and
+// 3D codes never use their top bits, so this often saves several passes over the data.
+// Large inputs are sorted on several threads of an executor (the default one unless given, see morton_parallel.h):
+// every thread counts and scatters its own slice of the input.
+// The sort is stable and needs a buffer as large as the input (and one as large as the permutation).
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include "morton_parallel.h"
+
+namespace libmorton {
+	namespace sort_detail {
+		static const unsigned int digit_bits = 8;
+		static const size_t buckets = size_t(1) << digit_bits;
+		// Smallest slice of the input worth a thread of its own
+		static const size_t min_slice = size_t(1) << 16;
+		// Codes buffered per bucket while scattering
+		static const unsigned int buffered = 16;
+
+		// Threads to use for n codes: threads, or the concurrency of executor if 0, but at least min_slice codes each
+		inline unsigned int thread_count(const size_t n, unsigned int threads, morton_executor& executor) {
+			if (threads == 0) { threads = executor.concurrency(); }
+			const size_t useful = std::max<size_t>(1, n / min_slice);
+			return static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(threads, useful)));
+		}
+
+		// Call f(t) for every slice t < threads, on the threads of executor
+		template<typename function>
+		inline void run_threads(const unsigned int threads, morton_executor& executor, const function& f) {
+			if (threads == 1) {
+				f(0);
+				return;
+			}
+			executor.run(threads, [&](const size_t t) { f(static_cast<unsigned int>(t)); });
+		}
+
+		// Scatter src[begin .. end-1] (and its permutation) to the buckets of one digit, starting at offsets
+		// Codes are gathered in a small buffer per bucket and written out a buffer at a time: writing to 256 places
+		// at once thrashes the cache, worst of all when the buckets are the same power of two size apart.
+		template<typename morton, typename index>
+		inline void scatter(const morton* src, const index* perm_src, const size_t begin, const size_t end, const unsigned int shift, size_t* offsets, morton* dst, index* perm_dst) {
+			std::vector<morton> key_buffer(buckets * buffered);
+			std::vector<index> perm_buffer(perm_src != nullptr ? buckets * buffered : 0);
+			unsigned int fill[buckets] = {};
+			for (size_t i = begin; i < end; ++i) {
+				const size_t b = (src[i] >> shift) & (buckets - 1);
+				key_buffer[b * buffered + fill[b]] = src[i];
+				if (perm_src != nullptr) { perm_buffer[b * buffered + fill[b]] = perm_src[i]; }
+				if (++fill[b] == buffered) {
+					std::copy_n(&key_buffer[b * buffered], buffered, dst + offsets[b]);
+					if (perm_src != nullptr) { std::copy_n(&perm_buffer[b * buffered], buffered, perm_dst + offsets[b]); }
+					offsets[b] += buffered;
+					fill[b] = 0;
+				}
+			}
+			for (size_t b = 0; b < buckets; ++b) {
+				std::copy_n(&key_buffer[b * buffered], fill[b], dst + offsets[b]);
+				if (perm_src != nullptr) { std::copy_n(&perm_buffer[b * buffered], fill[b], perm_dst + offsets[b]); }
+			}
+		}
+
+		template<typename morton, typename index>
+		inline void radix_sort(morton* keys, index* perm, const size_t n, unsigned int threads, morton_executor& executor) {
+			static_assert(std::is_unsigned<morton>::value, "morton codes must be unsigned integers");
+			const unsigned int digits = sizeof(morton) * 8 / digit_bits;
+			if (perm != nullptr) {
+				for (size_t i = 0; i < n; ++i) { perm[i] = static_cast<index>(i); }
+			}
+			if (n < 2) { return; }
+			threads = thread_count(n, threads, executor);
+			const auto slice_begin = [n, threads](const unsigned int t) { return n / threads * t + std::min<size_t>(t, n % threads); };
+
+			// Count the digits of every slice, and find the bits which differ between codes
+			std::vector<size_t> counts(threads * digits * buckets);
+			std::vector<morton> all_and(threads, static_cast<morton>(~morton(0))), all_or(threads, 0);
+			run_threads(threads, executor, [&](const unsigned int t) {
+				size_t* c = &counts[t * digits * buckets];
+				morton a = static_cast<morton>(~morton(0)), o = 0;
+				for (size_t i = slice_begin(t); i < slice_begin(t + 1); ++i) {
+					const morton k = keys[i];
+					a &= k;
+					o |= k;
+					for (unsigned int d = 0; d < digits; ++d) { ++c[d * buckets + ((k >> (d * digit_bits)) & (buckets - 1))]; }
+				}
+				all_and[t] = a;
+				all_or[t] = o;
+			});
+			morton common_bits = static_cast<morton>(~morton(0)), any_bits = 0;
+			for (unsigned int t = 0; t < threads; ++t) {
+				common_bits &= all_and[t];
+				any_bits |= all_or[t];
+			}
+			const morton differ = static_cast<morton>(common_bits ^ any_bits);
+
+			std::vector<morton> key_buffer;
+			std::vector<index> perm_buffer;
+			morton* src = keys;
+			morton* dst = nullptr;
+			index* perm_src = perm;
+			index* perm_dst = nullptr;
+			bool first_pass = true;
+			for (unsigned int d = 0; d < digits; ++d) {
+				const unsigned int shift = d * digit_bits;
+				if (((differ >> shift) & (buckets - 1)) == 0) { continue; }
+				if (dst == nullptr) {
+					key_buffer.resize(n);
+					dst = key_buffer.data();
+					if (perm != nullptr) {
+						perm_buffer.resize(n);
+						perm_dst = perm_buffer.data();
+					}
+				}
+				// Counts of this digit per slice: the first counts hold while the slices hold the input, or if there is
+				// only one slice (the counts of the whole input do not depend on the order of the codes)
+				std::vector<size_t> offsets(threads * buckets);
+				if (first_pass || threads == 1) {
+					for (unsigned int t = 0; t < threads; ++t) {
+						std::copy_n(&counts[(t * digits + d) * buckets], buckets, &offsets[t * buckets]);
+					}
+				}
+				else {
+					run_threads(threads, executor, [&](const unsigned int t) {
+						size_t* c = &offsets[t * buckets];
+						for (size_t i = slice_begin(t); i < slice_begin(t + 1); ++i) { ++c[(src[i] >> shift) & (buckets - 1)]; }
+					});
+				}
+				// Every slice scatters to its own part of every bucket
+				size_t sum = 0;
+				for (size_t b = 0; b < buckets; ++b) {
+					for (unsigned int t = 0; t < threads; ++t) {
+						const size_t c = offsets[t * buckets + b];
+						offsets[t * buckets + b] = sum;
+						sum += c;
+					}
+				}
+				run_threads(threads, executor, [&](const unsigned int t) {
+					scatter<morton, index>(src, perm_src, slice_begin(t), slice_begin(t + 1), shift, &offsets[t * buckets], dst, perm_dst);
+				});
+				std::swap(src, dst);
+				std::swap(perm_src, perm_dst);
+				first_pass = false;
+			}
+			if (src != keys) {
+				std::copy_n(src, n, keys);
+				if (perm != nullptr) { std::copy_n(perm_src, n, perm); }
+			}
+		}
+	}
+
+	// SORT n morton codes in place
+	// threads: number of slices to sort in parallel on large inputs (0: the concurrency of the executor), on the
+	// threads of executor
+	template<typename morton>
+	inline void morton_sort(morton* keys, const size_t n, const unsigned int threads = 0, morton_executor& executor = default_executor()) {
+		sort_detail::radix_sort<morton, uint32_t>(keys, nullptr, n, threads, executor);
+	}
+
+	// SORT n morton codes in place, and return the permutation: the code at position i came from position perm[i]
+	template<typename morton, typename index>
+	inline void morton_sort(morton* keys, index* perm, const size_t n, const unsigned int threads = 0, morton_executor& executor = default_executor()) {
+		sort_detail::radix_sort<morton, index>(keys, perm, n, threads, executor);
+	}
+
+	// GATHER an attribute array in sorted order: out[i] = in[perm[i]]
+	template<typename T, typename index>
+	inline void morton_gather(const T* in, const index* perm, T* out, const size_t n) {
+		for (size_t i = 0; i < n; ++i) { out[i] = in[perm[i]]; }
+	}
+}
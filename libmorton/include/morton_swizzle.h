@@ -0,0 +1,196 @@
+#pragma once
+
+// Libmorton - Conversion of row-major images to Z-order (swizzled) layout and back
+// In the swizzled layout, pixel (x, y) is element morton2D_64_encode(x, y). Images are converted a micro-tile at a
+// time: tiles of 8 x 8 pixels (16 x 16 for 1-byte pixels), which are contiguous in the swizzled layout. A tile is
+// read into a small buffer in Z-order and written out in one go, so no pixel is encoded or scattered on its own. The
+// lowest level of Z-order is a 2 x 2 quad, so tiles are read two pixels of a row at a time, following a precomputed
+// table of quads. The reverse direction gathers the rows of a few tiles, so that every row written out fills a cache
+// line.
+//
+// On x86-64, large images are written with streaming stores, which do not pull the destination into the cache.
+// This needs a destination aligned to 16 bytes (and a pitch which is a multiple of 16 bytes, for row-major
+// destinations); other images use regular stores.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "morton.h"
+#include "morton_constexpr_LUTs.h"
+#if LIBMORTON_X86_DISPATCH
+#include <emmintrin.h>
+#endif
+
+namespace libmorton {
+	namespace swizzle_detail {
+		// Images of at least this many bytes are written with streaming stores
+		static const size_t stream_bytes = size_t(1) << 22;
+
+		template<size_t size>
+		struct pixel {
+			unsigned char bytes[size];
+		};
+
+		// Side of the tiles: rows of at least 16 bytes, tiles of at least 64 bytes (a cache line)
+		template<size_t size>
+		constexpr uint32_t tile() { return size == 1 ? 16 : 8; }
+
+		// Pixels of a row written at once when unswizzling: whole tiles, and at least a cache line
+		template<size_t size>
+		constexpr uint32_t group() { return 64 / size > tile<size>() ? static_cast<uint32_t>(64 / size) : tile<size>(); }
+
+		// Position of pixel (x, y) in its tile (x, y < 16)
+		inline uint32_t tile_offset(const uint32_t x, const uint32_t y) {
+			return static_cast<uint32_t>(morton_encode_LUT<2, 4, 0>::table[x] | morton_encode_LUT<2, 4, 1>::table[y]);
+		}
+
+		// The lowest level of Z-order is a 2 x 2 quad of pixels: rows of two pixels of y and y + 1, one after the other.
+		// Tiles are copied a quad at a time, quad q of a tile starting at pixel (x[q], y[q]).
+		struct quad_table {
+			uint8_t x[64];
+			uint8_t y[64];
+		};
+		constexpr quad_table make_quad_table() {
+			quad_table quads{};
+			for (unsigned int q = 0; q < 64; ++q) {
+				for (unsigned int b = 0; b < 3; ++b) {
+					quads.x[q] = static_cast<uint8_t>(quads.x[q] | (((q >> (2 * b)) & 1) << (b + 1)));
+					quads.y[q] = static_cast<uint8_t>(quads.y[q] | (((q >> (2 * b + 1)) & 1) << (b + 1)));
+				}
+			}
+			return quads;
+		}
+		template<typename dummy = void>
+		struct quads {
+			static constexpr quad_table table = make_quad_table();
+		};
+		template<typename dummy>
+		constexpr quad_table quads<dummy>::table;
+
+		// Copy bytes (a multiple of 16, from a 16-byte aligned buffer) to dst, with streaming stores if stream
+		inline void store(unsigned char* dst, const unsigned char* src, const size_t bytes, const bool stream) {
+#if LIBMORTON_X86_DISPATCH
+			if (stream) {
+				for (size_t i = 0; i < bytes; i += 16) {
+					_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), _mm_load_si128(reinterpret_cast<const __m128i*>(src + i)));
+				}
+				return;
+			}
+#endif
+			memcpy(dst, src, bytes);
+		}
+
+		inline void store_fence(const bool stream) {
+#if LIBMORTON_X86_DISPATCH
+			if (stream) { _mm_sfence(); }
+#else
+			(void)stream;
+#endif
+		}
+
+		inline bool streamable(const void* dst, const size_t pitch, const size_t bytes) {
+			return LIBMORTON_X86_DISPATCH && bytes >= stream_bytes && (reinterpret_cast<uintptr_t>(dst) | pitch) % 16 == 0;
+		}
+
+		template<size_t size>
+		inline void swizzle(const unsigned char* src, const size_t pitch, unsigned char* dst, const uint32_t width, const uint32_t height) {
+			typedef pixel<size> element;
+			typedef pixel<2 * size> pair;
+			static const uint32_t side = tile<size>();
+			const bool stream = streamable(dst, 0, size_t(width) * height * size);
+			alignas(64) pair buffer[side * side / 2];
+			for (uint32_t y0 = 0; y0 < height; y0 += side) {
+				for (uint32_t x0 = 0; x0 < width; x0 += side) {
+					element* out = reinterpret_cast<element*>(dst) + morton2D_64_encode(x0, y0);
+					if (x0 + side <= width && y0 + side <= height) {
+						const unsigned char* corner = src + y0 * pitch + size_t(x0) * size;
+						for (uint32_t q = 0; q < side * side / 4; ++q) {
+							const unsigned char* row = corner + quads<>::table.y[q] * pitch + quads<>::table.x[q] * size;
+							memcpy(&buffer[2 * q], row, 2 * size);
+							memcpy(&buffer[2 * q + 1], row + pitch, 2 * size);
+						}
+						store(reinterpret_cast<unsigned char*>(out), reinterpret_cast<const unsigned char*>(buffer), sizeof(buffer), stream);
+					}
+					else {
+						// Tiles on the right and bottom edges of the image
+						for (uint32_t r = 0; r < side && y0 + r < height; ++r) {
+							const element* row = reinterpret_cast<const element*>(src + (y0 + r) * pitch) + x0;
+							for (uint32_t c = 0; c < side && x0 + c < width; ++c) { out[tile_offset(c, r)] = row[c]; }
+						}
+					}
+				}
+			}
+			store_fence(stream);
+		}
+
+		template<size_t size>
+		inline void unswizzle(const unsigned char* src, unsigned char* dst, const size_t pitch, const uint32_t width, const uint32_t height) {
+			typedef pixel<size> element;
+			typedef pixel<2 * size> pair;
+			static const uint32_t side = tile<size>(), columns = group<size>();
+			const bool stream = streamable(dst, pitch, size_t(width) * height * size);
+			// Rows of a group of tiles, written out a row at a time
+			alignas(64) element buffer[side][columns];
+			for (uint32_t y0 = 0; y0 < height; y0 += side) {
+				uint32_t x0 = 0;
+				for (; y0 + side <= height && x0 + columns <= width; x0 += columns) {
+					for (uint32_t t = 0; t < columns; t += side) {
+						const pair* in = reinterpret_cast<const pair*>(reinterpret_cast<const element*>(src) + morton2D_64_encode(x0 + t, y0));
+						for (uint32_t q = 0; q < side * side / 4; ++q) {
+							const uint32_t x = t + quads<>::table.x[q], y = quads<>::table.y[q];
+							memcpy(&buffer[y][x], &in[2 * q], 2 * size);
+							memcpy(&buffer[y + 1][x], &in[2 * q + 1], 2 * size);
+						}
+					}
+					for (uint32_t r = 0; r < side; ++r) {
+						store(dst + (y0 + r) * pitch + size_t(x0) * size, reinterpret_cast<const unsigned char*>(buffer[r]), sizeof(buffer[r]), stream);
+					}
+				}
+				// Pixels on the right and bottom edges of the image
+				for (uint32_t r = 0; r < side && y0 + r < height; ++r) {
+					element* row = reinterpret_cast<element*>(dst + (y0 + r) * pitch);
+					for (uint32_t x = x0; x < width; ++x) {
+						row[x] = reinterpret_cast<const element*>(src)[morton2D_64_encode(x & ~(side - 1), y0) + tile_offset(x & (side - 1), r)];
+					}
+				}
+			}
+			store_fence(stream);
+		}
+	}
+
+	// SWIZZLED SIZE : elements of the swizzled layout of an image of width x height pixels, morton2D_64_encode(width - 1,
+	// height - 1) + 1 (width * height for square images with a side which is a power of 2)
+	inline size_t morton2D_swizzled_size(const uint32_t width, const uint32_t height) {
+		return width == 0 || height == 0 ? 0 : static_cast<size_t>(morton2D_64_encode(width - 1, height - 1)) + 1;
+	}
+
+	// SWIZZLE : copy a row-major image (rows of width pixels of element_size bytes, pitch bytes apart) to Z-order
+	// layout, pixel (x, y) to element morton2D_64_encode(x, y) of dst. element_size is 1, 2, 4, 8 or 16 bytes (returns
+	// false otherwise). Elements of dst which are no pixel are left untouched.
+	inline bool morton2D_swizzle(const void* src, const size_t pitch, void* dst, const uint32_t width, const uint32_t height, const size_t element_size) {
+		const unsigned char* in = static_cast<const unsigned char*>(src);
+		unsigned char* out = static_cast<unsigned char*>(dst);
+		switch (element_size) {
+		case 1: swizzle_detail::swizzle<1>(in, pitch, out, width, height); return true;
+		case 2: swizzle_detail::swizzle<2>(in, pitch, out, width, height); return true;
+		case 4: swizzle_detail::swizzle<4>(in, pitch, out, width, height); return true;
+		case 8: swizzle_detail::swizzle<8>(in, pitch, out, width, height); return true;
+		case 16: swizzle_detail::swizzle<16>(in, pitch, out, width, height); return true;
+		default: return false;
+		}
+	}
+
+	// UNSWIZZLE : copy an image in Z-order layout back to a row-major image (rows pitch bytes apart)
+	inline bool morton2D_unswizzle(const void* src, void* dst, const size_t pitch, const uint32_t width, const uint32_t height, const size_t element_size) {
+		const unsigned char* in = static_cast<const unsigned char*>(src);
+		unsigned char* out = static_cast<unsigned char*>(dst);
+		switch (element_size) {
+		case 1: swizzle_detail::unswizzle<1>(in, out, pitch, width, height); return true;
+		case 2: swizzle_detail::unswizzle<2>(in, out, pitch, width, height); return true;
+		case 4: swizzle_detail::unswizzle<4>(in, out, pitch, width, height); return true;
+		case 8: swizzle_detail::unswizzle<8>(in, out, pitch, width, height); return true;
+		case 16: swizzle_detail::unswizzle<16>(in, out, pitch, width, height); return true;
+		default: return false;
+		}
+	}
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+// Libmorton - Quadtree / octree navigation on morton codes
+// A morton code of sizeof(morton) * 8 / dims bits per coordinate is a path from the root of a quadtree (2D) or octree
+// (3D) to a leaf: level 0 is the root (the whole grid), and every level down takes the next dims bits, from the top.
+// A cell of level L is given by its level and by the code of its lowest corner (its anchor: the code with every bit
+// below the top dims * L bits cleared). There is no sentinel bit; cells of different levels can share an anchor.
+//
+// All methods work for any code width (uint32_t, uint64_t, morton128_t) and compile to a few shifts and masks,
+// without branches. The ones which do not scan for the highest set bit are constexpr.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include "morton_common.h"
+#include "morton_quantize.h"
+
+namespace libmorton {
+	namespace tree_detail {
+		// Depth of the tree: bits per coordinate
+		template<typename morton, unsigned int dims>
+		constexpr unsigned int levels() { return magicbits_detail::coord_bits<morton, dims>(); }
+
+		// Bits of a code below the cells of level
+		template<typename morton, unsigned int dims>
+		constexpr unsigned int shift(const unsigned int level) { return dims * (levels<morton, dims>() - level); }
+
+		// Bits below bit s set, for any s up to the width of morton (shifting by the full width is undefined)
+		template<typename morton>
+		constexpr morton low_mask(const unsigned int s) {
+			return static_cast<morton>(~static_cast<morton>(static_cast<morton>(static_cast<morton>(~morton(0)) << (s / 2)) << (s - s / 2)));
+		}
+
+		// Number of bits of x up to its highest set bit (0 for 0)
+		inline unsigned int significant_bits(const uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<unsigned int>(x != 0) * static_cast<unsigned int>(64 - __builtin_clzll(x | 1));
+#else
+			unsigned long msb = 0;
+			const unsigned int found = findFirstSetBitZeroIdx(x, &msb) ? 1 : 0;
+			return found * static_cast<unsigned int>(msb + 1);
+#endif
+		}
+		inline unsigned int significant_bits(const uint32_t x) { return significant_bits(static_cast<uint64_t>(x)); }
+#if LIBMORTON_HAS_UINT128
+		inline unsigned int significant_bits(const morton128_t x) {
+			const unsigned int high = significant_bits(static_cast<uint64_t>(x >> 64));
+			return high != 0 ? 64 + high : significant_bits(static_cast<uint64_t>(x));
+		}
+#endif
+
+		template<typename morton, unsigned int dims>
+		constexpr morton cell(const morton m, const unsigned int level) {
+			return static_cast<morton>(m & static_cast<morton>(~low_mask<morton>(shift<morton, dims>(level))));
+		}
+
+		template<typename morton, unsigned int dims>
+		constexpr morton cell_last(const morton cell, const unsigned int level) {
+			return static_cast<morton>(cell | low_mask<morton>(shift<morton, dims>(level)));
+		}
+
+		template<typename morton, unsigned int dims>
+		constexpr morton child(const morton cell, const unsigned int level, const unsigned int i) {
+			return static_cast<morton>(cell | static_cast<morton>(static_cast<morton>(i) << shift<morton, dims>(level + 1)));
+		}
+
+		template<typename morton, unsigned int dims>
+		constexpr unsigned int child_index(const morton m, const unsigned int level) {
+			return static_cast<unsigned int>(m >> shift<morton, dims>(level)) & ((1u << dims) - 1);
+		}
+
+		template<typename morton, unsigned int dims>
+		constexpr morton sibling(const morton cell, const unsigned int level, const unsigned int i) {
+			return static_cast<morton>((cell & static_cast<morton>(~static_cast<morton>(static_cast<morton>((1u << dims) - 1) << shift<morton, dims>(level))))
+				| static_cast<morton>(static_cast<morton>(i) << shift<morton, dims>(level)));
+		}
+
+		// Deepest level of the cells holding both a and b. Levels end at bit dims * levels(), not at the top of the
+		// code: the top bits of 3D codes hold no coordinate.
+		template<typename morton, unsigned int dims>
+		inline unsigned int common_level(const morton a, const morton b) {
+			const unsigned int differ = significant_bits(static_cast<morton>(a ^ b));
+			return levels<morton, dims>() - (differ + dims - 1) / dims;
+		}
+
+		// Lowest corner of a cell, and its size minus one, in grid coordinates. The root of 2D 128-bit codes is 2^64
+		// cells wide: only its last coordinate fits in 64 bits.
+		template<typename morton, unsigned int dims, typename coord>
+		constexpr coord corner(const morton cell, const unsigned int axis) {
+			return static_cast<coord>(magicbits_detail::compact_bits<morton, dims>(static_cast<morton>(cell >> axis)));
+		}
+		template<typename morton, unsigned int dims>
+		constexpr uint64_t last(const unsigned int level) { return low_mask<uint64_t>(levels<morton, dims>() - level); }
+
+		template<typename morton, unsigned int dims, typename real>
+		inline morton_aabb<real, dims> cell_box(const morton cell, const unsigned int level, const morton_aabb<real, dims>& domain) {
+			const double cells = ldexp(1.0, static_cast<int>(levels<morton, dims>()));
+			const double extent = ldexp(1.0, static_cast<int>(levels<morton, dims>() - level));
+			morton_aabb<real, dims> box;
+			for (unsigned int d = 0; d < dims; ++d) {
+				const double width = (static_cast<double>(domain.hi[d]) - static_cast<double>(domain.lo[d])) / cells;
+				const double lo = static_cast<double>(corner<morton, dims, uint64_t>(cell, d));
+				box.lo[d] = static_cast<real>(domain.lo[d] + lo * width);
+				box.hi[d] = static_cast<real>(domain.lo[d] + (lo + extent) * width);
+			}
+			return box;
+		}
+	}
+
+	// TREE DEPTH : number of levels below the root of the quadtree / octree of a code type (bits per coordinate)
+	template<typename morton> constexpr unsigned int m2D_levels() { return tree_detail::levels<morton, 2>(); }
+	template<typename morton> constexpr unsigned int m3D_levels() { return tree_detail::levels<morton, 3>(); }
+
+	// CELL (ancestor) : anchor of the cell of level holding code m. m2D_cell(m, m2D_levels<morton>()) is m itself.
+	template<typename morton> constexpr morton m2D_cell(const morton m, const unsigned int level) { return tree_detail::cell<morton, 2>(m, level); }
+	template<typename morton> constexpr morton m3D_cell(const morton m, const unsigned int level) { return tree_detail::cell<morton, 3>(m, level); }
+
+	// PARENT : anchor of the parent of a cell of level (level >= 1)
+	template<typename morton> constexpr morton m2D_parent(const morton cell, const unsigned int level) { return tree_detail::cell<morton, 2>(cell, level - 1); }
+	template<typename morton> constexpr morton m3D_parent(const morton cell, const unsigned int level) { return tree_detail::cell<morton, 3>(cell, level - 1); }
+
+	// CHILD : anchor of child i (0 .. 3 / 0 .. 7, in morton order) of a cell of level (level < levels)
+	template<typename morton> constexpr morton m2D_child(const morton cell, const unsigned int level, const unsigned int i) { return tree_detail::child<morton, 2>(cell, level, i); }
+	template<typename morton> constexpr morton m3D_child(const morton cell, const unsigned int level, const unsigned int i) { return tree_detail::child<morton, 3>(cell, level, i); }
+
+	// CHILD INDEX : which child of its parent the cell of level holding code m is (level >= 1)
+	template<typename morton> constexpr unsigned int m2D_child_index(const morton m, const unsigned int level) { return tree_detail::child_index<morton, 2>(m, level); }
+	template<typename morton> constexpr unsigned int m3D_child_index(const morton m, const unsigned int level) { return tree_detail::child_index<morton, 3>(m, level); }
+
+	// SIBLING : anchor of child i of the parent of a cell of level (level >= 1). Iterate over i = 0 .. 3 / 0 .. 7 to
+	// visit all siblings in morton order.
+	template<typename morton> constexpr morton m2D_sibling(const morton cell, const unsigned int level, const unsigned int i) { return tree_detail::sibling<morton, 2>(cell, level, i); }
+	template<typename morton> constexpr morton m3D_sibling(const morton cell, const unsigned int level, const unsigned int i) { return tree_detail::sibling<morton, 3>(cell, level, i); }
+
+	// LAST CODE of a cell of level: the codes in the cell are anchor .. m2D_cell_last(anchor, level), inclusive
+	template<typename morton> constexpr morton m2D_cell_last(const morton cell, const unsigned int level) { return tree_detail::cell_last<morton, 2>(cell, level); }
+	template<typename morton> constexpr morton m3D_cell_last(const morton cell, const unsigned int level) { return tree_detail::cell_last<morton, 3>(cell, level); }
+
+	// COMMON LEVEL : deepest level of the cells holding both codes (m2D_levels<morton>() if a == b)
+	template<typename morton> inline unsigned int m2D_common_level(const morton a, const morton b) { return tree_detail::common_level<morton, 2>(a, b); }
+	template<typename morton> inline unsigned int m3D_common_level(const morton a, const morton b) { return tree_detail::common_level<morton, 3>(a, b); }
+
+	// CELL BOUNDS in grid coordinates : lowest and highest (inclusive) coordinates of the cells of a cell of level
+	template<typename morton, typename coord>
+	inline void m2D_cell_bounds(const morton cell, const unsigned int level, coord& min_x, coord& min_y, coord& max_x, coord& max_y) {
+		const uint64_t last = tree_detail::last<morton, 2>(level);
+		min_x = tree_detail::corner<morton, 2, coord>(cell, 0);
+		min_y = tree_detail::corner<morton, 2, coord>(cell, 1);
+		max_x = static_cast<coord>(min_x + last);
+		max_y = static_cast<coord>(min_y + last);
+	}
+	template<typename morton, typename coord>
+	inline void m3D_cell_bounds(const morton cell, const unsigned int level, coord& min_x, coord& min_y, coord& min_z, coord& max_x, coord& max_y, coord& max_z) {
+		const uint64_t last = tree_detail::last<morton, 3>(level);
+		min_x = tree_detail::corner<morton, 3, coord>(cell, 0);
+		min_y = tree_detail::corner<morton, 3, coord>(cell, 1);
+		min_z = tree_detail::corner<morton, 3, coord>(cell, 2);
+		max_x = static_cast<coord>(min_x + last);
+		max_y = static_cast<coord>(min_y + last);
+		max_z = static_cast<coord>(min_z + last);
+	}
+
+	// CELL BOX : bounding box of a cell of level, for codes quantized in domain (see morton_quantize.h)
+	template<typename morton, typename real>
+	inline morton_aabb<real, 2> m2D_cell_box(const morton cell, const unsigned int level, const morton_aabb<real, 2>& domain) { return tree_detail::cell_box<morton, 2, real>(cell, level, domain); }
+	template<typename morton, typename real>
+	inline morton_aabb<real, 3> m3D_cell_box(const morton cell, const unsigned int level, const morton_aabb<real, 3>& domain) { return tree_detail::cell_box<morton, 3, real>(cell, level, domain); }
+
+	// CELL (batch) : out[i] = anchor of the cell of level holding m[i]
+	template<typename morton>
+	inline void m2D_cell_batch(const morton* m, const size_t n, const unsigned int level, morton* out) {
+		for (size_t i = 0; i < n; ++i) { out[i] = tree_detail::cell<morton, 2>(m[i], level); }
+	}
+	template<typename morton>
+	inline void m3D_cell_batch(const morton* m, const size_t n, const unsigned int level, morton* out) {
+		for (size_t i = 0; i < n; ++i) { out[i] = tree_detail::cell<morton, 3>(m[i], level); }
+	}
+
+	// COMMON LEVEL (batch) : out[i] = deepest level of the cells holding both a[i] and b[i]. With b = a + 1, the levels
+	// between consecutive codes of a sorted array: where the tree over them branches.
+	template<typename morton>
+	inline void m2D_common_level_batch(const morton* a, const morton* b, const size_t n, unsigned int* out) {
+		for (size_t i = 0; i < n; ++i) { out[i] = tree_detail::common_level<morton, 2>(a[i], b[i]); }
+	}
+	template<typename morton>
+	inline void m3D_common_level_batch(const morton* a, const morton* b, const size_t n, unsigned int* out) {
+		for (size_t i = 0; i < n; ++i) { out[i] = tree_detail::common_level<morton, 3>(a[i], b[i]); }
+	}
+}
@@ -0,0 +1,324 @@
+#pragma once
+
+// Libmorton - On-host tuning of the methods behind the morton.h stubs
+// Which method is fastest depends on the CPU and on the data (the ET methods win on small coordinates, the LUT
+// methods lose when their tables get evicted from cache, ...). tune_methods() times every method the host CPU
+// supports for every morton.h stub, on your own sample data or on a synthetic set, checks each method returns
+// correct results, and binds the fastest one.
+//
+// The result is a morton_profile, which can be saved to a small text file and bound again at startup
+// (bind_profile_file()) so production processes don't pay the calibration cost.
+// Like the other binding functions in morton_dispatch.h, these are not thread-safe.
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "morton_dispatch.h"
+
+namespace libmorton {
+
+	// Methods bound to every morton.h stub
+	struct morton_profile {
+		morton_method methods[morton_slot_count];
+		morton_method batch_method;
+	};
+
+	struct morton_tuning_options {
+		size_t samples = 4096; // synthetic samples per stub
+		unsigned int repeats = 5; // timed runs per method, the fastest one counts
+		uint64_t seed = 0x9E3779B97F4A7C15ull; // seed for the synthetic samples
+	};
+
+	// Methods currently bound to the morton.h stubs
+	inline morton_profile current_profile() {
+		morton_profile p;
+		for (size_t slot = 0; slot < morton_slot_count; ++slot) {
+			p.methods[slot] = bound_method(static_cast<morton_slot>(slot));
+		}
+		p.batch_method = bound_batch_method();
+		return p;
+	}
+
+	// Bind all methods in profile p. Methods the host CPU does not support are skipped (the stub keeps its
+	// current method), in which case this returns false.
+	inline bool bind_profile(const morton_profile& p) {
+		bool ok = true;
+		for (size_t slot = 0; slot < morton_slot_count; ++slot) {
+			ok &= bind_method(static_cast<morton_slot>(slot), p.methods[slot]);
+		}
+		ok &= set_batch_method(p.batch_method);
+		return ok;
+	}
+
+	// Write profile p as "<stub> <method>" lines
+	inline bool save_profile(const morton_profile& p, const char* path) {
+		FILE* f = fopen(path, "w");
+		if (f == nullptr) { return false; }
+		fprintf(f, "# libmorton profile\n");
+		for (size_t slot = 0; slot < morton_slot_count; ++slot) {
+			fprintf(f, "%s %s\n", slot_name(static_cast<morton_slot>(slot)), method_name(p.methods[slot]));
+		}
+		fprintf(f, "batch %s\n", method_name(p.batch_method));
+		return fclose(f) == 0;
+	}
+
+	// Read a profile written by save_profile(). Stubs missing from the file are set to automatic.
+	inline bool load_profile(const char* path, morton_profile& p) {
+		FILE* f = fopen(path, "r");
+		if (f == nullptr) { return false; }
+		for (size_t slot = 0; slot < morton_slot_count; ++slot) { p.methods[slot] = morton_method::automatic; }
+		p.batch_method = morton_method::automatic;
+		bool ok = true;
+		char line[128], name[64], method[64];
+		while (fgets(line, sizeof(line), f) != nullptr) {
+			if (line[0] == '#' || line[0] == '\n') { continue; }
+			morton_slot slot;
+			morton_method m;
+			if (sscanf(line, "%63s %63s", name, method) != 2 || !parse_method(method, m)) { ok = false; continue; }
+			if (strcmp(name, "batch") == 0) { p.batch_method = m; }
+			else if (parse_slot(name, slot)) { p.methods[static_cast<size_t>(slot)] = m; }
+			else { ok = false; }
+		}
+		fclose(f);
+		return ok;
+	}
+
+	// Load a profile and bind it
+	inline bool bind_profile_file(const char* path) {
+		morton_profile p;
+		return load_profile(path, p) && bind_profile(p);
+	}
+
+	namespace tuner_detail {
+		static const morton_method candidates[] = {
+			morton_method::LUT, morton_method::sLUT, morton_method::LUT_ET, morton_method::sLUT_ET,
+			morton_method::magicbits, morton_method::BMI2, morton_method::CLMUL };
+
+		// Sample coordinates for all stubs, truncated to what each morton code width can hold
+		struct samples {
+			std::vector<uint32_t> x, y, z;
+		};
+
+		// 64-bit coordinates from the bits of a (high half) and b (low half), truncated to bits
+		inline std::vector<uint64_t> widen(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, const unsigned int bits) {
+			std::vector<uint64_t> out(a.size());
+			const uint64_t mask = (bits >= 64) ? ~0ull : ((1ull << bits) - 1);
+			for (size_t i = 0; i < a.size(); ++i) { out[i] = ((static_cast<uint64_t>(a[i]) << 32) | b[i]) & mask; }
+			return out;
+		}
+
+		template<typename T>
+		inline std::vector<T> truncate(const std::vector<uint32_t>& c, const unsigned int bits) {
+			std::vector<T> out(c.size());
+			const uint32_t mask = (bits >= 32) ? 0xFFFFFFFFu : ((1u << bits) - 1);
+			for (size_t i = 0; i < c.size(); ++i) { out[i] = static_cast<T>(c[i] & mask); }
+			return out;
+		}
+
+		// Fastest of repeats runs of f, in seconds (after one warm-up run)
+		template<typename F>
+		inline double time_best(F f, const unsigned int repeats) {
+			f();
+			double best = 1e30;
+			for (unsigned int r = 0; r < repeats; ++r) {
+				const auto start = std::chrono::steady_clock::now();
+				f();
+				const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+				if (elapsed.count() < best) { best = elapsed.count(); }
+			}
+			return best;
+		}
+
+		static volatile uint64_t sink;
+
+		// Fastest correct method for one encode stub. The reference is magicbits, which needs no tables or
+		// instruction set extensions.
+		template<typename morton, typename coord>
+		inline morton_method tune_encode2D(const std::vector<coord>& x, const std::vector<coord>& y, const unsigned int repeats) {
+			const size_t n = x.size();
+			std::vector<morton> expected(n);
+			for (size_t i = 0; i < n; ++i) { expected[i] = m2D_e_magicbits<morton, coord>(x[i], y[i]); }
+			morton_method best = morton_method::automatic;
+			double best_time = 1e30;
+			for (morton_method m : candidates) {
+				const auto encode = dispatch_detail::encode2D<morton, coord>(m);
+				if (!method_supported(m) || encode == nullptr) { continue; }
+				bool correct = true;
+				for (size_t i = 0; i < n && correct; ++i) { correct = encode(x[i], y[i]) == expected[i]; }
+				if (!correct) { continue; }
+				const double t = time_best([&]() {
+					morton acc = 0;
+					for (size_t i = 0; i < n; ++i) { acc ^= encode(x[i], y[i]); }
+					sink = acc;
+				}, repeats);
+				if (t < best_time) { best_time = t; best = m; }
+			}
+			return best;
+		}
+
+		template<typename morton, typename coord>
+		inline morton_method tune_encode3D(const std::vector<coord>& x, const std::vector<coord>& y, const std::vector<coord>& z, const unsigned int repeats) {
+			const size_t n = x.size();
+			std::vector<morton> expected(n);
+			for (size_t i = 0; i < n; ++i) { expected[i] = m3D_e_magicbits<morton, coord>(x[i], y[i], z[i]); }
+			morton_method best = morton_method::automatic;
+			double best_time = 1e30;
+			for (morton_method m : candidates) {
+				const auto encode = dispatch_detail::encode3D<morton, coord>(m);
+				if (!method_supported(m) || encode == nullptr) { continue; }
+				bool correct = true;
+				for (size_t i = 0; i < n && correct; ++i) { correct = encode(x[i], y[i], z[i]) == expected[i]; }
+				if (!correct) { continue; }
+				const double t = time_best([&]() {
+					morton acc = 0;
+					for (size_t i = 0; i < n; ++i) { acc ^= encode(x[i], y[i], z[i]); }
+					sink = acc;
+				}, repeats);
+				if (t < best_time) { best_time = t; best = m; }
+			}
+			return best;
+		}
+
+		// Fastest correct method for one decode stub, decoding the codes of the sample coordinates
+		template<typename morton, typename coord>
+		inline morton_method tune_decode2D(const std::vector<coord>& x, const std::vector<coord>& y, const unsigned int repeats) {
+			const size_t n = x.size();
+			std::vector<morton> codes(n);
+			for (size_t i = 0; i < n; ++i) { codes[i] = m2D_e_magicbits<morton, coord>(x[i], y[i]); }
+			morton_method best = morton_method::automatic;
+			double best_time = 1e30;
+			for (morton_method m : candidates) {
+				const auto decode = dispatch_detail::decode2D<morton, coord>(m);
+				if (!method_supported(m) || decode == nullptr) { continue; }
+				bool correct = true;
+				for (size_t i = 0; i < n && correct; ++i) {
+					coord dx, dy;
+					decode(codes[i], dx, dy);
+					correct = dx == x[i] && dy == y[i];
+				}
+				if (!correct) { continue; }
+				const double t = time_best([&]() {
+					coord acc = 0, dx, dy;
+					for (size_t i = 0; i < n; ++i) { decode(codes[i], dx, dy); acc ^= dx ^ dy; }
+					sink = acc;
+				}, repeats);
+				if (t < best_time) { best_time = t; best = m; }
+			}
+			return best;
+		}
+
+		template<typename morton, typename coord>
+		inline morton_method tune_decode3D(const std::vector<coord>& x, const std::vector<coord>& y, const std::vector<coord>& z, const unsigned int repeats) {
+			const size_t n = x.size();
+			std::vector<morton> codes(n);
+			for (size_t i = 0; i < n; ++i) { codes[i] = m3D_e_magicbits<morton, coord>(x[i], y[i], z[i]); }
+			morton_method best = morton_method::automatic;
+			double best_time = 1e30;
+			for (morton_method m : candidates) {
+				const auto decode = dispatch_detail::decode3D<morton, coord>(m);
+				if (!method_supported(m) || decode == nullptr) { continue; }
+				bool correct = true;
+				for (size_t i = 0; i < n && correct; ++i) {
+					coord dx, dy, dz;
+					decode(codes[i], dx, dy, dz);
+					correct = dx == x[i] && dy == y[i] && dz == z[i];
+				}
+				if (!correct) { continue; }
+				const double t = time_best([&]() {
+					coord acc = 0, dx, dy, dz;
+					for (size_t i = 0; i < n; ++i) { decode(codes[i], dx, dy, dz); acc ^= dx ^ dy ^ dz; }
+					sink = acc;
+				}, repeats);
+				if (t < best_time) { best_time = t; best = m; }
+			}
+			return best;
+		}
+
+		// Time all batch stubs with the batch method m bound
+		inline double time_batch(const samples& s, const morton_method m, const unsigned int repeats) {
+			if (!set_batch_method(m)) { return 1e30; }
+			const size_t n = s.x.size();
+			const std::vector<uint16_t> x16 = truncate<uint16_t>(s.x, 16), y16 = truncate<uint16_t>(s.y, 16);
+			const std::vector<uint16_t> x10 = truncate<uint16_t>(s.x, 10), y10 = truncate<uint16_t>(s.y, 10), z10 = truncate<uint16_t>(s.z, 10);
+			const std::vector<uint32_t> x21 = truncate<uint32_t>(s.x, 21), y21 = truncate<uint32_t>(s.y, 21), z21 = truncate<uint32_t>(s.z, 21);
+			std::vector<uint32_t> c32(n), ox(n), oy(n), oz(n);
+			std::vector<uint64_t> c64(n);
+			std::vector<uint16_t> o16x(n), o16y(n), o16z(n);
+			return time_best([&]() {
+				dispatch_detail::table().m2D_32_encode_batch(x16.data(), y16.data(), c32.data(), n);
+				dispatch_detail::table().m2D_32_decode_batch(c32.data(), o16x.data(), o16y.data(), n);
+				dispatch_detail::table().m2D_64_encode_batch(s.x.data(), s.y.data(), c64.data(), n);
+				dispatch_detail::table().m2D_64_decode_batch(c64.data(), ox.data(), oy.data(), n);
+				dispatch_detail::table().m3D_32_encode_batch(x10.data(), y10.data(), z10.data(), c32.data(), n);
+				dispatch_detail::table().m3D_32_decode_batch(c32.data(), o16x.data(), o16y.data(), o16z.data(), n);
+				dispatch_detail::table().m3D_64_encode_batch(x21.data(), y21.data(), z21.data(), c64.data(), n);
+				dispatch_detail::table().m3D_64_decode_batch(c64.data(), ox.data(), oy.data(), oz.data(), n);
+				sink = ox[n / 2] ^ o16z[n / 2];
+			}, repeats);
+		}
+
+		// Nothing to time without samples: the current binding stays
+		inline morton_profile tune(const samples& s, const unsigned int repeats) {
+			if (s.x.empty()) { return current_profile(); }
+			morton_profile p;
+			const std::vector<uint16_t> x16 = truncate<uint16_t>(s.x, 16), y16 = truncate<uint16_t>(s.y, 16);
+			const std::vector<uint32_t> x32 = truncate<uint32_t>(s.x, 32), y32 = truncate<uint32_t>(s.y, 32);
+			const std::vector<uint16_t> x10 = truncate<uint16_t>(s.x, 10), y10 = truncate<uint16_t>(s.y, 10), z10 = truncate<uint16_t>(s.z, 10);
+			const std::vector<uint32_t> x21 = truncate<uint32_t>(s.x, 21), y21 = truncate<uint32_t>(s.y, 21), z21 = truncate<uint32_t>(s.z, 21);
+			p.methods[static_cast<size_t>(morton_slot::m2D_32_encode)] = tune_encode2D<uint32_t, uint16_t>(x16, y16, repeats);
+			p.methods[static_cast<size_t>(morton_slot::m2D_64_encode)] = tune_encode2D<uint64_t, uint32_t>(x32, y32, repeats);
+			p.methods[static_cast<size_t>(morton_slot::m3D_32_encode)] = tune_encode3D<uint32_t, uint16_t>(x10, y10, z10, repeats);
+			p.methods[static_cast<size_t>(morton_slot::m3D_64_encode)] = tune_encode3D<uint64_t, uint32_t>(x21, y21, z21, repeats);
+			p.methods[static_cast<size_t>(morton_slot::m2D_32_decode)] = tune_decode2D<uint32_t, uint16_t>(x16, y16, repeats);
+			p.methods[static_cast<size_t>(morton_slot::m2D_64_decode)] = tune_decode2D<uint64_t, uint32_t>(x32, y32, repeats);
+			p.methods[static_cast<size_t>(morton_slot::m3D_32_decode)] = tune_decode3D<uint32_t, uint16_t>(x10, y10, z10, repeats);
+			p.methods[static_cast<size_t>(morton_slot::m3D_64_decode)] = tune_decode3D<uint64_t, uint32_t>(x21, y21, z21, repeats);
+#if LIBMORTON_HAS_UINT128
+			const std::vector<uint64_t> x64 = widen(s.x, s.y, 64), y64 = widen(s.y, s.z, 64);
+			const std::vector<uint64_t> x42 = widen(s.x, s.y, 42), y42 = widen(s.y, s.z, 42), z42 = widen(s.z, s.x, 42);
+			p.methods[static_cast<size_t>(morton_slot::m2D_128_encode)] = tune_encode2D<morton128_t, uint64_t>(x64, y64, repeats);
+			p.methods[static_cast<size_t>(morton_slot::m3D_128_encode)] = tune_encode3D<morton128_t, uint64_t>(x42, y42, z42, repeats);
+			p.methods[static_cast<size_t>(morton_slot::m2D_128_decode)] = tune_decode2D<morton128_t, uint64_t>(x64, y64, repeats);
+			p.methods[static_cast<size_t>(morton_slot::m3D_128_decode)] = tune_decode3D<morton128_t, uint64_t>(x42, y42, z42, repeats);
+#endif
+
+			// The batch loop calls the single-code stubs, so bind the winners before timing it
+			p.batch_method = morton_method::loop;
+			bind_profile(p);
+			if (method_supported(morton_method::AVX2)) {
+				const double loop = time_batch(s, morton_method::loop, repeats);
+				const double avx2 = time_batch(s, morton_method::AVX2, repeats);
+				p.batch_method = (avx2 < loop) ? morton_method::AVX2 : morton_method::loop;
+			}
+			set_batch_method(p.batch_method);
+			return p;
+		}
+	}
+
+	// Tune and bind the morton.h stubs on representative coordinates. Each stub is timed on the coordinates
+	// truncated to the bits its morton code holds, decode stubs on the codes of those coordinates.
+	// z may be nullptr for 2D data (the 3D stubs are then tuned with z = 0). With n = 0 the stubs keep their methods.
+	inline morton_profile tune_methods(const uint32_t* x, const uint32_t* y, const uint32_t* z, const size_t n, const unsigned int repeats = 5) {
+		tuner_detail::samples s;
+		s.x.assign(x, x + n);
+		s.y.assign(y, y + n);
+		if (z != nullptr) { s.z.assign(z, z + n); }
+		else { s.z.assign(n, 0); }
+		return tuner_detail::tune(s, repeats);
+	}
+
+	// Tune and bind the morton.h stubs on uniformly distributed synthetic coordinates
+	inline morton_profile tune_methods(const morton_tuning_options& options = morton_tuning_options()) {
+		tuner_detail::samples s;
+		uint64_t state = options.seed;
+		for (size_t i = 0; i < options.samples; ++i) {
+			// xorshift64*
+			state ^= state >> 12; state ^= state << 25; state ^= state >> 27;
+			const uint64_t r = state * 0x2545F4914F6CDD1Dull;
+			s.x.push_back(static_cast<uint32_t>(r));
+			s.y.push_back(static_cast<uint32_t>(r >> 32));
+			s.z.push_back(static_cast<uint32_t>(r >> 16) ^ static_cast<uint32_t>(r << 7));
+		}
+		return tuner_detail::tune(s, options.repeats);
+	}
+}
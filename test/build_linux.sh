@@ -1 +1 @@
-g++ -O3 -m64 -std=c++14 -I ../libmorton/include/ libmorton_test.cpp -o libmorton_test
+g++ -O3 -m64 -std=c++14 -pthread -I ../libmorton/include/ libmorton_test.cpp -o libmorton_test
@@ -7,6 +7,20 @@
 #include "libmorton_test.h"
 #include "libmorton_test_2D.h"
 #include "libmorton_test_3D.h"
+#include "libmorton_test_ND.h"
+#include "libmorton_test_dilated.h"
+#include "libmorton_test_query.h"
+#include "libmorton_test_sort.h"
+#include "libmorton_test_quantize.h"
+#include "libmorton_test_ordered.h"
+#include "libmorton_test_parallel.h"
+#include "libmorton_test_external.h"
+#include "libmorton_test_tree.h"
+#include "libmorton_test_octree.h"
+#include "libmorton_test_bvh.h"
+#include "libmorton_test_swizzle.h"
+#include "libmorton_test_grid.h"
+#include "libmorton_test_compact.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -22,6 +36,15 @@ size_t RAND_POOL_SIZE = 10000;
 vector<uint_fast64_t> running_sums;
 /// END GLOBALS
 
+// The magic bits and for loop methods are constexpr: check they fold at compile time
+static_assert(m3D_e_magicbits<uint_fast64_t, uint_fast32_t>(0x1FFFFF, 0, 0) == 0x1249249249249249, "3D 64-bit magic bits encode does not fold");
+static_assert(m3D_e_magicbits<uint_fast32_t, uint_fast16_t>(0, 0, 0x3FF) == 0x24924924, "3D 32-bit magic bits encode does not fold");
+static_assert(m2D_e_magicbits<uint_fast64_t, uint_fast32_t>(0, 0xFFFFFFFF) == 0xAAAAAAAAAAAAAAAA, "2D 64-bit magic bits encode does not fold");
+static_assert(m2D_e_for<uint_fast32_t, uint_fast16_t>(0xFFFF, 0) == 0x55555555, "2D 32-bit for loop encode does not fold");
+static_assert(morton3D_GetThirdBits<uint_fast64_t, uint_fast32_t>(0x1249249249249249) == 0x1FFFFF, "3D 64-bit magic bits decode does not fold");
+static_assert(morton2D_GetSecondBits<uint_fast32_t, uint_fast16_t>(0xAAAAAAAA >> 1) == 0xFFFF, "2D 32-bit magic bits decode does not fold");
+static_assert(m3D_inc<uint64_t>(m3D_e_magicbits<uint64_t, uint32_t>(0x1FFFFF, 1, 2), 0) == m3D_e_magicbits<uint64_t, uint32_t>(0, 1, 2), "3D 64-bit dilated increment does not fold");
+
 // Morton ND LUT (N = 2)
 constexpr auto MortonND_2D_32_4 = mortonnd::MortonNDLutEncoder<2, 16, 4>(); // 4 chunks per field, 4 bits each = 16 per field
 constexpr uint_fast32_t MortonND_2D_32_4_Encode(const uint_fast16_t x, const uint_fast16_t y) {
@@ -104,6 +127,28 @@ static inline void MortonND_3D_64_8_Decode(const uint_fast64_t encoding, uint_fa
 	std::tie(x, y, z) = MortonND_3D_64_8_d.Decode(encoding);
 }
 
+// libmorton N-D methods behind the 2D / 3D function signatures
+template <typename morton, typename coord, morton(*encode)(const std::array<coord, 2>&)>
+static inline morton ND_2D_Encode(const coord x, const coord y) {
+	return encode({ { x, y } });
+}
+template <typename morton, typename coord, void(*decode)(morton, std::array<coord, 2>&)>
+static inline void ND_2D_Decode(const morton m, coord& x, coord& y) {
+	std::array<coord, 2> c;
+	decode(m, c);
+	x = c[0]; y = c[1];
+}
+template <typename morton, typename coord, morton(*encode)(const std::array<coord, 3>&)>
+static inline morton ND_3D_Encode(const coord x, const coord y, const coord z) {
+	return encode({ { x, y, z } });
+}
+template <typename morton, typename coord, void(*decode)(morton, std::array<coord, 3>&)>
+static inline void ND_3D_Decode(const morton m, coord& x, coord& y, coord& z) {
+	std::array<coord, 3> c;
+	decode(m, c);
+	x = c[0]; y = c[1]; z = c[2];
+}
+
 // 3D functions collections
 vector<encode_3D_64_wrapper> f3D_64_encode; // 3D 64-bit encode functions
 vector<encode_3D_32_wrapper> f3D_32_encode; // 3D 32_bit encode functions
@@ -114,6 +159,29 @@ vector<encode_2D_64_wrapper> f2D_64_encode; // 2D 64-bit encode functions
 vector<encode_2D_32_wrapper> f2D_32_encode; // 2D 32_bit encode functions
 vector<decode_2D_64_wrapper> f2D_64_decode; // 2D 64-bit decode functions
 vector<decode_2D_32_wrapper> f2D_32_decode; // 2D 32_bit decode functions
+// N-D functions collections
+vector<encode_4D_64_wrapper> f4D_64_encode; // 4D 64-bit encode functions
+vector<decode_4D_64_wrapper> f4D_64_decode; // 4D 64-bit decode functions
+vector<encode_5D_64_wrapper> f5D_64_encode; // 5D 64-bit encode functions
+vector<decode_5D_64_wrapper> f5D_64_decode; // 5D 64-bit decode functions
+#if LIBMORTON_HAS_UINT128
+// 128-bit functions collections
+vector<encode_3D_128_wrapper> f3D_128_encode; // 3D 128-bit encode functions
+vector<decode_3D_128_wrapper> f3D_128_decode; // 3D 128-bit decode functions
+vector<encode_2D_128_wrapper> f2D_128_encode; // 2D 128-bit encode functions
+vector<decode_2D_128_wrapper> f2D_128_decode; // 2D 128-bit decode functions
+#endif
+// Batch functions collections
+vector<encode_batch_3D_64_wrapper> f3D_64_encode_batch; // 3D 64-bit batch encode functions
+vector<encode_batch_3D_32_wrapper> f3D_32_encode_batch; // 3D 32-bit batch encode functions
+vector<encode_batch_2D_64_wrapper> f2D_64_encode_batch; // 2D 64-bit batch encode functions
+vector<encode_batch_2D_32_wrapper> f2D_32_encode_batch; // 2D 32-bit batch encode functions
+vector<decode_batch_3D_64_wrapper> f3D_64_decode_batch; // 3D 64-bit batch decode functions
+vector<decode_batch_3D_32_wrapper> f3D_32_decode_batch; // 3D 32-bit batch decode functions
+vector<decode_batch_2D_64_wrapper> f2D_64_decode_batch; // 2D 64-bit batch decode functions
+vector<decode_batch_2D_32_wrapper> f2D_32_decode_batch; // 2D 32-bit batch decode functions
+vector<neighbors_batch_3D_64_wrapper> f3D_64_neighbors_batch; // 3D 64-bit batch neighbors functions
+vector<neighbors_batch_3D_32_wrapper> f3D_32_neighbors_batch; // 3D 32-bit batch neighbors functions
 
 // Make a total of all running_sum checks and print it
 // This is an elaborate way to ensure no function call gets optimized away
@@ -134,6 +202,14 @@ static std::string testEncode_3D_Perf(morton(*function)(coord, coord, coord), si
 	return os.str();
 }
 
+template <typename morton, typename coord>
+static std::string testEncode_3D_Batch_Perf(void(*function)(const coord*, const coord*, const coord*, morton*, size_t), size_t times) {
+	stringstream os;
+	os << setfill('0') << std::setw(6) << std::fixed << std::setprecision(3) << testEncode_3D_Batch_Linear_Perf<morton, coord>(function, times) << " ms "
+		<< testEncode_3D_Batch_Random_Perf<morton, coord>(function, times) << " ms";
+	return os.str();
+}
+
 template <typename morton, typename coord>
 static std::string testDecode_3D_Perf(void(*function)(const morton, coord&, coord&, coord&), size_t times) {
 	stringstream os;
@@ -142,6 +218,14 @@ static std::string testDecode_3D_Perf(void(*function)(const morton, coord&, coor
 	return os.str();
 }
 
+template <typename morton, typename coord>
+static std::string testDecode_3D_Batch_Perf(void(*function)(const morton*, coord*, coord*, coord*, size_t), size_t times) {
+	stringstream os;
+	os << setfill('0') << std::setw(6) << std::fixed << std::setprecision(3) << testDecode_3D_Batch_Linear_Perf<morton, coord>(function, times) << " ms "
+		<< testDecode_3D_Batch_Random_Perf<morton, coord>(function, times) << " ms";
+	return os.str();
+}
+
 static void Encode_3D_Perf() {
 	cout << "++ Encoding " << MAX << "^3 morton codes (" << total << " in total)" << endl;
 	for (auto it = f3D_64_encode.begin(); it != f3D_64_encode.end(); it++) {
@@ -150,6 +234,12 @@ static void Encode_3D_Perf() {
 	for (auto it = f3D_32_encode.begin(); it != f3D_32_encode.end(); it++) {
 		cout << "    " << testEncode_3D_Perf((*it).encode, times) << " : 32-bit " << (*it).description << endl;
 	}
+	for (auto it = f3D_64_encode_batch.begin(); it != f3D_64_encode_batch.end(); it++) {
+		cout << "    " << testEncode_3D_Batch_Perf((*it).encode, times) << " : 64-bit batch " << (*it).description << endl;
+	}
+	for (auto it = f3D_32_encode_batch.begin(); it != f3D_32_encode_batch.end(); it++) {
+		cout << "    " << testEncode_3D_Batch_Perf((*it).encode, times) << " : 32-bit batch " << (*it).description << endl;
+	}
 }
 
 inline static void Decode_3D_Perf() {
@@ -160,6 +250,102 @@ inline static void Decode_3D_Perf() {
 	for (auto it = f3D_32_decode.begin(); it != f3D_32_decode.end(); it++) {
 		cout << "    " << testDecode_3D_Perf((*it).decode, times) << " : 32-bit " << (*it).description << endl;
 	}
+	for (auto it = f3D_64_decode_batch.begin(); it != f3D_64_decode_batch.end(); it++) {
+		cout << "    " << testDecode_3D_Batch_Perf((*it).decode, times) << " : 64-bit batch " << (*it).description << endl;
+	}
+	for (auto it = f3D_32_decode_batch.begin(); it != f3D_32_decode_batch.end(); it++) {
+		cout << "    " << testDecode_3D_Batch_Perf((*it).decode, times) << " : 32-bit batch " << (*it).description << endl;
+	}
+}
+
+static void Neighbors_3D_Perf() {
+	cout << "++ Generating the 26 neighbors of " << MAX << "^3 morton codes (" << total << " in total)" << endl;
+	for (auto it = f3D_64_neighbors_batch.begin(); it != f3D_64_neighbors_batch.end(); it++) {
+		cout << "    " << setfill('0') << std::setw(6) << std::fixed << std::setprecision(3) << testNeighbors_3D_Batch_Linear_Perf<uint64_t>((*it).neighbors, times) << " ms : 64-bit batch " << (*it).description << endl;
+	}
+	for (auto it = f3D_32_neighbors_batch.begin(); it != f3D_32_neighbors_batch.end(); it++) {
+		cout << "    " << setfill('0') << std::setw(6) << std::fixed << std::setprecision(3) << testNeighbors_3D_Batch_Linear_Perf<uint32_t>((*it).neighbors, times) << " ms : 32-bit batch " << (*it).description << endl;
+	}
+}
+
+static void Quantize_3D_Perf() {
+	cout << "++ Encoding " << MAX << "^3 float positions (" << total << " in total)" << endl;
+	cout << "    " << testQuantize_3D_Perf<uint64_t, uint32_t>(times) << " : 64-bit" << endl;
+	cout << "    " << testQuantize_3D_Perf<uint32_t, uint16_t>(times) << " : 32-bit" << endl;
+}
+
+static void Sort_3D_Perf() {
+	cout << "++ Sorting the morton codes of a " << MAX << "^3 grid (linear, random order)" << endl;
+	cout << "    " << testSort_3D_Perf<uint64_t, uint32_t>(times) << " : 64-bit" << endl;
+	cout << "    " << testSort_3D_Perf<uint32_t, uint16_t>(times) << " : 32-bit" << endl;
+}
+
+static void External_Sort_Perf() {
+	cout << "++ Sorting a file of " << total << " points (" << total * 16 / (1 << 20) << " MB)" << endl;
+	cout << "    " << testExternalSort_Perf(times) << endl;
+}
+
+static void Octree_Perf() {
+	vector<uint64_t> linear, random;
+	linear.reserve(total);
+	random.reserve(total);
+	for (uint64_t i = 0; i < MAX; i++) {
+		for (uint64_t j = 0; j < MAX; j++) {
+			for (uint64_t k = 0; k < MAX; k++) {
+				linear.push_back(control_encode(i, j, k));
+			}
+		}
+	}
+	for (size_t i = 0; i < total; i++) {
+		random.push_back(control_encode(static_cast<uint64_t>(rand() % (1 << 21)), static_cast<uint64_t>(rand() % (1 << 21)), static_cast<uint64_t>(rand() % (1 << 21))));
+	}
+	sort(linear.begin(), linear.end());
+	sort(random.begin(), random.end());
+	cout << "++ Building the octree of " << total << " sorted codes (" << MAX << "^3 grid, random points)" << endl;
+	for (size_t max_points : { 1, 16, 256 }) {
+		cout << "    " << testOctree_Perf(linear, max_points, times) << " : grid, " << max_points << " points per leaf" << endl;
+		cout << "    " << testOctree_Perf(random, max_points, times) << " : random, " << max_points << " points per leaf" << endl;
+	}
+}
+
+static void Bvh_Perf() {
+	cout << "++ Building the BVH of " << total << " boxes (codes, sort, tree, boxes)" << endl;
+	cout << "    " << testBvh_Perf<uint64_t>(times) << " : 63-bit codes" << endl;
+	cout << "    " << testBvh_Perf<uint32_t>(times) << " : 30-bit codes" << endl;
+}
+
+static void Swizzle_Perf() {
+	cout << "++ Converting images from row-major to Z-order layout and back" << endl;
+	const size_t sizes[] = { 1, 2, 4, 8, 16 };
+	for (size_t size : sizes) {
+		cout << "    " << testSwizzle_Perf(size, times) << endl;
+	}
+}
+
+static void Grid_Perf() {
+	cout << "++ Visiting a morton grid in x-major order, and converting it from and to a row-major array" << endl;
+	cout << "    " << testGrid_Perf(times) << endl;
+}
+
+static void Compact_Perf() {
+	cout << "++ Encoding and decoding random cells of grids to compact Z-order indices, against morton codes" << endl;
+	cout << "    " << testCompact_Perf(1000, 1000, 300, times) << endl;
+	cout << "    " << testCompact_Perf(1024, 1024, 1024, times) << endl;
+}
+
+static void Parallel_Perf() {
+	const vector<unsigned int> threads = scalingThreads();
+	vector<unique_ptr<morton_thread_pool>> pools;
+	cout << "++ Batch methods on thread pools of size";
+	for (size_t t = 0; t < threads.size(); t++) {
+		pools.emplace_back(new morton_thread_pool(threads[t]));
+		cout << (t > 0 ? ", " : " ") << threads[t];
+	}
+	cout << ": " << total << " codes in one call, and in calls of " << SCALING_CALL_SIZE << " codes" << endl;
+	testParallel_3D_Scaling(pools, f3D_64_encode_batch, f3D_64_decode_batch, "3D 64-bit");
+	testParallel_3D_Scaling(pools, f3D_32_encode_batch, f3D_32_decode_batch, "3D 32-bit");
+	testParallel_2D_Scaling(pools, f2D_64_encode_batch, f2D_64_decode_batch, "2D 64-bit");
+	testParallel_2D_Scaling(pools, f2D_32_encode_batch, f2D_32_decode_batch, "2D 32-bit");
 }
 
 void printHeader(){
@@ -175,6 +361,10 @@ void printHeader(){
 #elif __GNUC__
 	cout << "++ Compiled using GCC" << endl;
 #endif
+#if LIBMORTON_RUNTIME_DISPATCH
+	cout << "++ Runtime dispatch: " << method_name(bound_method(morton_slot::m3D_64_encode))
+		<< " (batch: " << method_name(bound_batch_method()) << ")" << endl;
+#endif
 }
 
 #if _MSC_VER
@@ -313,11 +503,113 @@ void registerBMI2Functions() {
 	f3D_32_decode.push_back(decode_3D_32_wrapper("MortonND: BMI2", &MortonND_3D_32_BMI_Decode));
 	f2D_64_decode.push_back(decode_2D_64_wrapper("MortonND: BMI2", &MortonND_2D_64_BMI_Decode));
 	f2D_32_decode.push_back(decode_2D_32_wrapper("MortonND: BMI2", &MortonND_2D_32_BMI_Decode));
+
+	f3D_64_encode.push_back(encode_3D_64_wrapper("ND: BMI2", &ND_3D_Encode<uint_fast64_t, uint_fast32_t, &mND_e_BMI<3, uint_fast64_t, uint_fast32_t>>));
+	f3D_64_decode.push_back(decode_3D_64_wrapper("ND: BMI2", &ND_3D_Decode<uint_fast64_t, uint_fast32_t, &mND_d_BMI<3, uint_fast64_t, uint_fast32_t>>));
+	f2D_64_encode.push_back(encode_2D_64_wrapper("ND: BMI2", &ND_2D_Encode<uint_fast64_t, uint_fast32_t, &mND_e_BMI<2, uint_fast64_t, uint_fast32_t>>));
+	f2D_64_decode.push_back(decode_2D_64_wrapper("ND: BMI2", &ND_2D_Decode<uint_fast64_t, uint_fast32_t, &mND_d_BMI<2, uint_fast64_t, uint_fast32_t>>));
+	f4D_64_encode.push_back(encode_4D_64_wrapper("BMI2 instruction set", &mND_e_BMI<4, uint_fast64_t, uint_fast16_t>));
+	f4D_64_decode.push_back(decode_4D_64_wrapper("BMI2 instruction set", &mND_d_BMI<4, uint_fast64_t, uint_fast16_t>));
+	f5D_64_encode.push_back(encode_5D_64_wrapper("BMI2 instruction set", &mND_e_BMI<5, uint_fast64_t, uint_fast16_t>));
+	f5D_64_decode.push_back(decode_5D_64_wrapper("BMI2 instruction set", &mND_d_BMI<5, uint_fast64_t, uint_fast16_t>));
 }
 #else
 void registerBMI2Functions() { }
 #endif
 
+// Register the libmorton N-D methods: N = 2, 3 next to the 2D / 3D methods, and N = 4, 5
+void registerNDFunctions() {
+	f3D_64_encode.push_back(encode_3D_64_wrapper("ND: LUT", &ND_3D_Encode<uint_fast64_t, uint_fast32_t, &mND_e_LUT<3, uint_fast64_t, uint_fast32_t>>));
+	f3D_64_encode.push_back(encode_3D_64_wrapper("ND: Magicbits", &ND_3D_Encode<uint_fast64_t, uint_fast32_t, &mND_e_magicbits<3, uint_fast64_t, uint_fast32_t>>));
+	f3D_64_decode.push_back(decode_3D_64_wrapper("ND: LUT", &ND_3D_Decode<uint_fast64_t, uint_fast32_t, &mND_d_LUT<3, uint_fast64_t, uint_fast32_t>>));
+	f3D_64_decode.push_back(decode_3D_64_wrapper("ND: Magicbits", &ND_3D_Decode<uint_fast64_t, uint_fast32_t, &mND_d_magicbits<3, uint_fast64_t, uint_fast32_t>>));
+	f2D_64_encode.push_back(encode_2D_64_wrapper("ND: LUT", &ND_2D_Encode<uint_fast64_t, uint_fast32_t, &mND_e_LUT<2, uint_fast64_t, uint_fast32_t>>));
+	f2D_64_encode.push_back(encode_2D_64_wrapper("ND: Magicbits", &ND_2D_Encode<uint_fast64_t, uint_fast32_t, &mND_e_magicbits<2, uint_fast64_t, uint_fast32_t>>));
+	f2D_64_decode.push_back(decode_2D_64_wrapper("ND: LUT", &ND_2D_Decode<uint_fast64_t, uint_fast32_t, &mND_d_LUT<2, uint_fast64_t, uint_fast32_t>>));
+	f2D_64_decode.push_back(decode_2D_64_wrapper("ND: Magicbits", &ND_2D_Decode<uint_fast64_t, uint_fast32_t, &mND_d_magicbits<2, uint_fast64_t, uint_fast32_t>>));
+
+	f4D_64_encode.push_back(encode_4D_64_wrapper("LUT", &mND_e_LUT<4, uint_fast64_t, uint_fast16_t>));
+	f4D_64_encode.push_back(encode_4D_64_wrapper("Magicbits", &mND_e_magicbits<4, uint_fast64_t, uint_fast16_t>));
+	f4D_64_decode.push_back(decode_4D_64_wrapper("LUT", &mND_d_LUT<4, uint_fast64_t, uint_fast16_t>));
+	f4D_64_decode.push_back(decode_4D_64_wrapper("Magicbits", &mND_d_magicbits<4, uint_fast64_t, uint_fast16_t>));
+	f5D_64_encode.push_back(encode_5D_64_wrapper("LUT", &mND_e_LUT<5, uint_fast64_t, uint_fast16_t>));
+	f5D_64_encode.push_back(encode_5D_64_wrapper("Magicbits", &mND_e_magicbits<5, uint_fast64_t, uint_fast16_t>));
+	f5D_64_decode.push_back(decode_5D_64_wrapper("LUT", &mND_d_LUT<5, uint_fast64_t, uint_fast16_t>));
+	f5D_64_decode.push_back(decode_5D_64_wrapper("Magicbits", &mND_d_magicbits<5, uint_fast64_t, uint_fast16_t>));
+}
+
+#if LIBMORTON_HAS_UINT128
+// Register 128-bit methods if the compiler has a 128-bit integer
+void register128Functions() {
+	f3D_128_encode.push_back(encode_3D_128_wrapper("morton.h", &morton3D_128_encode));
+	f3D_128_encode.push_back(encode_3D_128_wrapper("LUT Shifted", &m3D_e_sLUT<morton128_t, uint_fast64_t>));
+	f3D_128_encode.push_back(encode_3D_128_wrapper("LUT", &m3D_e_LUT<morton128_t, uint_fast64_t>));
+	f3D_128_encode.push_back(encode_3D_128_wrapper("LUT Shifted ET", &m3D_e_sLUT_ET<morton128_t, uint_fast64_t>));
+	f3D_128_encode.push_back(encode_3D_128_wrapper("Magicbits", &m3D_e_magicbits<morton128_t, uint_fast64_t>));
+	f3D_128_decode.push_back(decode_3D_128_wrapper("morton.h", &morton3D_128_decode));
+	f3D_128_decode.push_back(decode_3D_128_wrapper("LUT Shifted", &m3D_d_sLUT<morton128_t, uint_fast64_t>));
+	f3D_128_decode.push_back(decode_3D_128_wrapper("LUT", &m3D_d_LUT<morton128_t, uint_fast64_t>));
+	f3D_128_decode.push_back(decode_3D_128_wrapper("LUT Shifted ET", &m3D_d_sLUT_ET<morton128_t, uint_fast64_t>));
+	f3D_128_decode.push_back(decode_3D_128_wrapper("Magicbits", &m3D_d_magicbits<morton128_t, uint_fast64_t>));
+	f2D_128_encode.push_back(encode_2D_128_wrapper("morton.h", &morton2D_128_encode));
+	f2D_128_encode.push_back(encode_2D_128_wrapper("LUT Shifted", &m2D_e_sLUT<morton128_t, uint_fast64_t>));
+	f2D_128_encode.push_back(encode_2D_128_wrapper("LUT", &m2D_e_LUT<morton128_t, uint_fast64_t>));
+	f2D_128_encode.push_back(encode_2D_128_wrapper("LUT Shifted ET", &m2D_e_sLUT_ET<morton128_t, uint_fast64_t>));
+	f2D_128_encode.push_back(encode_2D_128_wrapper("Magicbits", &m2D_e_magicbits<morton128_t, uint_fast64_t>));
+	f2D_128_decode.push_back(decode_2D_128_wrapper("morton.h", &morton2D_128_decode));
+	f2D_128_decode.push_back(decode_2D_128_wrapper("LUT Shifted", &m2D_d_sLUT<morton128_t, uint_fast64_t>));
+	f2D_128_decode.push_back(decode_2D_128_wrapper("LUT", &m2D_d_LUT<morton128_t, uint_fast64_t>));
+	f2D_128_decode.push_back(decode_2D_128_wrapper("LUT Shifted ET", &m2D_d_sLUT_ET<morton128_t, uint_fast64_t>));
+	f2D_128_decode.push_back(decode_2D_128_wrapper("Magicbits", &m2D_d_magicbits<morton128_t, uint_fast64_t>));
+#if defined(__BMI2__) || __AVX2__
+	f3D_128_encode.push_back(encode_3D_128_wrapper("BMI2 instruction set", &m3D_e_BMI<morton128_t, uint_fast64_t>));
+	f3D_128_decode.push_back(decode_3D_128_wrapper("BMI2 instruction set", &m3D_d_BMI<morton128_t, uint_fast64_t>));
+	f2D_128_encode.push_back(encode_2D_128_wrapper("BMI2 instruction set", &m2D_e_BMI<morton128_t, uint_fast64_t>));
+	f2D_128_decode.push_back(decode_2D_128_wrapper("BMI2 instruction set", &m2D_d_BMI<morton128_t, uint_fast64_t>));
+#endif
+#if defined(__PCLMUL__)
+	f2D_128_encode.push_back(encode_2D_128_wrapper("CLMUL instruction set", &m2D_e_CLMUL<morton128_t, uint_fast64_t>));
+#endif
+}
+
+void check128Methods() {
+	cout << "++ Checking 128-bit methods for correctness" << endl;
+	check3D_128_Correctness(f3D_128_encode, f3D_128_decode);
+	check2D_128_Correctness(f2D_128_encode, f2D_128_decode);
+}
+#else
+void register128Functions() { }
+void check128Methods() { }
+#endif
+
+#if defined(__PCLMUL__)
+// Register CLMUL methods if available
+void registerCLMULFunctions() {
+	f2D_64_encode.push_back(encode_2D_64_wrapper("CLMUL instruction set", &m2D_e_CLMUL<uint_fast64_t, uint_fast32_t>));
+	f2D_32_encode.push_back(encode_2D_32_wrapper("CLMUL instruction set", &m2D_e_CLMUL<uint_fast32_t, uint_fast16_t>));
+}
+#else
+void registerCLMULFunctions() { }
+#endif
+
+#if defined(__AVX2__)
+// Register AVX2 batch methods if available
+void registerAVX2Functions() {
+	f3D_64_encode_batch.push_back(encode_batch_3D_64_wrapper("AVX2 instruction set", &m3D_e_AVX2));
+	f3D_32_encode_batch.push_back(encode_batch_3D_32_wrapper("AVX2 instruction set", &m3D_e_AVX2));
+	f2D_64_encode_batch.push_back(encode_batch_2D_64_wrapper("AVX2 instruction set", &m2D_e_AVX2));
+	f2D_32_encode_batch.push_back(encode_batch_2D_32_wrapper("AVX2 instruction set", &m2D_e_AVX2));
+	f3D_64_decode_batch.push_back(decode_batch_3D_64_wrapper("AVX2 instruction set", &m3D_d_AVX2));
+	f3D_32_decode_batch.push_back(decode_batch_3D_32_wrapper("AVX2 instruction set", &m3D_d_AVX2));
+	f2D_64_decode_batch.push_back(decode_batch_2D_64_wrapper("AVX2 instruction set", &m2D_d_AVX2));
+	f2D_32_decode_batch.push_back(decode_batch_2D_32_wrapper("AVX2 instruction set", &m2D_d_AVX2));
+	f3D_64_neighbors_batch.push_back(neighbors_batch_3D_64_wrapper("AVX2 instruction set", &m3D_neighbors_AVX2));
+	f3D_32_neighbors_batch.push_back(neighbors_batch_3D_32_wrapper("AVX2 instruction set", &m3D_neighbors_AVX2));
+}
+#else
+void registerAVX2Functions() { }
+#endif
+
 // Register all the functions we want to be tested here!
 void registerFunctions() {
 	// Register 3D 64-bit encode functions
@@ -325,6 +617,9 @@ void registerFunctions() {
 	f3D_64_encode.push_back(encode_3D_64_wrapper("LUT Shifted", &m3D_e_sLUT<uint_fast64_t, uint_fast32_t>));
 //	f3D_64_encode.push_back(encode_3D_64_wrapper("LUT ET", &m3D_e_LUT_ET<uint_fast64_t, uint_fast32_t>));
 	f3D_64_encode.push_back(encode_3D_64_wrapper("LUT", &m3D_e_LUT<uint_fast64_t, uint_fast32_t>));
+	f3D_64_encode.push_back(encode_3D_64_wrapper("LUT Shifted (4-bit chunks)", &m3D_e_sLUT<uint_fast64_t, uint_fast32_t, 4>));
+	f3D_64_encode.push_back(encode_3D_64_wrapper("LUT Shifted (11-bit chunks)", &m3D_e_sLUT<uint_fast64_t, uint_fast32_t, 11>));
+	f3D_64_encode.push_back(encode_3D_64_wrapper("LUT Shifted (16-bit chunks)", &m3D_e_sLUT<uint_fast64_t, uint_fast32_t, 16>));
 //	f3D_64_encode.push_back(encode_3D_64_wrapper("Magicbits", &m3D_e_magicbits<uint_fast64_t, uint_fast32_t>));
 //	f3D_64_encode.push_back(encode_3D_64_wrapper("For ET", &m3D_e_for_ET<uint_fast64_t, uint_fast32_t>));
 //	f3D_64_encode.push_back(encode_3D_64_wrapper("For", &m3D_e_for<uint_fast64_t, uint_fast32_t>));
@@ -342,6 +637,7 @@ void registerFunctions() {
 	f3D_32_encode.push_back(encode_3D_32_wrapper("LUT", &m3D_e_LUT<uint_fast32_t, uint_fast16_t>));
 //	f3D_32_encode.push_back(encode_3D_32_wrapper("LUT ET", [](uint_fast16_t x, uint_fast16_t y, uint_fast16_t z) -> uint_fast32_t { return m3D_e_LUT_ET<uint_fast32_t, uint_fast32_t>(x, y, z); }));
 	f3D_32_encode.push_back(encode_3D_32_wrapper("LUT Shifted", &m3D_e_sLUT<uint_fast32_t, uint_fast16_t>));
+	f3D_32_encode.push_back(encode_3D_32_wrapper("LUT Shifted (exact width)", [](uint_fast16_t x, uint_fast16_t y, uint_fast16_t z) -> uint_fast32_t { return m3D_e_sLUT<uint32_t, uint16_t>(x, y, z); }));
 //	f3D_32_encode.push_back(encode_3D_32_wrapper("LUT Shifted ET", [](uint_fast16_t x, uint_fast16_t y, uint_fast16_t z) -> uint_fast32_t { return m3D_e_sLUT_ET<uint_fast32_t, uint_fast32_t>(x, y, z); }));
 
 	f3D_32_encode.push_back(encode_3D_32_wrapper(MortonNDLutDesc(MortonND_3D_32_5), &MortonND_3D_32_5_Encode));
@@ -358,6 +654,9 @@ void registerFunctions() {
 	f3D_64_decode.push_back(decode_3D_64_wrapper("LUT Shifted", &m3D_d_sLUT<uint_fast64_t, uint_fast32_t>));
 //	f3D_64_decode.push_back(decode_3D_64_wrapper("LUT ET", &m3D_d_LUT_ET<uint_fast64_t, uint_fast32_t>));
 	f3D_64_decode.push_back(decode_3D_64_wrapper("LUT", &m3D_d_LUT<uint_fast64_t, uint_fast32_t>));
+	f3D_64_decode.push_back(decode_3D_64_wrapper("LUT Shifted (6-bit chunks)", &m3D_d_sLUT<uint_fast64_t, uint_fast32_t, 6>));
+	f3D_64_decode.push_back(decode_3D_64_wrapper("LUT Shifted (12-bit chunks)", &m3D_d_sLUT<uint_fast64_t, uint_fast32_t, 12>));
+	f3D_64_decode.push_back(decode_3D_64_wrapper("LUT Shifted (15-bit chunks)", &m3D_d_sLUT<uint_fast64_t, uint_fast32_t, 15>));
 //	f3D_64_decode.push_back(decode_3D_64_wrapper("Magicbits", &m3D_d_magicbits<uint_fast64_t, uint_fast32_t>));
 //	f3D_64_decode.push_back(decode_3D_64_wrapper("For ET", &m3D_d_for_ET<uint_fast64_t, uint_fast32_t>));
 //	f3D_64_decode.push_back(decode_3D_64_wrapper("For", &m3D_d_for<uint_fast64_t, uint_fast32_t>));
@@ -369,6 +668,11 @@ void registerFunctions() {
 	f3D_32_decode.push_back(decode_3D_32_wrapper("LUT", &m3D_d_LUT<uint_fast32_t, uint_fast16_t>));
 //	f3D_32_decode.push_back(decode_3D_32_wrapper("LUT ET", &m3D_d_LUT_ET<uint_fast32_t, uint_fast16_t>));
 	f3D_32_decode.push_back(decode_3D_32_wrapper("LUT Shifted", &m3D_d_sLUT<uint_fast32_t, uint_fast16_t>));
+	f3D_32_decode.push_back(decode_3D_32_wrapper("LUT Shifted (exact width)", [](uint_fast32_t m, uint_fast16_t& x, uint_fast16_t& y, uint_fast16_t& z) {
+		uint16_t dx, dy, dz;
+		m3D_d_sLUT<uint32_t, uint16_t>(static_cast<uint32_t>(m), dx, dy, dz);
+		x = dx; y = dy; z = dz;
+	}));
 //	f3D_32_decode.push_back(decode_3D_32_wrapper("LUT Shifted ET", &m3D_d_sLUT_ET<uint_fast32_t, uint_fast16_t>));
 
 	// Register 2D 64-bit encode functions
@@ -389,6 +693,7 @@ void registerFunctions() {
 	f2D_32_encode.push_back(encode_2D_32_wrapper("LUT", &m2D_e_LUT<uint_fast32_t, uint_fast16_t>));
 //	f2D_32_encode.push_back(encode_2D_32_wrapper("LUT ET", &m2D_e_LUT_ET<uint_fast32_t, uint_fast16_t>));
 	f2D_32_encode.push_back(encode_2D_32_wrapper("LUT Shifted", &m2D_e_sLUT<uint_fast32_t, uint_fast16_t>));
+	f2D_32_encode.push_back(encode_2D_32_wrapper("LUT Shifted (exact width)", [](uint_fast16_t x, uint_fast16_t y) -> uint_fast32_t { return m2D_e_sLUT<uint32_t, uint16_t>(x, y); }));
 //	f2D_32_encode.push_back(encode_2D_32_wrapper("LUT Shifted ET", &m2D_e_sLUT_ET<uint_fast32_t, uint_fast16_t>));
 
 	f2D_32_encode.push_back(encode_2D_32_wrapper(MortonNDLutDesc(MortonND_2D_32_4), &MortonND_2D_32_4_Encode));
@@ -415,10 +720,104 @@ void registerFunctions() {
 //	f2D_32_decode.push_back(decode_2D_32_wrapper("LUT Shifted", &m2D_d_sLUT<uint_fast32_t, uint_fast16_t>));
 //	f2D_32_decode.push_back(decode_2D_32_wrapper("LUT Shifted ET", &m2D_d_sLUT_ET<uint_fast32_t, uint_fast16_t>));
 
+	// Register the morton.h stubs
+	f3D_64_encode.push_back(encode_3D_64_wrapper("morton.h", &morton3D_64_encode));
+	f3D_32_encode.push_back(encode_3D_32_wrapper("morton.h", &morton3D_32_encode));
+	f3D_64_decode.push_back(decode_3D_64_wrapper("morton.h", &morton3D_64_decode));
+	f3D_32_decode.push_back(decode_3D_32_wrapper("morton.h", &morton3D_32_decode));
+	f2D_64_encode.push_back(encode_2D_64_wrapper("morton.h", &morton2D_64_encode));
+	f2D_32_encode.push_back(encode_2D_32_wrapper("morton.h", &morton2D_32_encode));
+	f2D_64_decode.push_back(decode_2D_64_wrapper("morton.h", &morton2D_64_decode));
+	f2D_32_decode.push_back(decode_2D_32_wrapper("morton.h", &morton2D_32_decode));
+
+	// Register batch encode functions
+	f3D_64_encode_batch.push_back(encode_batch_3D_64_wrapper("morton.h", &morton3D_64_encode_batch));
+	f3D_32_encode_batch.push_back(encode_batch_3D_32_wrapper("morton.h", &morton3D_32_encode_batch));
+	f2D_64_encode_batch.push_back(encode_batch_2D_64_wrapper("morton.h", &morton2D_64_encode_batch));
+	f2D_32_encode_batch.push_back(encode_batch_2D_32_wrapper("morton.h", &morton2D_32_encode_batch));
+
+	// Register batch decode functions
+	f3D_64_decode_batch.push_back(decode_batch_3D_64_wrapper("morton.h", &morton3D_64_decode_batch));
+	f3D_32_decode_batch.push_back(decode_batch_3D_32_wrapper("morton.h", &morton3D_32_decode_batch));
+	f2D_64_decode_batch.push_back(decode_batch_2D_64_wrapper("morton.h", &morton2D_64_decode_batch));
+	f2D_32_decode_batch.push_back(decode_batch_2D_32_wrapper("morton.h", &morton2D_32_decode_batch));
+
+	// Register batch neighbors functions
+	f3D_64_neighbors_batch.push_back(neighbors_batch_3D_64_wrapper("Dilated arithmetic", &m3D_neighbors<uint64_t>));
+	f3D_32_neighbors_batch.push_back(neighbors_batch_3D_32_wrapper("Dilated arithmetic", &m3D_neighbors<uint32_t>));
+	f3D_64_neighbors_batch.push_back(neighbors_batch_3D_64_wrapper("morton.h", &morton3D_64_neighbors_batch));
+	f3D_32_neighbors_batch.push_back(neighbors_batch_3D_32_wrapper("morton.h", &morton3D_32_neighbors_batch));
+
 	registerBMI2Functions();
+	registerCLMULFunctions();
+	registerNDFunctions();
+	register128Functions();
+	registerAVX2Functions();
 	registerIfNotMSVC();
 }
 
+#if LIBMORTON_RUNTIME_DISPATCH
+// Check the morton.h stubs with every method the host CPU supports bound to them
+void checkDispatchedMethods() {
+	const morton_method methods[] = { morton_method::LUT, morton_method::sLUT, morton_method::LUT_ET, morton_method::sLUT_ET,
+		morton_method::magicbits, morton_method::BMI2, morton_method::CLMUL, morton_method::AVX2 };
+	const morton_method initial = bound_method(morton_slot::m3D_64_encode);
+	const morton_method initial_batch = bound_batch_method();
+	for (morton_method m : methods) {
+		if (!method_supported(m)) { continue; }
+		cout << "++ Checking morton.h stubs bound to " << method_name(m) << endl;
+		if (m == morton_method::AVX2) {
+			set_method(initial);
+			set_batch_method(m);
+		}
+		else {
+			set_method(m);
+			set_batch_method(morton_method::loop);
+		}
+		check3D_EncodeCorrectness<uint_fast64_t, uint_fast32_t, 64>({ encode_3D_64_wrapper("morton.h", &morton3D_64_encode) });
+		check3D_DecodeCorrectness<uint_fast32_t, uint_fast16_t, 32>({ decode_3D_32_wrapper("morton.h", &morton3D_32_decode) });
+		check2D_EncodeCorrectness<uint_fast32_t, uint_fast16_t, 32>({ encode_2D_32_wrapper("morton.h", &morton2D_32_encode) });
+		check2D_DecodeCorrectness<uint_fast64_t, uint_fast32_t, 64>({ decode_2D_64_wrapper("morton.h", &morton2D_64_decode) });
+		check3D_EncodeBatchCorrectness<uint32_t, uint16_t, 32>({ encode_batch_3D_32_wrapper("morton.h", &morton3D_32_encode_batch) });
+		check3D_DecodeBatchCorrectness<uint64_t, uint32_t, 64>({ decode_batch_3D_64_wrapper("morton.h", &morton3D_64_decode_batch) });
+		check3D_NeighborsBatchCorrectness<uint32_t, uint16_t, 32>({ neighbors_batch_3D_32_wrapper("morton.h", &morton3D_32_neighbors_batch) });
+	}
+	set_method(initial);
+	set_batch_method(initial_batch);
+}
+
+// Tune the morton.h stubs, and check the profile survives a save/load round trip
+void checkTuner() {
+	const morton_profile tuned = tune_methods();
+	cout << "++ Tuned methods:";
+	for (size_t slot = 0; slot < morton_slot_count; ++slot) {
+		cout << " " << slot_name(static_cast<morton_slot>(slot)) << "=" << method_name(tuned.methods[slot]);
+	}
+	cout << " batch=" << method_name(tuned.batch_method) << endl;
+
+	const char* path = "libmorton_profile.txt";
+	morton_profile loaded;
+	bool ok = save_profile(tuned, path) && load_profile(path, loaded) && bind_profile(loaded);
+	remove(path);
+	for (size_t slot = 0; slot < morton_slot_count; ++slot) {
+		ok &= loaded.methods[slot] == tuned.methods[slot] && bound_method(static_cast<morton_slot>(slot)) == tuned.methods[slot];
+	}
+	ok &= loaded.batch_method == tuned.batch_method && bound_batch_method() == tuned.batch_method;
+	// An empty sample keeps the binding
+	const morton_profile empty = tune_methods(nullptr, nullptr, nullptr, 0);
+	for (size_t slot = 0; slot < morton_slot_count; ++slot) {
+		ok &= empty.methods[slot] == tuned.methods[slot] && bound_method(static_cast<morton_slot>(slot)) == tuned.methods[slot];
+	}
+	ok &= empty.batch_method == tuned.batch_method && bound_batch_method() == tuned.batch_method;
+	cout << "++ Checking tuning profile save/load ... " << (ok ? "Passed." : "Failed.") << endl;
+	check3D_EncodeCorrectness<uint_fast64_t, uint_fast32_t, 64>({ encode_3D_64_wrapper("morton.h (tuned)", &morton3D_64_encode) });
+	check2D_DecodeCorrectness<uint_fast32_t, uint_fast16_t, 32>({ decode_2D_32_wrapper("morton.h (tuned)", &morton2D_32_decode) });
+}
+#else
+void checkDispatchedMethods() { }
+void checkTuner() { }
+#endif
+
 int main(int argc, char *argv[]) {
 	times = 1;
 	printHeader();
@@ -433,12 +832,104 @@ int main(int argc, char *argv[]) {
 	check3D_EncodeCorrectness<uint_fast32_t, uint_fast16_t, 32>(f3D_32_encode);
 	check3D_DecodeCorrectness<uint_fast64_t, uint_fast32_t, 64>(f3D_64_decode);
 	check3D_DecodeCorrectness<uint_fast32_t, uint_fast16_t, 32>(f3D_32_decode);
+	check3D_EncodeBatchCorrectness<uint64_t, uint32_t, 64>(f3D_64_encode_batch);
+	check3D_EncodeBatchCorrectness<uint32_t, uint16_t, 32>(f3D_32_encode_batch);
+	check3D_DecodeBatchCorrectness<uint64_t, uint32_t, 64>(f3D_64_decode_batch);
+	check3D_DecodeBatchCorrectness<uint32_t, uint16_t, 32>(f3D_32_decode_batch);
+	check3D_NeighborsBatchCorrectness<uint64_t, uint32_t, 64>(f3D_64_neighbors_batch);
+	check3D_NeighborsBatchCorrectness<uint32_t, uint16_t, 32>(f3D_32_neighbors_batch);
 
 	cout << "++ Checking 2D methods for correctness" << endl;
 	check2D_EncodeCorrectness<uint_fast64_t, uint_fast32_t, 64>(f2D_64_encode);
 	check2D_EncodeCorrectness<uint_fast32_t, uint_fast16_t, 32>(f2D_32_encode);
 	check2D_DecodeCorrectness<uint_fast64_t, uint_fast32_t, 64>(f2D_64_decode);
 	check2D_DecodeCorrectness<uint_fast32_t, uint_fast16_t, 32>(f2D_32_decode);
+	check2D_EncodeBatchCorrectness<uint64_t, uint32_t, 64>(f2D_64_encode_batch);
+	check2D_EncodeBatchCorrectness<uint32_t, uint16_t, 32>(f2D_32_encode_batch);
+	check2D_DecodeBatchCorrectness<uint64_t, uint32_t, 64>(f2D_64_decode_batch);
+	check2D_DecodeBatchCorrectness<uint32_t, uint16_t, 32>(f2D_32_decode_batch);
+
+	cout << "++ Checking N-D methods for correctness" << endl;
+	checkND_EncodeCorrectness<4, uint_fast64_t, uint_fast16_t, 64>(f4D_64_encode);
+	checkND_DecodeCorrectness<4, uint_fast64_t, uint_fast16_t, 64>(f4D_64_decode);
+	checkND_EncodeCorrectness<5, uint_fast64_t, uint_fast16_t, 64>(f5D_64_encode);
+	checkND_DecodeCorrectness<5, uint_fast64_t, uint_fast16_t, 64>(f5D_64_decode);
+
+	cout << "++ Checking dilated arithmetic for correctness" << endl;
+	checkDilatedCorrectness<3, uint64_t, uint32_t, 64>();
+	checkDilatedCorrectness<3, uint32_t, uint16_t, 32>();
+	checkDilatedCorrectness<2, uint64_t, uint32_t, 64>();
+	checkDilatedCorrectness<2, uint32_t, uint16_t, 32>();
+
+	cout << "++ Checking tree navigation for correctness" << endl;
+	checkTreeCorrectness<3, uint64_t, 64>();
+	checkTreeCorrectness<3, uint32_t, 32>();
+	checkTreeCorrectness<2, uint64_t, 64>();
+	checkTreeCorrectness<2, uint32_t, 32>();
+#if LIBMORTON_HAS_UINT128
+	checkTreeCorrectness<3, libmorton::morton128_t, 126>();
+	checkTreeCorrectness<2, libmorton::morton128_t, 128>();
+#endif
+
+	cout << "++ Checking box queries for correctness" << endl;
+	checkQueryCorrectness<3, uint64_t, uint32_t, 64>();
+	checkQueryCorrectness<3, uint32_t, uint16_t, 32>();
+	checkQueryCorrectness<2, uint64_t, uint32_t, 64>();
+	checkQueryCorrectness<2, uint32_t, uint16_t, 32>();
+	checkRangesCorrectness<3, uint64_t, uint32_t, 64>();
+	checkRangesCorrectness<3, uint32_t, uint16_t, 32>();
+	checkRangesCorrectness<2, uint64_t, uint32_t, 64>();
+	checkRangesCorrectness<2, uint32_t, uint16_t, 32>();
+
+	cout << "++ Checking quantized encoding for correctness" << endl;
+	checkQuantizeCorrectness<3, uint64_t, float, 64>();
+	checkQuantizeCorrectness<3, uint64_t, double, 64>();
+	checkQuantizeCorrectness<3, uint32_t, float, 32>();
+	checkQuantizeCorrectness<2, uint64_t, double, 64>();
+	checkQuantizeCorrectness<2, uint32_t, float, 32>();
+
+	cout << "++ Checking order-preserving encoding for correctness" << endl;
+	checkOrderedCorrectness<2, uint64_t, float>("float");
+	checkOrderedCorrectness<3, uint64_t, float>("float");
+	checkOrderedCorrectness<2, uint64_t, double>("double");
+	checkOrderedCorrectness<3, uint64_t, int16_t>("int16_t");
+	checkOrderedCorrectness<2, uint32_t, int16_t>("int16_t");
+	checkOrderedCorrectness<3, uint32_t, int32_t>("int32_t");
+#if LIBMORTON_HAS_UINT128
+	checkOrderedCorrectness<3, morton128_t, float>("float");
+	checkOrderedCorrectness<2, morton128_t, double>("double");
+	checkOrderedCorrectness<2, morton128_t, int64_t>("int64_t");
+#endif
+
+	cout << "++ Checking radix sort for correctness" << endl;
+	checkSortCorrectness<uint64_t, 64>();
+	checkSortCorrectness<uint32_t, 32>();
+
+	cout << "++ Checking parallel batch methods for correctness" << endl;
+	checkParallelCorrectness();
+
+	cout << "++ Checking external sort for correctness" << endl;
+	checkExternalSortCorrectness();
+
+	cout << "++ Checking octree build for correctness" << endl;
+	checkOctreeCorrectness();
+
+	cout << "++ Checking BVH build for correctness" << endl;
+	checkBvhCorrectness();
+
+	cout << "++ Checking image swizzle for correctness" << endl;
+	checkSwizzleCorrectness();
+
+	cout << "++ Checking morton grid for correctness" << endl;
+	checkGridCorrectness();
+
+	cout << "++ Checking compact Z-order for correctness" << endl;
+	checkCompactCorrectness();
+
+	check128Methods();
+
+	checkDispatchedMethods();
+	checkTuner();
 	
 	cout << "++ Running each performance test " << times << " times and averaging results" << endl;
 	for (int i = 128; i <= 512; i = i * 2){
@@ -446,6 +937,19 @@ int main(int argc, char *argv[]) {
 		total = MAX*MAX*MAX;
 		Encode_3D_Perf();
 		Decode_3D_Perf();
+		Neighbors_3D_Perf();
+		// These keep several copies of every position or code around: skip the largest grids
+		if (total <= (size_t(1) << 24)) {
+			Quantize_3D_Perf();
+			Sort_3D_Perf();
+			Parallel_Perf();
+			External_Sort_Perf();
+			Octree_Perf();
+			Bvh_Perf();
+			Swizzle_Perf();
+			Grid_Perf();
+			Compact_Perf();
+		}
 		printRunningSums();
 	}
 }
@@ -13,6 +13,10 @@
 #include <limits>
 #include <valarray>
 #include <functional>
+#include <array>
+#include <utility>
+#include <algorithm>
+#include <memory>
 
 // Load utils
 #include "util.h"
@@ -23,6 +27,22 @@
 #include "../libmorton/include/morton2D.h"
 #include "../libmorton/include/morton3D.h"
 #include "../libmorton/include/morton.h"
+#include "../libmorton/include/mortonND.h"
+#include "../libmorton/include/morton_dilated.h"
+#include "../libmorton/include/morton_neighbors.h"
+#include "../libmorton/include/morton_query.h"
+#include "../libmorton/include/morton_tree.h"
+#include "../libmorton/include/morton_octree.h"
+#include "../libmorton/include/morton_bvh.h"
+#include "../libmorton/include/morton_swizzle.h"
+#include "../libmorton/include/morton_grid.h"
+#include "../libmorton/include/morton_compact.h"
+#include "../libmorton/include/morton_sort.h"
+#include "../libmorton/include/morton_parallel.h"
+#include "../libmorton/include/morton_external_sort.h"
+#include "../libmorton/include/morton_quantize.h"
+#include "../libmorton/include/morton_ordered.h"
+#include "../libmorton/include/morton_tuner.h"
 #include <morton-nd/mortonND_LUT.h>
 #include <morton-nd/mortonND_BMI2.h>
 
@@ -69,6 +89,85 @@ typedef encode_f_3D_wrapper<uint_fast32_t, uint_fast16_t> encode_3D_32_wrapper;
 typedef decode_f_3D_wrapper<uint_fast64_t, uint_fast32_t> decode_3D_64_wrapper;
 typedef decode_f_3D_wrapper<uint_fast32_t, uint_fast16_t> decode_3D_32_wrapper;
 
+template <size_t N, typename morton, typename coord>
+struct encode_f_ND_wrapper {
+	string description;
+	morton (*encode)(const std::array<coord, N>&);
+	encode_f_ND_wrapper(string description, morton(*encode)(const std::array<coord, N>&)) : description(description), encode(encode) {}
+	encode_f_ND_wrapper() : description(""), encode(0) {}
+};
+
+template <size_t N, typename morton, typename coord>
+struct decode_f_ND_wrapper {
+	string description;
+	void (*decode)(morton, std::array<coord, N>&);
+	decode_f_ND_wrapper(string description, void(*decode)(morton, std::array<coord, N>&)) : description(description), decode(decode) {}
+	decode_f_ND_wrapper() : description(""), decode(0) {}
+};
+
+typedef encode_f_ND_wrapper<4, uint_fast64_t, uint_fast16_t> encode_4D_64_wrapper;
+typedef decode_f_ND_wrapper<4, uint_fast64_t, uint_fast16_t> decode_4D_64_wrapper;
+typedef encode_f_ND_wrapper<5, uint_fast64_t, uint_fast16_t> encode_5D_64_wrapper;
+typedef decode_f_ND_wrapper<5, uint_fast64_t, uint_fast16_t> decode_5D_64_wrapper;
+
+#if LIBMORTON_HAS_UINT128
+typedef encode_f_2D_wrapper<libmorton::morton128_t, uint_fast64_t> encode_2D_128_wrapper;
+typedef decode_f_2D_wrapper<libmorton::morton128_t, uint_fast64_t> decode_2D_128_wrapper;
+typedef encode_f_3D_wrapper<libmorton::morton128_t, uint_fast64_t> encode_3D_128_wrapper;
+typedef decode_f_3D_wrapper<libmorton::morton128_t, uint_fast64_t> decode_3D_128_wrapper;
+#endif
+
+template <typename morton, typename coord>
+struct encode_batch_f_2D_wrapper {
+	string description;
+	void(*encode)(const coord*, const coord*, morton*, size_t);
+	encode_batch_f_2D_wrapper(string description, void(*encode)(const coord*, const coord*, morton*, size_t)) : description(description), encode(encode) {}
+	encode_batch_f_2D_wrapper() : description(""), encode(0) {}
+};
+
+template <typename morton, typename coord>
+struct encode_batch_f_3D_wrapper {
+	string description;
+	void(*encode)(const coord*, const coord*, const coord*, morton*, size_t);
+	encode_batch_f_3D_wrapper(string description, void(*encode)(const coord*, const coord*, const coord*, morton*, size_t)) : description(description), encode(encode) {}
+	encode_batch_f_3D_wrapper() : description(""), encode(0) {}
+};
+
+template <typename morton, typename coord>
+struct decode_batch_f_2D_wrapper {
+	string description;
+	void(*decode)(const morton*, coord*, coord*, size_t);
+	decode_batch_f_2D_wrapper(string description, void(*decode)(const morton*, coord*, coord*, size_t)) : description(description), decode(decode) {}
+	decode_batch_f_2D_wrapper() : description(""), decode(0) {}
+};
+
+template <typename morton, typename coord>
+struct decode_batch_f_3D_wrapper {
+	string description;
+	void(*decode)(const morton*, coord*, coord*, coord*, size_t);
+	decode_batch_f_3D_wrapper(string description, void(*decode)(const morton*, coord*, coord*, coord*, size_t)) : description(description), decode(decode) {}
+	decode_batch_f_3D_wrapper() : description(""), decode(0) {}
+};
+
+template <typename morton>
+struct neighbors_batch_f_3D_wrapper {
+	string description;
+	void(*neighbors)(const morton*, size_t, libmorton::morton_stencil, morton, morton*, uint32_t*);
+	neighbors_batch_f_3D_wrapper(string description, void(*neighbors)(const morton*, size_t, libmorton::morton_stencil, morton, morton*, uint32_t*)) : description(description), neighbors(neighbors) {}
+	neighbors_batch_f_3D_wrapper() : description(""), neighbors(0) {}
+};
+
+typedef encode_batch_f_2D_wrapper<uint64_t, uint32_t> encode_batch_2D_64_wrapper;
+typedef encode_batch_f_2D_wrapper<uint32_t, uint16_t> encode_batch_2D_32_wrapper;
+typedef encode_batch_f_3D_wrapper<uint64_t, uint32_t> encode_batch_3D_64_wrapper;
+typedef encode_batch_f_3D_wrapper<uint32_t, uint16_t> encode_batch_3D_32_wrapper;
+typedef decode_batch_f_2D_wrapper<uint64_t, uint32_t> decode_batch_2D_64_wrapper;
+typedef decode_batch_f_2D_wrapper<uint32_t, uint16_t> decode_batch_2D_32_wrapper;
+typedef decode_batch_f_3D_wrapper<uint64_t, uint32_t> decode_batch_3D_64_wrapper;
+typedef decode_batch_f_3D_wrapper<uint32_t, uint16_t> decode_batch_3D_32_wrapper;
+typedef neighbors_batch_f_3D_wrapper<uint64_t> neighbors_batch_3D_64_wrapper;
+typedef neighbors_batch_f_3D_wrapper<uint32_t> neighbors_batch_3D_32_wrapper;
+
 template<std::size_t FieldCount>
 uint64_t split_by_n(uint64_t input, size_t bitsRemaining) {
 	return (bitsRemaining == 0) ? input : (split_by_n<FieldCount>(input >> 1, bitsRemaining - 1) << FieldCount) | (input & (uint64_t)1);
@@ -117,6 +216,24 @@ void control_decode(uint64_t encoding, T&... fields) {
 	return control_decode_impl<sizeof...(fields)>(encoding, std::numeric_limits<uint64_t>::digits / sizeof...(fields), list);
 }
 
+#if LIBMORTON_HAS_UINT128
+/**
+ * Runtime Morton encoding into 128-bit codes, one bit at a time. Only the first floor(128 / |fields|) bits will be encoded from each field.
+ */
+template<typename...T>
+libmorton::morton128_t control_encode_128(T... fields) {
+	const uint64_t list[] = { static_cast<uint64_t>(fields)... };
+	const size_t count = sizeof...(fields);
+	libmorton::morton128_t encoding = 0;
+	for (size_t bit = 0; bit < 128 / count; bit++) {
+		for (size_t field = 0; field < count; field++) {
+			encoding |= static_cast<libmorton::morton128_t>((list[field] >> bit) & 1) << (bit * count + field);
+		}
+	}
+	return encoding;
+}
+#endif
+
 template <typename valtype>
 inline string getBitString(valtype val) {
 	// bitset needs size to be known at runtime, and introducing boost dependency
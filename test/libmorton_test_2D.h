@@ -46,6 +46,44 @@ static bool check2D_EncodeFunction(const encode_f_2D_wrapper<morton, coord> &fun
 	return everything_okay;
 }
 
+// Check a 2D Batch Encode Function for correctness
+template <typename morton, typename coord, size_t bits>
+static bool check2D_EncodeBatchFunction(const encode_batch_f_2D_wrapper<morton, coord> &function) {
+
+	// Number of bits which can be encoded for each field
+	static const size_t fieldbits = bits / 2;
+
+	static_assert(bits <= std::numeric_limits<uint64_t>::digits, "Control encoder cannot support > 64 bits.");
+	static_assert(fieldbits >= 4, "At least 4 bits from each field must fit into 'morton'");
+
+	bool everything_okay = true;
+	vector<coord> x, y;
+
+	// Same coordinates as check2D_EncodeFunction, but encoded in a single call.
+	// The amount of tuples (256 per offset) is followed by one extra tuple, so the scalar tail gets tested as well
+	for (size_t offset = 0; offset <= fieldbits - 4; offset++) {
+		for (coord i = 0; i < 16; i++) {
+			for (coord j = 0; j < 16; j++) {
+				x.push_back(i << offset);
+				y.push_back(j << offset);
+			}
+		}
+	}
+	x.push_back(1); y.push_back(2);
+
+	vector<morton> computed_codes(x.size());
+	function.encode(x.data(), y.data(), computed_codes.data(), x.size());
+	for (size_t i = 0; i < x.size(); i++) {
+		morton correct_code = (morton)control_encode(x[i], y[i]);
+		if (computed_codes[i] != correct_code) {
+			everything_okay = false;
+			cout << endl << "    Incorrect encoding of (" << x[i] << ", " << y[i] << ") in method " << function.description.c_str() << ": " << computed_codes[i] <<
+				" != " << correct_code << endl;
+		}
+	}
+	return everything_okay;
+}
+
 // Check a 2D Decode Function for correctness
 template <typename morton, typename coord, size_t bits>
 static bool check2D_DecodeFunction(const decode_f_2D_wrapper<morton, coord> &function) {
@@ -94,6 +132,43 @@ static bool check2D_DecodeFunction(const decode_f_2D_wrapper<morton, coord> &fun
 	return everything_okay;
 }
 
+// Check a 2D Batch Decode Function for correctness
+template <typename morton, typename coord, size_t bits>
+static bool check2D_DecodeBatchFunction(const decode_batch_f_2D_wrapper<morton, coord> &function) {
+
+	// Number of bits usable by the encoding
+	static const size_t encodingbits = (bits / 2) * 2;
+
+	static_assert(bits <= std::numeric_limits<uint64_t>::digits, "Control decoder cannot support > 64 bits.");
+	static_assert(encodingbits >= 8, "'morton' must support at least 8 bit encodings");
+
+	bool everything_okay = true;
+	uint64_t xctrl, yctrl;
+	vector<morton> encodings;
+
+	// Same encodings as check2D_DecodeFunction, but decoded in a single call
+	for (size_t offset = 0; offset <= encodingbits - 8; offset++) {
+		for (morton i = 0; i < 256; i++) {
+			encodings.push_back(i << offset);
+		}
+	}
+	encodings.push_back((morton)0xffffffff);
+	if (encodingbits >= 64) {
+		encodings.push_back((morton)0xffffffffffffffff);
+	}
+
+	vector<coord> x(encodings.size()), y(encodings.size());
+	function.decode(encodings.data(), x.data(), y.data(), encodings.size());
+	for (size_t i = 0; i < encodings.size(); i++) {
+		control_decode(encodings[i], xctrl, yctrl);
+		if (x[i] != (coord)xctrl || y[i] != (coord)yctrl) {
+			printIncorrectDecoding2D<morton, coord>(function.description, encodings[i], x[i], y[i], (coord)xctrl, (coord)yctrl);
+			everything_okay = false;
+		}
+	}
+	return everything_okay;
+}
+
 template <typename morton, typename coord, size_t bits>
 inline void check2D_EncodeCorrectness(std::vector<encode_f_2D_wrapper<morton, coord>> encoders) {
 	printf("++ Checking correctness of 2D encoders (%lu bit) methods ... ", bits);
@@ -104,6 +179,16 @@ inline void check2D_EncodeCorrectness(std::vector<encode_f_2D_wrapper<morton, co
 	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
 }
 
+template <typename morton, typename coord, size_t bits>
+inline void check2D_EncodeBatchCorrectness(std::vector<encode_batch_f_2D_wrapper<morton, coord>> encoders) {
+	printf("++ Checking correctness of 2D batch encoders (%lu bit) methods ... ", bits);
+	bool ok = true;
+	for (auto it = encoders.begin(); it != encoders.end(); it++) {
+		ok &= check2D_EncodeBatchFunction<morton, coord, bits>(*it);
+	}
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
 template <typename morton, typename coord, size_t bits>
 inline void check2D_DecodeCorrectness(std::vector<decode_f_2D_wrapper<morton, coord>> decoders) {
 	printf("++ Checking correctness of 2D decoding (%lu bit) methods ... ", bits);
@@ -114,6 +199,51 @@ inline void check2D_DecodeCorrectness(std::vector<decode_f_2D_wrapper<morton, co
 	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
 }
 
+template <typename morton, typename coord, size_t bits>
+inline void check2D_DecodeBatchCorrectness(std::vector<decode_batch_f_2D_wrapper<morton, coord>> decoders) {
+	printf("++ Checking correctness of 2D batch decoding (%lu bit) methods ... ", bits);
+	bool ok = true;
+	for (auto it = decoders.begin(); it != decoders.end(); it++) {
+		ok &= check2D_DecodeBatchFunction<morton, coord, bits>(*it);
+	}
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
+#if LIBMORTON_HAS_UINT128
+// Check 2D 128-bit encoders against the control encoder, and decoders on the control encodings
+inline void check2D_128_Correctness(std::vector<encode_2D_128_wrapper> encoders, std::vector<decode_2D_128_wrapper> decoders) {
+	printf("++ Checking correctness of 2D encoders/decoders (128 bit) methods ... ");
+	static const size_t fieldbits = 64;
+	bool ok = true;
+
+	// For every set of 4 contiguous bits, test all possible values (0-15), with all other bits cleared
+	for (size_t offset = 0; offset <= fieldbits - 4; offset++) {
+		for (uint_fast64_t i = 0; i < 16; i++) {
+			for (uint_fast64_t j = 0; j < 16; j++) {
+				const uint_fast64_t x = i << offset, y = j << offset;
+				const libmorton::morton128_t correct_code = control_encode_128(x, y);
+				for (auto it = encoders.begin(); it != encoders.end(); it++) {
+					if (it->encode(x, y) != correct_code) {
+						cout << endl << "    Incorrect encoding of (" << x << ", " << y << ") in method " << it->description.c_str() << endl;
+						ok = false;
+					}
+				}
+				for (auto it = decoders.begin(); it != decoders.end(); it++) {
+					uint_fast64_t dx, dy;
+					it->decode(correct_code, dx, dy);
+					if (dx != x || dy != y) {
+						cout << endl << "    Incorrect decoding of (" << x << ", " << y << ") in method " << it->description.c_str() << ": ("
+							<< dx << ", " << dy << ")" << endl;
+						ok = false;
+					}
+				}
+			}
+		}
+	}
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+#endif
+
 template <typename morton, typename coord>
 static double testEncode_2D_Linear_Perf(morton(*function)(coord, coord), size_t times) {
 	Timer timer = Timer();
@@ -49,6 +49,47 @@ static bool check3D_EncodeFunction(const encode_f_3D_wrapper<morton, coord> &fun
 	return everything_okay;
 }
 
+// Check a 3D Batch Encode Function for correctness
+template <typename morton, typename coord, size_t bits>
+static bool check3D_EncodeBatchFunction(const encode_batch_f_3D_wrapper<morton, coord> &function) {
+
+	// Number of bits which can be encoded for each field
+	static const size_t fieldbits = bits / 3;
+
+	static_assert(bits <= std::numeric_limits<uint64_t>::digits, "Control encoder cannot support > 64 bits.");
+	static_assert(fieldbits >= 4, "At least 4 bits from each field must fit into 'morton'");
+
+	bool everything_okay = true;
+	vector<coord> x, y, z;
+
+	// Same coordinates as check3D_EncodeFunction, but encoded in a single call.
+	// The amount of tuples (4096 per offset) is followed by one extra tuple, so the scalar tail gets tested as well
+	for (size_t offset = 0; offset <= fieldbits - 4; offset++) {
+		for (coord i = 0; i < 16; i++) {
+			for (coord j = 0; j < 16; j++) {
+				for (coord k = 0; k < 16; k++) {
+					x.push_back(i << offset);
+					y.push_back(j << offset);
+					z.push_back(k << offset);
+				}
+			}
+		}
+	}
+	x.push_back(1); y.push_back(2); z.push_back(3);
+
+	vector<morton> computed_codes(x.size());
+	function.encode(x.data(), y.data(), z.data(), computed_codes.data(), x.size());
+	for (size_t i = 0; i < x.size(); i++) {
+		morton correct_code = (morton)control_encode(x[i], y[i], z[i]);
+		if (computed_codes[i] != correct_code) {
+			everything_okay = false;
+			cout << endl << "    Incorrect encoding of (" << x[i] << ", " << y[i] << ", " << z[i] << ") in method " << function.description.c_str() << ": " << computed_codes[i] <<
+				" != " << correct_code << endl;
+		}
+	}
+	return everything_okay;
+}
+
 // Check a 3D Decode Function for correctness
 template <typename morton, typename coord, size_t bits>
 static bool check3D_DecodeFunction(const decode_f_3D_wrapper<morton, coord> &function) {
@@ -97,6 +138,109 @@ static bool check3D_DecodeFunction(const decode_f_3D_wrapper<morton, coord> &fun
 	return everything_okay;
 }
 
+// Check a 3D Batch Decode Function for correctness
+template <typename morton, typename coord, size_t bits>
+static bool check3D_DecodeBatchFunction(const decode_batch_f_3D_wrapper<morton, coord> &function) {
+
+	// Number of bits usable by the encoding
+	static const size_t encodingbits = (bits / 3) * 3;
+
+	static_assert(bits <= std::numeric_limits<uint64_t>::digits, "Control decoder cannot support > 64 bits.");
+	static_assert(encodingbits >= 12, "'morton' must support at least 12 bit encodings");
+
+	bool everything_okay = true;
+	uint64_t xctrl, yctrl, zctrl;
+	vector<morton> encodings;
+
+	// Same encodings as check3D_DecodeFunction, but decoded in a single call
+	for (size_t offset = 0; offset <= encodingbits - 12; offset++) {
+		for (morton i = 0; i < 4096; i++) {
+			encodings.push_back(i << offset);
+		}
+	}
+	encodings.push_back((morton)0x3fffffff);
+	if (encodingbits >= 63) {
+		encodings.push_back((morton)0x7fffffffffffffff);
+	}
+
+	vector<coord> x(encodings.size()), y(encodings.size()), z(encodings.size());
+	function.decode(encodings.data(), x.data(), y.data(), z.data(), encodings.size());
+	for (size_t i = 0; i < encodings.size(); i++) {
+		control_decode(encodings[i], xctrl, yctrl, zctrl);
+		if (x[i] != (coord)xctrl || y[i] != (coord)yctrl || z[i] != (coord)zctrl) {
+			printIncorrectDecoding3D<morton, coord>(function.description, encodings[i], x[i], y[i], z[i], (coord)xctrl, (coord)yctrl, (coord)zctrl);
+			everything_okay = false;
+		}
+	}
+	return everything_okay;
+}
+
+// Check a 3D batch Neighbors function for correctness, in the whole coordinate range and in a small domain
+template <typename morton, typename coord, size_t bits>
+static bool check3D_NeighborsBatchFunction(const neighbors_batch_f_3D_wrapper<morton> &function) {
+
+	// Number of bits which can be encoded for each field
+	static const size_t fieldbits = bits / 3;
+	static const uint64_t fieldmax = (uint64_t(1) << fieldbits) - 1;
+	const libmorton::morton_stencil stencils[3] = { libmorton::morton_stencil::face, libmorton::morton_stencil::edge, libmorton::morton_stencil::corner };
+
+	bool everything_okay = true;
+	for (int domain = 0; domain < 2; domain++) {
+		// Every combination of the coordinates at and next to the boundaries, plus some in between
+		const uint64_t size[3] = { domain ? 5 : fieldmax + 1, domain ? 7 : fieldmax + 1, domain ? 1 : fieldmax + 1 };
+		const morton max_code = domain ? (morton)control_encode(size[0] - 1, size[1] - 1, size[2] - 1) : (morton)~0;
+		vector<uint64_t> values[3];
+		for (int axis = 0; axis < 3; axis++) {
+			const uint64_t candidates[6] = { 0, 1, 2, size[axis] / 3, size[axis] - 2, size[axis] - 1 };
+			for (uint64_t c : candidates) {
+				if (c < size[axis] && std::find(values[axis].begin(), values[axis].end(), c) == values[axis].end()) { values[axis].push_back(c); }
+			}
+		}
+		vector<morton> codes;
+		for (uint64_t z : values[2]) {
+			for (uint64_t y : values[1]) {
+				for (uint64_t x : values[0]) {
+					codes.push_back((morton)control_encode(x, y, z));
+				}
+			}
+		}
+
+		const size_t n = codes.size();
+		for (libmorton::morton_stencil stencil : stencils) {
+			const unsigned int k = static_cast<unsigned int>(stencil);
+			vector<morton> out(k * n);
+			vector<uint32_t> valid(n);
+			function.neighbors(codes.data(), n, stencil, max_code, out.data(), valid.data());
+			for (size_t i = 0; i < n; i++) {
+				uint64_t c[3];
+				control_decode(codes[i], c[0], c[1], c[2]);
+				uint32_t correct_valid = 0;
+				for (unsigned int j = 0; j < k; j++) {
+					int d[3];
+					libmorton::m3D_neighbor_offset(j, d[0], d[1], d[2]);
+					uint64_t nc[3];
+					bool inside = true;
+					for (int axis = 0; axis < 3; axis++) {
+						nc[axis] = (c[axis] + d[axis]) & fieldmax;
+						inside &= (d[axis] >= 0 || c[axis] > 0) && (d[axis] <= 0 || c[axis] + 1 < size[axis]);
+					}
+					correct_valid |= (inside ? 1u : 0u) << j;
+					const morton correct = (morton)control_encode(nc[0], nc[1], nc[2]);
+					if (out[j * n + i] != correct) {
+						everything_okay = false;
+						cout << endl << "    Incorrect neighbor " << j << " of " << codes[i] << " in method " << function.description.c_str() << ": " << out[j * n + i] << " != " << correct << endl;
+					}
+				}
+				if (valid[i] != correct_valid) {
+					everything_okay = false;
+					cout << endl << "    Incorrect valid neighbors of " << codes[i] << " in method " << function.description.c_str() << ": " << valid[i] << " != " << correct_valid << endl;
+				}
+			}
+		}
+	}
+	return everything_okay;
+}
+
 // Check a 3D Encode/Decode function for correct encode-decode process
 template<typename morton, typename coord, size_t bits>
 inline bool check3D_Match(const encode_f_3D_wrapper<morton, coord> &encode, decode_f_3D_wrapper<morton, coord> &decode, unsigned int times) {
@@ -146,6 +290,36 @@ inline void check3D_DecodeCorrectness(std::vector<decode_f_3D_wrapper<morton, co
 	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
 }
 
+template <typename morton, typename coord, size_t bits>
+inline void check3D_EncodeBatchCorrectness(std::vector<encode_batch_f_3D_wrapper<morton, coord>> encoders) {
+	printf("++ Checking correctness of 3D batch encoders (%lu bit) methods ... ", bits);
+	bool ok = true;
+	for (auto it = encoders.begin(); it != encoders.end(); it++) {
+		ok &= check3D_EncodeBatchFunction<morton, coord, bits>(*it);
+	}
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
+template <typename morton, typename coord, size_t bits>
+inline void check3D_DecodeBatchCorrectness(std::vector<decode_batch_f_3D_wrapper<morton, coord>> decoders) {
+	printf("++ Checking correctness of 3D batch decoding (%lu bit) methods ... ", bits);
+	bool ok = true;
+	for (auto it = decoders.begin(); it != decoders.end(); it++) {
+		ok &= check3D_DecodeBatchFunction<morton, coord, bits>(*it);
+	}
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
+template <typename morton, typename coord, size_t bits>
+inline void check3D_NeighborsBatchCorrectness(std::vector<neighbors_batch_f_3D_wrapper<morton>> functions) {
+	printf("++ Checking correctness of 3D batch neighbors (%lu bit) methods ... ", bits);
+	bool ok = true;
+	for (auto it = functions.begin(); it != functions.end(); it++) {
+		ok &= check3D_NeighborsBatchFunction<morton, coord, bits>(*it);
+	}
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
 template <typename morton, typename coord, size_t bits>
 inline void check3D_EncodeDecodeMatch(std::vector<encode_f_3D_wrapper<morton, coord>> encoders, std::vector<decode_f_3D_wrapper<morton, coord>> decoders, unsigned int times) {
 	printf("++ Checking 3D methods (%lu bit) encode/decode match ... ", bits);
@@ -158,6 +332,43 @@ inline void check3D_EncodeDecodeMatch(std::vector<encode_f_3D_wrapper<morton, co
 	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
 }
 
+#if LIBMORTON_HAS_UINT128
+// Check 3D 128-bit encoders against the control encoder, and decoders on the control encodings
+inline void check3D_128_Correctness(std::vector<encode_3D_128_wrapper> encoders, std::vector<decode_3D_128_wrapper> decoders) {
+	printf("++ Checking correctness of 3D encoders/decoders (128 bit) methods ... ");
+	static const size_t fieldbits = 42;
+	bool ok = true;
+
+	// For every set of 4 contiguous bits, test all possible values (0-15), with all other bits cleared
+	for (size_t offset = 0; offset <= fieldbits - 4; offset++) {
+		for (uint_fast64_t i = 0; i < 16; i++) {
+			for (uint_fast64_t j = 0; j < 16; j++) {
+				for (uint_fast64_t k = 0; k < 16; k++) {
+					const uint_fast64_t x = i << offset, y = j << offset, z = k << offset;
+					const libmorton::morton128_t correct_code = control_encode_128(x, y, z);
+					for (auto it = encoders.begin(); it != encoders.end(); it++) {
+						if (it->encode(x, y, z) != correct_code) {
+							cout << endl << "    Incorrect encoding of (" << x << ", " << y << ", " << z << ") in method " << it->description.c_str() << endl;
+							ok = false;
+						}
+					}
+					for (auto it = decoders.begin(); it != decoders.end(); it++) {
+						uint_fast64_t dx, dy, dz;
+						it->decode(correct_code, dx, dy, dz);
+						if (dx != x || dy != y || dz != z) {
+							cout << endl << "    Incorrect decoding of (" << x << ", " << y << ", " << z << ") in method " << it->description.c_str() << ": ("
+								<< dx << ", " << dy << ", " << dz << ")" << endl;
+							ok = false;
+						}
+					}
+				}
+			}
+		}
+	}
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+#endif
+
 // Test performance of encoding a linearly increasing set of coordinates
 template <typename morton, typename coord>
 static double testEncode_3D_Linear_Perf(morton(*function)(coord, coord, coord), size_t times) {
@@ -225,6 +436,69 @@ static double testEncode_3D_Random_Perf(morton(*function)(coord, coord, coord),
 	return timer.elapsed_time_milliseconds / (float)times;
 }
 
+// Test performance of batch encoding a linearly increasing set of coordinates, one row of MAX coordinates per call
+template <typename morton, typename coord>
+static double testEncode_3D_Batch_Linear_Perf(void(*function)(const coord*, const coord*, const coord*, morton*, size_t), size_t times) {
+	Timer timer = Timer();
+	morton runningsum = 0;
+	vector<coord> x(MAX), y(MAX), z(MAX);
+	vector<morton> out(MAX);
+	for (size_t k = 0; k < MAX; k++) {
+		z[k] = static_cast<coord>(k);
+	}
+	for (size_t t = 0; t < times; t++) {
+		for (coord i = 0; i < MAX; i++) {
+			for (coord j = 0; j < MAX; j++) {
+				std::fill(x.begin(), x.end(), i);
+				std::fill(y.begin(), y.end(), j);
+				timer.start();
+				function(x.data(), y.data(), z.data(), out.data(), MAX);
+				timer.stop();
+				for (size_t k = 0; k < MAX; k++) {
+					runningsum += out[k];
+				}
+			}
+		}
+	}
+	running_sums.push_back(runningsum);
+	return timer.elapsed_time_milliseconds / (float)times;
+}
+
+// Test performance of batch encoding random coordinates, in calls of RAND_POOL_SIZE coordinates
+template <typename morton, typename coord>
+static double testEncode_3D_Batch_Random_Perf(void(*function)(const coord*, const coord*, const coord*, morton*, size_t), size_t times) {
+	Timer timer = Timer();
+	coord maximum = ~0;
+	morton runningsum = 0;
+	vector<coord> x(RAND_POOL_SIZE), y(RAND_POOL_SIZE), z(RAND_POOL_SIZE);
+	vector<morton> out(RAND_POOL_SIZE);
+
+	for (size_t t = 0; t < times; t++) {
+		// Create a pool of random numbers
+		vector<coord> randnumbers;
+		for (size_t i = 0; i < RAND_POOL_SIZE; i++) {
+			randnumbers.push_back(rand() % maximum);
+		}
+		// Do the performance test
+		for (size_t i = 0; i < total; i += RAND_POOL_SIZE) {
+			size_t n = min(RAND_POOL_SIZE, total - i);
+			for (size_t j = 0; j < n; j++) {
+				x[j] = randnumbers[(i + j) % RAND_POOL_SIZE];
+				y[j] = randnumbers[(i + j + 1) % RAND_POOL_SIZE];
+				z[j] = randnumbers[(i + j + 2) % RAND_POOL_SIZE];
+			}
+			timer.start();
+			function(x.data(), y.data(), z.data(), out.data(), n);
+			timer.stop();
+			for (size_t j = 0; j < n; j++) {
+				runningsum += out[j];
+			}
+		}
+	}
+	running_sums.push_back(runningsum);
+	return timer.elapsed_time_milliseconds / (float)times;
+}
+
 template <typename morton, typename coord>
 static double testDecode_3D_Linear_Perf(void(*function)(const morton, coord&, coord&, coord&), size_t times) {
 	Timer timer = Timer();
@@ -282,4 +556,81 @@ static double testDecode_3D_Random_Perf(void(*function)(const morton, coord&, co
 	}
 	running_sums.push_back(runningsum);
 	return timer.elapsed_time_milliseconds / (float)times;
-}
\ No newline at end of file
+}
+
+// Test performance of batch decoding a linearly increasing set of morton codes, in calls of RAND_POOL_SIZE codes
+template <typename morton, typename coord>
+static double testDecode_3D_Batch_Linear_Perf(void(*function)(const morton*, coord*, coord*, coord*, size_t), size_t times) {
+	Timer timer = Timer();
+	morton runningsum = 0;
+	vector<morton> codes(RAND_POOL_SIZE);
+	vector<coord> x(RAND_POOL_SIZE), y(RAND_POOL_SIZE), z(RAND_POOL_SIZE);
+	for (size_t t = 0; t < times; t++) {
+		for (size_t i = 0; i < total; i += RAND_POOL_SIZE) {
+			size_t n = min(RAND_POOL_SIZE, total - i);
+			for (size_t j = 0; j < n; j++) {
+				codes[j] = static_cast<morton>(i + j);
+			}
+			timer.start();
+			function(codes.data(), x.data(), y.data(), z.data(), n);
+			timer.stop();
+			for (size_t j = 0; j < n; j++) {
+				runningsum += x[j] + y[j] + z[j];
+			}
+		}
+	}
+	running_sums.push_back(runningsum);
+	return timer.elapsed_time_milliseconds / (float)times;
+}
+
+// Test performance of batch decoding random morton codes, in calls of RAND_POOL_SIZE codes
+template <typename morton, typename coord>
+static double testDecode_3D_Batch_Random_Perf(void(*function)(const morton*, coord*, coord*, coord*, size_t), size_t times) {
+	Timer timer = Timer();
+	morton maximum = ~0; // maximum for the random morton codes
+	morton runningsum = 0;
+	vector<coord> x(RAND_POOL_SIZE), y(RAND_POOL_SIZE), z(RAND_POOL_SIZE);
+
+	// Create a pool of randum numbers
+	vector<morton> randnumbers;
+	for (size_t i = 0; i < RAND_POOL_SIZE; i++) {
+		randnumbers.push_back((rand() + rand()) % maximum);
+	}
+
+	// Start performance test
+	for (size_t t = 0; t < times; t++) {
+		for (size_t i = 0; i < total; i += RAND_POOL_SIZE) {
+			size_t n = min(RAND_POOL_SIZE, total - i);
+			timer.start();
+			function(randnumbers.data(), x.data(), y.data(), z.data(), n);
+			timer.stop();
+			for (size_t j = 0; j < n; j++) {
+				runningsum += x[j] + y[j] + z[j];
+			}
+		}
+	}
+	running_sums.push_back(runningsum);
+	return timer.elapsed_time_milliseconds / (float)times;
+}
+
+// Test performance of generating the 26 neighbors of a linearly increasing set of morton codes, MAX codes per call
+template <typename morton>
+static double testNeighbors_3D_Batch_Linear_Perf(void(*function)(const morton*, size_t, libmorton::morton_stencil, morton, morton*, uint32_t*), size_t times) {
+	Timer timer = Timer();
+	morton runningsum = 0;
+	vector<morton> codes(MAX), out(26 * MAX);
+	vector<uint32_t> valid(MAX);
+	for (size_t t = 0; t < times; t++) {
+		for (size_t i = 0; i < total; i += MAX) {
+			for (size_t j = 0; j < MAX; j++) {
+				codes[j] = static_cast<morton>(i + j);
+			}
+			timer.start();
+			function(codes.data(), MAX, libmorton::morton_stencil::corner, static_cast<morton>(~0), out.data(), valid.data());
+			timer.stop();
+			runningsum += out[i % out.size()] + valid[i % MAX];
+		}
+	}
+	running_sums.push_back(runningsum);
+	return timer.elapsed_time_milliseconds / (float)times;
+}
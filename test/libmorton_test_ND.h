@@ -0,0 +1,102 @@
+#pragma once
+#include "libmorton_test.h"
+
+using namespace std;
+
+// Control encoding/decoding of coordinate arrays
+template <size_t N, typename coord, size_t... I>
+static uint64_t control_encode_ND(const std::array<coord, N>& c, std::index_sequence<I...>) {
+	return control_encode(static_cast<uint64_t>(c[I])...);
+}
+
+template <size_t N, size_t... I>
+static void control_decode_ND(uint64_t encoding, std::array<uint64_t, N>& c, std::index_sequence<I...>) {
+	control_decode(encoding, c[I]...);
+}
+
+// Coordinates to test: for every set of 4 contiguous bits, every combination of values (0-15) in the
+// first three coordinates, the other coordinates get values derived from those
+template <size_t N, typename coord>
+static std::array<coord, N> testCoordinatesND(const size_t offset, const unsigned int v) {
+	std::array<coord, N> c;
+	for (size_t i = 0; i < N; i++) {
+		c[i] = static_cast<coord>((((v >> (4 * (i % 3))) + i) & 15) << offset);
+	}
+	return c;
+}
+
+// Check an N-D Encode Function for correctness
+template <size_t N, typename morton, typename coord, size_t bits>
+static bool checkND_EncodeFunction(const encode_f_ND_wrapper<N, morton, coord> &function) {
+
+	// Number of bits which can be encoded for each field
+	static const size_t fieldbits = bits / N;
+
+	static_assert(bits <= std::numeric_limits<uint64_t>::digits, "Control encoder cannot support > 64 bits.");
+	static_assert(fieldbits >= 4, "At least 4 bits from each field must fit into 'morton'");
+
+	bool everything_okay = true;
+	for (size_t offset = 0; offset <= fieldbits - 4; offset++) {
+		for (unsigned int v = 0; v < 4096; v++) {
+			const std::array<coord, N> c = testCoordinatesND<N, coord>(offset, v);
+			const morton correct_code = static_cast<morton>(control_encode_ND<N, coord>(c, std::make_index_sequence<N>()));
+			const morton computed_code = function.encode(c);
+			if (computed_code != correct_code) {
+				everything_okay = false;
+				cout << endl << "    Incorrect encoding of (" << c[0] << ", " << c[1] << ", ...) in method " << function.description.c_str() << ": " << computed_code <<
+					" != " << correct_code << endl;
+			}
+		}
+	}
+	return everything_okay;
+}
+
+// Check an N-D Decode Function for correctness
+template <size_t N, typename morton, typename coord, size_t bits>
+static bool checkND_DecodeFunction(const decode_f_ND_wrapper<N, morton, coord> &function) {
+
+	// Number of bits which can be encoded for each field
+	static const size_t fieldbits = bits / N;
+
+	static_assert(bits <= std::numeric_limits<uint64_t>::digits, "Control decoder cannot support > 64 bits.");
+	static_assert(fieldbits >= 4, "At least 4 bits from each field must fit into 'morton'");
+
+	bool everything_okay = true;
+	for (size_t offset = 0; offset <= fieldbits - 4; offset++) {
+		for (unsigned int v = 0; v < 4096; v++) {
+			const morton encoding = static_cast<morton>(control_encode_ND<N, coord>(testCoordinatesND<N, coord>(offset, v), std::make_index_sequence<N>()));
+			std::array<uint64_t, N> control;
+			control_decode_ND<N>(encoding, control, std::make_index_sequence<N>());
+			std::array<coord, N> c;
+			function.decode(encoding, c);
+			for (size_t i = 0; i < N; i++) {
+				if (c[i] != static_cast<coord>(control[i])) {
+					everything_okay = false;
+					cout << endl << "    Incorrect decoding of " << encoding << " in method " << function.description.c_str() << ": coordinate " << i << " "
+						<< c[i] << " != " << control[i] << endl;
+				}
+			}
+		}
+	}
+	return everything_okay;
+}
+
+template <size_t N, typename morton, typename coord, size_t bits>
+inline void checkND_EncodeCorrectness(std::vector<encode_f_ND_wrapper<N, morton, coord>> encoders) {
+	printf("++ Checking correctness of %luD encoders (%lu bit) methods ... ", N, bits);
+	bool ok = true;
+	for (auto it = encoders.begin(); it != encoders.end(); it++) {
+		ok &= checkND_EncodeFunction<N, morton, coord, bits>(*it);
+	}
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
+template <size_t N, typename morton, typename coord, size_t bits>
+inline void checkND_DecodeCorrectness(std::vector<decode_f_ND_wrapper<N, morton, coord>> decoders) {
+	printf("++ Checking correctness of %luD decoding (%lu bit) methods ... ", N, bits);
+	bool ok = true;
+	for (auto it = decoders.begin(); it != decoders.end(); it++) {
+		ok &= checkND_DecodeFunction<N, morton, coord, bits>(*it);
+	}
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
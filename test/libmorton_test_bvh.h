@@ -0,0 +1,190 @@
+#pragma once
+#include "libmorton_test.h"
+#include "libmorton_test_parallel.h"
+
+using namespace std;
+
+// Config variables (defined elsewhere)
+extern size_t total;
+extern size_t MAX;
+extern unsigned int times;
+extern vector<uint_fast64_t> running_sums;
+
+// Small random boxes around few distinct centers, so many primitives share a code
+template <typename real>
+static vector<libmorton::morton_aabb<real, 3>> bvhTestBoxes(const size_t count, const int centers) {
+	vector<libmorton::morton_aabb<real, 3>> boxes(count);
+	for (size_t i = 0; i < count; i++) {
+		for (size_t d = 0; d < 3; d++) {
+			const real center = static_cast<real>(rand() % centers) / centers * 100 - 20;
+			const real extent = static_cast<real>(rand() % 100) / 1000;
+			boxes[i].lo[d] = center - extent;
+			boxes[i].hi[d] = center + extent;
+		}
+	}
+	return boxes;
+}
+
+// Walk the subtree of node: every leaf and internal node is reached once, the node covers leaves first .. last, its
+// split is the last leaf whose code shares a longer prefix with the first code than the last code does (ties broken
+// by position), parents point back, and its box is the union of the boxes of its leaves
+template <typename real, typename morton>
+static bool checkBvhNode(const libmorton::morton_bvh<real, morton>& bvh, const morton* codes, const libmorton::morton_aabb<real, 3>* boxes, const uint32_t node,
+	vector<bool>& seen, size_t& first, size_t& last, libmorton::morton_aabb<real, 3>& box) {
+	const size_t n = bvh.leaves(), internal = bvh.nodes.size();
+	if (node & libmorton::morton_bvh_leaf) {
+		first = last = node & ~libmorton::morton_bvh_leaf;
+		box = boxes[bvh.primitives[first]];
+		const bool ok = first < n && !seen[internal + first];
+		if (first < n) { seen[internal + first] = true; }
+		return ok;
+	}
+	if (node >= internal || seen[node]) { return false; }
+	seen[node] = true;
+	size_t left_first, left_last, right_first, right_last;
+	libmorton::morton_aabb<real, 3> left_box, right_box;
+	const uint32_t left = bvh.nodes[node].child[0], right = bvh.nodes[node].child[1];
+	bool ok = checkBvhNode(bvh, codes, boxes, left, seen, left_first, left_last, left_box);
+	ok &= checkBvhNode(bvh, codes, boxes, right, seen, right_first, right_last, right_box);
+	ok &= left_last + 1 == right_first;
+	first = left_first;
+	last = right_last;
+	const int prefix = libmorton::bvh_detail::delta(codes, static_cast<int64_t>(n), static_cast<int64_t>(first), static_cast<int64_t>(last));
+	size_t split = first;
+	for (size_t s = first; s < last; s++) {
+		if (libmorton::bvh_detail::delta(codes, static_cast<int64_t>(n), static_cast<int64_t>(first), static_cast<int64_t>(s)) > prefix) { split = s; }
+	}
+	ok &= split == left_last;
+	ok &= bvh.parents[left & libmorton::morton_bvh_leaf ? internal + (left & ~libmorton::morton_bvh_leaf) : left] == node;
+	ok &= bvh.parents[right & libmorton::morton_bvh_leaf ? internal + (right & ~libmorton::morton_bvh_leaf) : right] == node;
+	box = left_box;
+	libmorton::bvh_detail::merge(box, right_box);
+	for (size_t d = 0; d < 3; d++) {
+		ok &= bvh.nodes[node].box.lo[d] == box.lo[d] && bvh.nodes[node].box.hi[d] == box.hi[d];
+	}
+	return ok;
+}
+
+template <typename real, typename morton>
+static bool checkBvhTree(const libmorton::morton_bvh<real, morton>& bvh, const morton* codes, const libmorton::morton_aabb<real, 3>* boxes, const size_t n) {
+	bool ok = bvh.leaves() == n && bvh.nodes.size() == (n > 0 ? n - 1 : 0) && bvh.parents.size() == (n > 0 ? 2 * n - 1 : 0);
+	if (!ok || n == 0) { return ok; }
+	vector<bool> seen(2 * n - 1, false);
+	size_t first, last;
+	libmorton::morton_aabb<real, 3> box;
+	ok &= checkBvhNode(bvh, codes, boxes, bvh.root(), seen, first, last, box);
+	ok &= first == 0 && last == n - 1 && find(seen.begin(), seen.end(), false) == seen.end();
+	return ok;
+}
+
+// Build the hierarchy of boxes on executor: the leaves hold every primitive once, in the order of the codes of their
+// centers, and the tree is the radix tree of the codes. Then move the boxes, and refit.
+template <typename morton, typename real>
+static bool checkBvhFunction(const size_t count, const int centers, libmorton::morton_executor& executor) {
+	vector<libmorton::morton_aabb<real, 3>> boxes = bvhTestBoxes<real>(count, centers);
+	libmorton::morton_bvh<real, morton> bvh;
+	libmorton::morton_build_bvh<morton>(boxes.data(), count, bvh, executor);
+	bool ok = bvh.codes.size() == count && is_sorted(bvh.codes.begin(), bvh.codes.end());
+	vector<uint32_t> order = bvh.primitives;
+	sort(order.begin(), order.end());
+	for (size_t i = 0; i < count; i++) { ok &= order[i] == i; }
+	if (count > 0) {
+		// The codes are the codes of the centers of the leaves, in the box around all centers
+		libmorton::morton_aabb<real, 3> bounds = { { boxes[0].lo[0], boxes[0].lo[1], boxes[0].lo[2] }, { boxes[0].lo[0], boxes[0].lo[1], boxes[0].lo[2] } };
+		vector<real> centers_of_leaves(3 * count);
+		for (size_t i = 0; i < count; i++) {
+			for (size_t d = 0; d < 3; d++) {
+				const real center = (boxes[bvh.primitives[i]].lo[d] + boxes[bvh.primitives[i]].hi[d]) / 2;
+				centers_of_leaves[3 * i + d] = center;
+				if (i == 0) { bounds.lo[d] = bounds.hi[d] = center; }
+				bounds.lo[d] = min(bounds.lo[d], center);
+				bounds.hi[d] = max(bounds.hi[d], center);
+			}
+		}
+		vector<morton> codes(count);
+		libmorton::m3D_quantize_encode<morton, real>(centers_of_leaves.data(), 3, bounds, codes.data(), count);
+		ok &= codes == bvh.codes;
+	}
+	ok &= checkBvhTree(bvh, bvh.codes.data(), boxes.data(), count);
+
+	for (size_t i = 0; i < count; i++) {
+		boxes[i].hi[i % 3] += 1;
+		boxes[i].lo[(i + 1) % 3] -= 2;
+	}
+	libmorton::morton_bvh_refit(bvh, boxes.data(), executor);
+	ok &= checkBvhTree(bvh, bvh.codes.data(), boxes.data(), count);
+
+	// The tree alone over the same codes, with the leaves given as primitives
+	libmorton::morton_bvh<real, morton> tree;
+	libmorton::morton_bvh_build_tree(bvh.codes.data(), bvh.primitives.data(), count, tree, executor);
+	ok &= tree.primitives == bvh.primitives && tree.parents == bvh.parents;
+	for (size_t i = 0; ok && i < tree.nodes.size(); i++) {
+		ok &= tree.nodes[i].child[0] == bvh.nodes[i].child[0] && tree.nodes[i].child[1] == bvh.nodes[i].child[1];
+	}
+	if (!ok) {
+		cout << endl << "    Incorrect " << sizeof(morton) * 8 << "-bit hierarchy of " << count << " boxes around " << centers << "^3 centers" << endl;
+	}
+	return ok;
+}
+
+// Executor which only counts the work given to it
+struct counting_executor : public libmorton::morton_executor {
+	size_t runs = 0;
+	unsigned int concurrency() const override { return 4; }
+	void run(size_t tasks, const std::function<void(size_t)>& task) override {
+		++runs;
+		for (size_t i = 0; i < tasks; ++i) { task(i); }
+	}
+};
+
+inline void checkBvhCorrectness() {
+	printf("++ Checking correctness of BVH build methods ... ");
+	static_assert(sizeof(libmorton::morton_bvh_node<float>) == 32, "two nodes per cache line");
+	libmorton::morton_thread_pool pool(4);
+	reverse_executor reverse;
+	libmorton::morton_executor* executors[] = { &pool, &reverse };
+	bool ok = true;
+	for (libmorton::morton_executor* executor : executors) {
+		// Several chunks of nodes, with and without repeated codes
+		ok &= checkBvhFunction<uint64_t, float>(100000, 1000, *executor);
+		ok &= checkBvhFunction<uint64_t, double>(50000, 20, *executor);
+		ok &= checkBvhFunction<uint32_t, float>(50000, 1024, *executor);
+		// Every center the same, and the smallest trees
+		ok &= checkBvhFunction<uint32_t, float>(1000, 1, *executor);
+		ok &= checkBvhFunction<uint64_t, float>(2, 100, *executor);
+		ok &= checkBvhFunction<uint64_t, float>(1, 100, *executor);
+		ok &= checkBvhFunction<uint64_t, float>(0, 100, *executor);
+	}
+	// Every step of the build, the sort of enough codes for several slices included, runs on the executor given
+	counting_executor fallback;
+	libmorton::set_default_executor(&fallback);
+	ok &= checkBvhFunction<uint64_t, float>(300000, 1000, pool);
+	libmorton::set_default_executor(nullptr);
+	if (fallback.runs != 0) {
+		ok = false;
+		cout << endl << "    " << fallback.runs << " steps of the BVH build ran on the default executor" << endl;
+	}
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
+// Test performance of building the hierarchy of boxes (codes, sort, tree and boxes), and of refitting it
+template <typename morton>
+static std::string testBvh_Perf(size_t times) {
+	Timer build, refit;
+	const vector<libmorton::morton_aabb<float, 3>> boxes = bvhTestBoxes<float>(total, 1 << 20);
+	libmorton::morton_bvh<float, morton> bvh;
+	for (size_t t = 0; t < times; t++) {
+		build.start();
+		libmorton::morton_build_bvh<morton>(boxes.data(), total, bvh);
+		build.stop();
+		refit.start();
+		libmorton::morton_bvh_refit(bvh, boxes.data());
+		refit.stop();
+		running_sums.push_back(bvh.nodes[total / 2].child[0] + bvh.primitives[total / 3]);
+	}
+	stringstream os;
+	os << setfill('0') << std::setw(6) << std::fixed << std::setprecision(3)
+		<< build.elapsed_time_milliseconds / (float)times << " ms (" << setprecision(1) << total * times / build.elapsed_time_milliseconds / 1000 << " M boxes/s) : build, "
+		<< setprecision(3) << refit.elapsed_time_milliseconds / (float)times << " ms : refit";
+	return os.str();
+}
@@ -0,0 +1,181 @@
+#pragma once
+#include "libmorton_test.h"
+
+using namespace std;
+
+// Config variables (defined elsewhere)
+extern size_t total;
+extern size_t MAX;
+extern unsigned int times;
+extern vector<uint_fast64_t> running_sums;
+
+// Random coordinate below extent (rand() may have as few as 15 bits)
+static uint32_t compactRandom(const uint32_t extent) {
+	return static_cast<uint32_t>(((uint64_t(rand()) << 30) ^ (uint64_t(rand()) << 15) ^ uint64_t(rand())) % extent);
+}
+
+// Index of a cell, computed the long way: the boxes of every axis are the set bits of its extent, from the highest
+// one. The index counts the cells of the slabs of x before the cell, of y in its slab, of z in that, then the bits
+// of the offsets in the box, level by level, x before y before z, leaving out axes the box has no level for.
+static uint64_t compactReference(const uint32_t extent[3], const uint32_t c[3]) {
+	uint64_t start[3], side[3], offset[3];
+	for (int a = 0; a < 3; a++) {
+		start[a] = 0;
+		for (int bit = 31; bit >= 0; bit--) {
+			if (!((extent[a] >> bit) & 1)) { continue; }
+			if (c[a] < start[a] + (uint64_t(1) << bit)) { side[a] = bit; break; }
+			start[a] += uint64_t(1) << bit;
+		}
+		offset[a] = c[a] - start[a];
+	}
+	uint64_t index = start[0] * extent[1] * extent[2] + (start[1] << side[0]) * extent[2] + (start[2] << (side[0] + side[1]));
+	unsigned int out = 0;
+	for (unsigned int level = 0; level < 32; level++) {
+		for (int a = 0; a < 3; a++) {
+			if (level < side[a]) { index += ((offset[a] >> level) & 1) << out++; }
+		}
+	}
+	return index;
+}
+
+// Every cell of a small grid: its index against the reference, every index used once, decoded back, in a batch,
+// and with both ways of packing the offsets in a box
+static bool checkCompactFunction(const uint32_t x, const uint32_t y, const uint32_t z) {
+	const libmorton::morton3D_compact compact(x, y, z);
+	const uint32_t extent[3] = { x, y, z };
+	bool ok = compact.size() == uint64_t(x) * y * z;
+	vector<bool> seen(compact.size(), false);
+	vector<uint32_t> xs, ys, zs;
+	vector<uint64_t> indices;
+#if defined(__BMI2__) || __AVX2__ || LIBMORTON_X86_DISPATCH
+	const bool bmi2 = libmorton::host_cpu_features().bmi2;
+#endif
+	for (uint32_t k = 0; ok && k < z; k++) {
+		for (uint32_t j = 0; ok && j < y; j++) {
+			for (uint32_t i = 0; ok && i < x; i++) {
+				const uint32_t c[3] = { i, j, k };
+				const uint64_t index = compact.encode(i, j, k);
+				ok &= index == compactReference(extent, c) && index < compact.size() && !seen[index];
+				ok &= compact.encode_with<libmorton::compact_detail::split_packer>(i, j, k) == index;
+#if defined(__BMI2__) || __AVX2__ || LIBMORTON_X86_DISPATCH
+				if (bmi2) { ok &= compact.encode_with<libmorton::compact_detail::BMI_packer>(i, j, k) == index; }
+#endif
+				if (!ok) { break; }
+				seen[index] = true;
+				uint32_t dx, dy, dz;
+				compact.decode(index, dx, dy, dz);
+				ok &= dx == i && dy == j && dz == k;
+				compact.decode_with<libmorton::compact_detail::split_packer>(index, dx, dy, dz);
+				ok &= dx == i && dy == j && dz == k;
+				xs.push_back(i);
+				ys.push_back(j);
+				zs.push_back(k);
+				indices.push_back(index);
+			}
+		}
+	}
+	vector<uint64_t> batch(indices.size());
+	compact.encode_batch(xs.data(), ys.data(), zs.data(), batch.data(), batch.size());
+	ok &= batch == indices;
+	vector<uint32_t> bx(indices.size()), by(indices.size()), bz(indices.size());
+	compact.decode_batch(indices.data(), bx.data(), by.data(), bz.data(), indices.size());
+	ok &= bx == xs && by == ys && bz == zs;
+	if (!ok) {
+		cout << endl << "    Incorrect compact index of a " << x << " x " << y << " x " << z << " grid" << endl;
+	}
+	return ok;
+}
+
+// Random cells of a large grid: against the reference, and decoded back
+static bool checkCompactSamples(const uint32_t x, const uint32_t y, const uint32_t z, const size_t samples) {
+	const libmorton::morton3D_compact compact(x, y, z);
+	const uint32_t extent[3] = { x, y, z };
+	bool ok = true;
+	for (size_t s = 0; ok && s < samples; s++) {
+		// The corners of the grid, then random cells
+		const uint32_t c[3] = { s < 8 ? static_cast<uint32_t>(s & 1) * (x - 1) : compactRandom(x), s < 8 ? static_cast<uint32_t>((s >> 1) & 1) * (y - 1) : compactRandom(y),
+			s < 8 ? static_cast<uint32_t>((s >> 2) & 1) * (z - 1) : compactRandom(z) };
+		const uint64_t index = compact.encode(c[0], c[1], c[2]);
+		uint32_t dx, dy, dz;
+		compact.decode(index, dx, dy, dz);
+		ok &= index == compactReference(extent, c) && index < compact.size() && dx == c[0] && dy == c[1] && dz == c[2];
+	}
+	if (!ok) {
+		cout << endl << "    Incorrect compact index in a " << x << " x " << y << " x " << z << " grid" << endl;
+	}
+	return ok;
+}
+
+inline void checkCompactCorrectness() {
+	printf("++ Checking correctness of compact Z-order methods ... ");
+	bool ok = true;
+	// Cubes with a side which is a power of 2 get the morton codes
+	const libmorton::morton3D_compact cube(64, 64, 64);
+	for (uint32_t i = 0; i < 64 * 64 * 64; i += 37) {
+		ok &= cube.encode(i % 64, i / 64 % 64, i / 4096) == control_encode(static_cast<uint64_t>(i % 64), static_cast<uint64_t>(i / 64 % 64), static_cast<uint64_t>(i / 4096));
+	}
+	ok &= checkCompactFunction(64, 64, 64);
+	ok &= checkCompactFunction(100, 37, 60);
+	ok &= checkCompactFunction(31, 31, 31);
+	ok &= checkCompactFunction(128, 3, 17);
+	ok &= checkCompactFunction(5, 1, 7);
+	ok &= checkCompactFunction(1, 1, 1);
+	ok &= checkCompactFunction(0, 4, 4);
+	ok &= checkCompactSamples(1000, 1000, 300, 100000);
+	ok &= checkCompactSamples(1 << 21, (1 << 21) - 1, 1 << 21, 100000);
+	ok &= checkCompactSamples(1, 2097151, 3, 10000);
+#if LIBMORTON_RUNTIME_DISPATCH && !(defined(__BMI2__) || __AVX2__)
+	// Without pext / pdep, as on CPUs without BMI2
+	const libmorton::morton_method initial = libmorton::bound_method(libmorton::morton_slot::m3D_64_encode);
+	libmorton::set_method(libmorton::morton_method::sLUT);
+	ok &= !libmorton::morton3D_compact(1, 1, 1).uses_pdep();
+	ok &= checkCompactFunction(100, 37, 60);
+	ok &= checkCompactSamples(1000, 1000, 300, 10000);
+	libmorton::set_method(initial);
+#endif
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
+// Test performance of encoding and decoding random cells of an X x Y x Z grid to compact indices, against morton
+// codes of the same cells
+static std::string testCompact_Perf(const uint32_t x, const uint32_t y, const uint32_t z, size_t times) {
+	Timer encode_timer, decode_timer, morton_encode_timer, morton_decode_timer;
+	const libmorton::morton3D_compact compact(x, y, z);
+	vector<uint32_t> xs(total), ys(total), zs(total), dx(total), dy(total), dz(total);
+	vector<uint64_t> indices(total), codes(total);
+	for (size_t i = 0; i < total; i++) {
+		xs[i] = compactRandom(x);
+		ys[i] = compactRandom(y);
+		zs[i] = compactRandom(z);
+	}
+	for (size_t t = 0; t < times; t++) {
+		encode_timer.start();
+		compact.encode_batch(xs.data(), ys.data(), zs.data(), indices.data(), total);
+		encode_timer.stop();
+		decode_timer.start();
+		compact.decode_batch(indices.data(), dx.data(), dy.data(), dz.data(), total);
+		decode_timer.stop();
+		morton_encode_timer.start();
+		for (size_t i = 0; i < total; i++) { codes[i] = libmorton::morton3D_64_encode(xs[i], ys[i], zs[i]); }
+		morton_encode_timer.stop();
+		morton_decode_timer.start();
+		for (size_t i = 0; i < total; i++) {
+			uint_fast32_t cx, cy, cz;
+			libmorton::morton3D_64_decode(codes[i], cx, cy, cz);
+			dx[i] += static_cast<uint32_t>(cx + cy + cz);
+		}
+		morton_decode_timer.stop();
+		running_sums.push_back(indices[total / 2] + codes[total / 3] + dx[total / 4] + dy[total / 5] + dz[total / 6]);
+	}
+	const double codes_per_ms = static_cast<double>(total) * times / 1000;
+	uint64_t cube = 1;
+	while (cube < x || cube < y || cube < z) { cube *= 2; }
+	stringstream os;
+	os << x << " x " << y << " x " << z << " (" << std::fixed << std::setprecision(2) << static_cast<double>(cube * cube * cube) / compact.size() << "x fewer codes)"
+		<< (compact.uses_pdep() ? " with pdep" : "") << ": " << std::setprecision(1)
+		<< codes_per_ms / encode_timer.elapsed_time_milliseconds << " M/s encode, "
+		<< codes_per_ms / decode_timer.elapsed_time_milliseconds << " M/s decode, morton codes: "
+		<< codes_per_ms / morton_encode_timer.elapsed_time_milliseconds << " M/s encode, "
+		<< codes_per_ms / morton_decode_timer.elapsed_time_milliseconds << " M/s decode";
+	return os.str();
+}
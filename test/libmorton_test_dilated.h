@@ -0,0 +1,89 @@
+#pragma once
+#include "libmorton_test.h"
+#include "libmorton_test_ND.h"
+
+using namespace std;
+
+// The 2D / 3D dilated arithmetic methods, by number of dimensions
+template <typename morton, size_t N> struct dilated_methods;
+template <typename morton> struct dilated_methods<morton, 2> {
+	static unsigned int add(const morton a, const morton b, morton& r) { return libmorton::m2D_add_overflow<morton>(a, b, r); }
+	static unsigned int sub(const morton a, const morton b, morton& r) { return libmorton::m2D_sub_overflow<morton>(a, b, r); }
+	static bool inc(const morton m, const unsigned int axis, morton& r) { return libmorton::m2D_inc_overflow<morton>(m, axis, r); }
+	static bool dec(const morton m, const unsigned int axis, morton& r) { return libmorton::m2D_dec_overflow<morton>(m, axis, r); }
+	static morton add(const morton a, const morton b) { return libmorton::m2D_add<morton>(a, b); }
+	static morton sub(const morton a, const morton b) { return libmorton::m2D_sub<morton>(a, b); }
+};
+template <typename morton> struct dilated_methods<morton, 3> {
+	static unsigned int add(const morton a, const morton b, morton& r) { return libmorton::m3D_add_overflow<morton>(a, b, r); }
+	static unsigned int sub(const morton a, const morton b, morton& r) { return libmorton::m3D_sub_overflow<morton>(a, b, r); }
+	static bool inc(const morton m, const unsigned int axis, morton& r) { return libmorton::m3D_inc_overflow<morton>(m, axis, r); }
+	static bool dec(const morton m, const unsigned int axis, morton& r) { return libmorton::m3D_dec_overflow<morton>(m, axis, r); }
+	static morton add(const morton a, const morton b) { return libmorton::m3D_add<morton>(a, b); }
+	static morton sub(const morton a, const morton b) { return libmorton::m3D_sub<morton>(a, b); }
+};
+
+// Check add/subtract/increment/decrement on morton codes against decoding, adjusting and encoding the coordinates
+template <size_t N, typename morton, typename coord, size_t bits>
+static bool checkDilatedFunctions() {
+	typedef dilated_methods<morton, N> ops;
+	static const size_t fieldbits = bits / N;
+	static const uint64_t fieldmax = (uint64_t(1) << fieldbits) - 1;
+
+	bool everything_okay = true;
+	for (size_t offset = 0; offset <= fieldbits - 4; offset++) {
+		for (unsigned int v = 0; v < 4096; v++) {
+			// Two codes with 4 varying bits per coordinate, at offset and at the top: sums and differences wrap around
+			const morton a = static_cast<morton>(control_encode_ND<N, coord>(testCoordinatesND<N, coord>(offset, v), std::make_index_sequence<N>()));
+			const morton b = static_cast<morton>(control_encode_ND<N, coord>(testCoordinatesND<N, coord>(fieldbits - 4, v * 7 + 1), std::make_index_sequence<N>()));
+			std::array<uint64_t, N> ca, cb, sum, diff;
+			control_decode_ND<N>(a, ca, std::make_index_sequence<N>());
+			control_decode_ND<N>(b, cb, std::make_index_sequence<N>());
+
+			unsigned int sum_wrapped = 0, diff_wrapped = 0;
+			for (size_t i = 0; i < N; i++) {
+				sum[i] = (ca[i] + cb[i]) & fieldmax;
+				diff[i] = (ca[i] - cb[i]) & fieldmax;
+				if (ca[i] + cb[i] > fieldmax) { sum_wrapped |= 1u << i; }
+				if (cb[i] > ca[i]) { diff_wrapped |= 1u << i; }
+			}
+			const morton correct_sum = static_cast<morton>(control_encode_ND<N, uint64_t>(sum, std::make_index_sequence<N>()));
+			const morton correct_diff = static_cast<morton>(control_encode_ND<N, uint64_t>(diff, std::make_index_sequence<N>()));
+
+			morton computed;
+			const unsigned int computed_sum_wrapped = ops::add(a, b, computed);
+			if (computed != correct_sum || ops::add(a, b) != correct_sum || computed_sum_wrapped != sum_wrapped) {
+				everything_okay = false;
+				cout << endl << "    Incorrect " << N << "D add of " << a << " and " << b << ": " << computed << " != " << correct_sum << endl;
+			}
+			const unsigned int computed_diff_wrapped = ops::sub(a, b, computed);
+			if (computed != correct_diff || ops::sub(a, b) != correct_diff || computed_diff_wrapped != diff_wrapped) {
+				everything_okay = false;
+				cout << endl << "    Incorrect " << N << "D subtract of " << b << " from " << a << ": " << computed << " != " << correct_diff << endl;
+			}
+
+			for (unsigned int axis = 0; axis < N; axis++) {
+				std::array<uint64_t, N> step = ca;
+				step[axis] = (ca[axis] + 1) & fieldmax;
+				morton correct = static_cast<morton>(control_encode_ND<N, uint64_t>(step, std::make_index_sequence<N>()));
+				if (ops::inc(a, axis, computed) != (ca[axis] == fieldmax) || computed != correct) {
+					everything_okay = false;
+					cout << endl << "    Incorrect " << N << "D increment of axis " << axis << " of " << a << ": " << computed << " != " << correct << endl;
+				}
+				step[axis] = (ca[axis] - 1) & fieldmax;
+				correct = static_cast<morton>(control_encode_ND<N, uint64_t>(step, std::make_index_sequence<N>()));
+				if (ops::dec(a, axis, computed) != (ca[axis] == 0) || computed != correct) {
+					everything_okay = false;
+					cout << endl << "    Incorrect " << N << "D decrement of axis " << axis << " of " << a << ": " << computed << " != " << correct << endl;
+				}
+			}
+		}
+	}
+	return everything_okay;
+}
+
+template <size_t N, typename morton, typename coord, size_t bits>
+inline void checkDilatedCorrectness() {
+	printf("++ Checking correctness of %luD dilated arithmetic (%lu bit) methods ... ", N, bits);
+	checkDilatedFunctions<N, morton, coord, bits>() ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include "libmorton_test.h"
+
+using namespace std;
+
+// Config variables (defined elsewhere)
+extern size_t total;
+extern size_t MAX;
+extern unsigned int times;
+extern vector<uint_fast64_t> running_sums;
+
+static const char* EXTERNAL_INPUT = "libmorton_external_in.bin";
+static const char* EXTERNAL_OUTPUT = "libmorton_external_out.bin";
+
+// Records of record_size bytes: float x, y, z in the unit cube (or uint32_t coordinates below 2^21) at offset, the
+// record index after them, and random bytes in the rest
+static vector<unsigned char> externalTestRecords(const size_t record_size, const size_t offset, const size_t count, const bool coordinates) {
+	vector<unsigned char> records(record_size * count);
+	for (size_t i = 0; i < records.size(); i++) {
+		records[i] = static_cast<unsigned char>(rand());
+	}
+	for (size_t i = 0; i < count; i++) {
+		unsigned char* p = records.data() + i * record_size + offset;
+		for (size_t d = 0; d < 3; d++) {
+			// Few distinct positions, so many records share a code
+			const uint32_t c = static_cast<uint32_t>(rand() % 64) << 15;
+			const float f = static_cast<float>(rand() % 64) / 64;
+			coordinates ? memcpy(p + 4 * d, &c, 4) : memcpy(p + 4 * d, &f, 4);
+		}
+		const uint32_t index = static_cast<uint32_t>(i);
+		memcpy(p + 12, &index, 4);
+	}
+	return records;
+}
+
+static bool writeExternalFile(const char* path, const vector<unsigned char>& data) {
+	FILE* f = fopen(path, "wb");
+	if (f == nullptr) { return false; }
+	const bool ok = data.empty() || fwrite(data.data(), 1, data.size(), f) == data.size();
+	return fclose(f) == 0 && ok;
+}
+
+static vector<unsigned char> readExternalFile(const char* path) {
+	vector<unsigned char> data;
+	FILE* f = fopen(path, "rb");
+	if (f == nullptr) { return data; }
+	unsigned char buffer[4096];
+	for (size_t got; (got = fread(buffer, 1, sizeof(buffer), f)) > 0;) {
+		data.insert(data.end(), buffer, buffer + got);
+	}
+	fclose(f);
+	return data;
+}
+
+// Sort a file with the given memory budget, and compare the output with a stable sort of the records in memory
+static bool checkExternalSortFunction(const size_t record_size, const size_t offset, const size_t count, const bool coordinates, const size_t memory, const size_t block) {
+	const vector<unsigned char> records = externalTestRecords(record_size, offset, count, coordinates);
+	const libmorton::morton_aabb<float, 3> box = { { 0, 0, 0 }, { 1, 1, 1 } };
+	const libmorton::morton_record_key key = coordinates ? libmorton::morton_coordinate_key(offset) : libmorton::morton_quantized_key<float>(offset, box);
+	libmorton::morton_external_sort_options options;
+	options.memory = memory;
+	options.block = block;
+	bool ok = writeExternalFile(EXTERNAL_INPUT, records) && libmorton::morton_external_sort(EXTERNAL_INPUT, EXTERNAL_OUTPUT, record_size, key, options);
+	const vector<unsigned char> sorted = readExternalFile(EXTERNAL_OUTPUT);
+
+	vector<uint64_t> codes(count);
+	key(records.data(), record_size, count, codes.data());
+	vector<size_t> order(count);
+	for (size_t i = 0; i < count; i++) { order[i] = i; }
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return codes[a] < codes[b]; });
+	ok &= sorted.size() == records.size();
+	for (size_t i = 0; ok && i < count; i++) {
+		ok &= memcmp(sorted.data() + i * record_size, records.data() + order[i] * record_size, record_size) == 0;
+	}
+	remove(EXTERNAL_INPUT);
+	remove(EXTERNAL_OUTPUT);
+	if (!ok) {
+		cout << endl << "    Incorrect external sort of " << count << " records of " << record_size << " bytes with " << memory << " bytes of memory" << endl;
+	}
+	return ok;
+}
+
+inline void checkExternalSortCorrectness() {
+	printf("++ Checking correctness of external sort methods ... ");
+	// Many runs, merged in several passes
+	bool ok = checkExternalSortFunction(20, 0, 50000, false, 1 << 16, 1 << 10);
+	// Two runs, records of an odd size
+	ok &= checkExternalSortFunction(27, 5, 10000, true, 1 << 20, 1 << 12);
+	// Runs large enough to be spread in slices, on a pool of 4 threads
+	libmorton::morton_thread_pool pool(4);
+	libmorton::set_default_executor(&pool);
+	ok &= checkExternalSortFunction(16, 0, 300000, false, 1 << 24, 1 << 20);
+	libmorton::set_default_executor(nullptr);
+	// One run, and an empty file
+	ok &= checkExternalSortFunction(16, 0, 1000, false, 1 << 20, 1 << 20);
+	ok &= checkExternalSortFunction(16, 0, 0, true, 1 << 20, 1 << 20);
+	// A file which is not made of whole records
+	ok &= writeExternalFile(EXTERNAL_INPUT, vector<unsigned char>(100)) && !libmorton::morton_external_sort(EXTERNAL_INPUT, EXTERNAL_OUTPUT, 16, libmorton::morton_coordinate_key(0));
+	remove(EXTERNAL_INPUT);
+	remove(EXTERNAL_OUTPUT);
+	// A run which cannot be opened fails the merge, which leaves the output alone
+	const vector<unsigned char> old_output(64, 7);
+	const vector<string> runs = { EXTERNAL_INPUT, "libmorton_external_missing.run" };
+	ok &= writeExternalFile(EXTERNAL_INPUT, externalTestRecords(16, 0, 100, true)) && writeExternalFile(EXTERNAL_OUTPUT, old_output);
+	ok &= !libmorton::external_detail::merge(runs, EXTERNAL_OUTPUT, 16, libmorton::morton_coordinate_key(0), 16);
+	ok &= readExternalFile(EXTERNAL_OUTPUT) == old_output;
+	remove(EXTERNAL_INPUT);
+	remove(EXTERNAL_OUTPUT);
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
+// Test performance of sorting a file of 16-byte records (float positions, index) with a quarter of its size as
+// memory budget, against copying the file (the disk bandwidth for reading and writing it once)
+static std::string testExternalSort_Perf(size_t times) {
+	Timer copy_timer, sort_timer;
+	const size_t record_size = 16;
+	const size_t bytes = total * record_size;
+	bool ok = writeExternalFile(EXTERNAL_INPUT, externalTestRecords(record_size, 0, total, false));
+	const libmorton::morton_aabb<float, 3> box = { { 0, 0, 0 }, { 1, 1, 1 } };
+	libmorton::morton_external_sort_options options;
+	options.memory = bytes / 4;
+
+	for (size_t t = 0; t < times; t++) {
+		copy_timer.start();
+		FILE* in = fopen(EXTERNAL_INPUT, "rb");
+		FILE* out = fopen(EXTERNAL_OUTPUT, "wb");
+		ok &= in != nullptr && out != nullptr;
+		vector<unsigned char> buffer(size_t(1) << 20);
+		for (size_t got; ok && (got = fread(buffer.data(), 1, buffer.size(), in)) > 0;) {
+			ok &= fwrite(buffer.data(), 1, got, out) == got;
+		}
+		if (in != nullptr) { fclose(in); }
+		if (out != nullptr) { fclose(out); }
+		copy_timer.stop();
+		sort_timer.start();
+		ok &= libmorton::morton_external_sort(EXTERNAL_INPUT, EXTERNAL_OUTPUT, record_size, libmorton::morton_quantized_key<float>(0, box), options);
+		sort_timer.stop();
+	}
+	remove(EXTERNAL_INPUT);
+	remove(EXTERNAL_OUTPUT);
+	running_sums.push_back(ok);
+
+	const double megabytes = static_cast<double>(bytes) / (1 << 20);
+	stringstream os;
+	os << setfill('0') << std::setw(6) << std::fixed << std::setprecision(3)
+		<< sort_timer.elapsed_time_milliseconds / (float)times << " ms (" << setprecision(0) << megabytes * 1000 * times / sort_timer.elapsed_time_milliseconds << " MB/s) : external sort, "
+		<< setprecision(3) << copy_timer.elapsed_time_milliseconds / (float)times << " ms (" << setprecision(0) << megabytes * 1000 * times / copy_timer.elapsed_time_milliseconds << " MB/s) : file copy"
+		<< (ok ? "" : " (failed)");
+	return os.str();
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include "libmorton_test.h"
+
+using namespace std;
+
+// Config variables (defined elsewhere)
+extern size_t total;
+extern size_t MAX;
+extern unsigned int times;
+extern vector<uint_fast64_t> running_sums;
+
+// Fill a grid of side^3 elements from a row-major array, and check every element against the control encoder, the
+// element access methods, both iteration orders, copying back, and a sub-box view
+static bool checkGrid3DFunction(const uint32_t requested, const uint32_t side) {
+	libmorton::morton_grid<uint32_t, 3> grid(requested);
+	bool ok = grid.side() == side && grid.size() == size_t(side) * side * side;
+	vector<uint32_t> linear(grid.size());
+	for (size_t i = 0; i < linear.size(); i++) { linear[i] = static_cast<uint32_t>(rand()); }
+	grid.copy_from(linear.data());
+	for (uint32_t z = 0; ok && z < side; z++) {
+		for (uint32_t y = 0; ok && y < side; y++) {
+			for (uint32_t x = 0; ok && x < side; x++) {
+				const uint32_t value = linear[(size_t(z) * side + y) * side + x];
+				ok &= grid[control_encode(static_cast<uint64_t>(x), static_cast<uint64_t>(y), static_cast<uint64_t>(z))] == value;
+				ok &= grid(x, y, z) == value;
+			}
+		}
+	}
+	// Z-order iteration visits the storage, x-major iteration visits the row-major array
+	ok &= static_cast<size_t>(grid.end() - grid.begin()) == grid.size() && grid.begin() == grid.data();
+	const libmorton::morton_grid<uint32_t, 3>& constant = grid;
+	size_t visited = 0;
+	for (auto it = constant.x_major_begin(); ok && it != constant.x_major_end(); ++it, ++visited) {
+		ok &= *it == linear[visited];
+	}
+	ok &= visited == grid.size();
+	vector<uint32_t> back(grid.size(), 0);
+	grid.copy_to(back.data());
+	ok &= back == linear;
+
+	// A box inside the grid: iterated in x-major order, written through the view
+	if (side >= 4) {
+		const array<uint32_t, 3> lo = { { 1, side / 2, 3 } }, extent = { { side - 2, side / 2 - 1, 1 } };
+		auto box = grid.view(lo, extent);
+		ok &= box.size() == size_t(extent[0]) * extent[1] * extent[2];
+		vector<uint32_t> inside(box.size());
+		box.copy_to(inside.data());
+		size_t i = 0;
+		for (uint32_t z = 0; z < extent[2]; z++) {
+			for (uint32_t y = 0; y < extent[1]; y++) {
+				for (uint32_t x = 0; x < extent[0]; x++, i++) {
+					ok &= inside[i] == linear[(size_t(lo[2] + z) * side + lo[1] + y) * side + lo[0] + x];
+					ok &= box(x, y, z) == inside[i];
+				}
+			}
+		}
+		for (size_t j = 0; j < inside.size(); j++) { inside[j] = static_cast<uint32_t>(j); }
+		box.copy_from(inside.data());
+		grid.copy_to(back.data());
+		size_t changed = 0;
+		for (size_t j = 0; j < back.size(); j++) { changed += back[j] != linear[j]; }
+		ok &= changed <= inside.size() && grid(lo[0], lo[1], lo[2]) == 0 && grid(lo[0] + extent[0] - 1, lo[1] + extent[1] - 1, lo[2]) == inside.size() - 1;
+		box.fill(7u);
+		ok &= count(grid.begin(), grid.end(), 7u) >= static_cast<ptrdiff_t>(box.size()) && count(constant.view(lo, extent).begin(), constant.view(lo, extent).end(), 7u) == static_cast<ptrdiff_t>(box.size());
+	}
+	grid.fill(5);
+	ok &= count(grid.begin(), grid.end(), 5u) == static_cast<ptrdiff_t>(grid.size());
+	if (!ok) {
+		cout << endl << "    Incorrect 3D grid of side " << side << " (requested " << requested << ")" << endl;
+	}
+	return ok;
+}
+
+static bool checkGrid2DFunction(const uint32_t side) {
+	libmorton::morton_grid<uint16_t, 2> grid(side);
+	bool ok = grid.side() == side && grid.size() == size_t(side) * side;
+	vector<uint16_t> linear(grid.size());
+	for (size_t i = 0; i < linear.size(); i++) { linear[i] = static_cast<uint16_t>(rand()); }
+	grid.copy_from(linear.data());
+	for (uint32_t y = 0; ok && y < side; y++) {
+		for (uint32_t x = 0; ok && x < side; x++) {
+			ok &= grid[control_encode(static_cast<uint64_t>(x), static_cast<uint64_t>(y))] == linear[size_t(y) * side + x] && grid(x, y) == linear[size_t(y) * side + x];
+		}
+	}
+	size_t visited = 0;
+	for (auto it = grid.x_major_begin(); ok && it != grid.x_major_end(); it++, visited++) {
+		ok &= *it == linear[visited] && it.code() == libmorton::morton2D_64_encode(it.coordinate(0), it.coordinate(1));
+	}
+	ok &= visited == grid.size();
+	vector<uint16_t> back(grid.size(), 0);
+	grid.copy_to(back.data());
+	ok &= back == linear;
+	if (!ok) {
+		cout << endl << "    Incorrect 2D grid of side " << side << endl;
+	}
+	return ok;
+}
+
+inline void checkGridCorrectness() {
+	printf("++ Checking correctness of morton grid methods ... ");
+	bool ok = true;
+	// Sides which are a power of 2, rounded up, and the smallest grids
+	ok &= checkGrid3DFunction(32, 32);
+	ok &= checkGrid3DFunction(5, 8);
+	ok &= checkGrid3DFunction(3, 4);
+	ok &= checkGrid3DFunction(2, 2);
+	ok &= checkGrid3DFunction(1, 1);
+	ok &= checkGrid3DFunction(0, 0);
+	ok &= checkGrid2DFunction(256);
+	ok &= checkGrid2DFunction(2);
+	ok &= checkGrid2DFunction(1);
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
+// Test performance of visiting a grid of about total elements in x-major order: with the x-major iterator, with an
+// encode per element, and in a row-major array. Then of converting it from and to a row-major array.
+static std::string testGrid_Perf(size_t times) {
+	Timer iterator_timer, encode_timer, linear_timer, copy_from_timer, copy_to_timer;
+	uint32_t side = 1;
+	while (size_t(side) * side * side * 8 <= total) { side *= 2; }
+	libmorton::morton_grid<float, 3> grid(side);
+	vector<float> linear(grid.size());
+	for (size_t i = 0; i < linear.size(); i++) { linear[i] = static_cast<float>(i % 1000); }
+
+	for (size_t t = 0; t < times; t++) {
+		copy_from_timer.start();
+		grid.copy_from(linear.data());
+		copy_from_timer.stop();
+		float sum = 0, encode_sum = 0, linear_sum = 0;
+		iterator_timer.start();
+		for (auto it = grid.x_major_begin(); it != grid.x_major_end(); ++it) { sum += *it; }
+		iterator_timer.stop();
+		encode_timer.start();
+		for (uint32_t z = 0; z < side; z++) {
+			for (uint32_t y = 0; y < side; y++) {
+				for (uint32_t x = 0; x < side; x++) { encode_sum += grid(x, y, z); }
+			}
+		}
+		encode_timer.stop();
+		linear_timer.start();
+		for (size_t i = 0; i < linear.size(); i++) { linear_sum += linear[i]; }
+		linear_timer.stop();
+		copy_to_timer.start();
+		grid.copy_to(linear.data());
+		copy_to_timer.stop();
+		running_sums.push_back(static_cast<uint_fast64_t>(sum + encode_sum + linear_sum));
+	}
+
+	const double elements = static_cast<double>(grid.size()) * times / 1000;
+	stringstream os;
+	os << side << "^3 floats: " << std::fixed << std::setprecision(1)
+		<< elements / iterator_timer.elapsed_time_milliseconds << " M/s x-major iterator, "
+		<< elements / encode_timer.elapsed_time_milliseconds << " M/s encode per element, "
+		<< elements / linear_timer.elapsed_time_milliseconds << " M/s row-major array, "
+		<< elements / copy_from_timer.elapsed_time_milliseconds << " M/s copy_from, "
+		<< elements / copy_to_timer.elapsed_time_milliseconds << " M/s copy_to";
+	return os.str();
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "libmorton_test.h"
+#include "libmorton_test_parallel.h"
+
+using namespace std;
+
+// Config variables (defined elsewhere)
+extern size_t total;
+extern size_t MAX;
+extern unsigned int times;
+extern vector<uint_fast64_t> running_sums;
+
+// Nodes of an octree built by recursive subdivision, in the layout of morton_octree
+template <typename index>
+static void octreeReference(const vector<uint64_t>& codes, const size_t max_points, const uint64_t cell, const unsigned int level, const size_t begin, const size_t end, libmorton::morton_octree<index>& tree) {
+	const size_t node = tree.keys.size();
+	tree.keys.push_back(cell);
+	tree.levels.push_back(static_cast<uint8_t>(level));
+	tree.child_masks.push_back(0);
+	tree.points.push_back(static_cast<index>(begin));
+	tree.next.push_back(0);
+	if (end - begin > max_points && level < libmorton::m3D_levels<uint64_t>()) {
+		for (unsigned int i = 0; i < 8; i++) {
+			const uint64_t child = libmorton::m3D_child<uint64_t>(cell, level, i);
+			const size_t b = lower_bound(codes.begin() + begin, codes.begin() + end, child) - codes.begin();
+			const size_t e = upper_bound(codes.begin() + begin, codes.begin() + end, libmorton::m3D_cell_last<uint64_t>(child, level + 1)) - codes.begin();
+			if (b == e) { continue; }
+			tree.child_masks[node] = static_cast<uint8_t>(tree.child_masks[node] | (1u << i));
+			octreeReference(codes, max_points, child, level + 1, b, e, tree);
+		}
+	}
+	tree.next[node] = static_cast<index>(tree.keys.size());
+}
+
+// Sorted random codes in clusters sharing their top bits up to a random level, with repeated codes
+static vector<uint64_t> octreeTestCodes(const size_t count) {
+	vector<uint64_t> codes(count);
+	uint64_t base = 0;
+	for (size_t i = 0; i < count; i++) {
+		const uint64_t r = ((static_cast<uint64_t>(rand()) << 42) ^ (static_cast<uint64_t>(rand()) << 21) ^ static_cast<uint64_t>(rand())) & 0x7FFFFFFFFFFFFFFFull;
+		const unsigned int shared = static_cast<unsigned int>(rand() % 22);
+		codes[i] = rand() % 8 == 0 ? base : libmorton::m3D_cell<uint64_t>(base, shared) | (r & ~libmorton::m3D_cell<uint64_t>(~uint64_t(0), shared) & 0x7FFFFFFFFFFFFFFFull);
+		base = rand() % 64 == 0 ? r : codes[i];
+	}
+	sort(codes.begin(), codes.end());
+	return codes;
+}
+
+// Build the octree of codes on executor, and compare every node array with the recursive build
+template <typename index>
+static bool checkOctreeFunction(const vector<uint64_t>& codes, const size_t max_points, libmorton::morton_executor& executor) {
+	const libmorton::morton_octree<index> tree = libmorton::morton_build_octree<index>(codes.data(), codes.size(), max_points, executor);
+	libmorton::morton_octree<index> reference;
+	if (!codes.empty()) { octreeReference(codes, max_points, 0, 0, 0, codes.size(), reference); }
+	reference.points.push_back(static_cast<index>(codes.size()));
+	bool ok = tree.keys == reference.keys && tree.levels == reference.levels && tree.child_masks == reference.child_masks
+		&& tree.points == reference.points && tree.next == reference.next;
+	for (size_t node = 0; ok && node < tree.size(); node++) {
+		ok &= tree.point_end(node) - tree.point_begin(node) <= max_points || !tree.leaf(node) || tree.levels[node] == libmorton::m3D_levels<uint64_t>();
+	}
+	if (!ok) {
+		cout << endl << "    Incorrect octree of " << codes.size() << " codes with at most " << max_points << " points per leaf (" << tree.size() << " nodes instead of " << reference.size() << ")" << endl;
+	}
+	return ok;
+}
+
+inline void checkOctreeCorrectness() {
+	printf("++ Checking correctness of octree build methods ... ");
+	libmorton::morton_thread_pool pool(4);
+	reverse_executor reverse;
+	libmorton::morton_executor* executors[] = { &pool, &reverse };
+	// Several blocks of points, down to one point per leaf
+	const vector<uint64_t> codes = octreeTestCodes(200000);
+	// A root leaf, and no points at all
+	const vector<uint64_t> few = octreeTestCodes(5), none;
+	// One code: a chain of nodes down to a leaf of the deepest level
+	const vector<uint64_t> same(1000, 0x123456789ABCDEFull);
+	bool ok = true;
+	for (libmorton::morton_executor* executor : executors) {
+		ok &= checkOctreeFunction<uint32_t>(codes, 1, *executor);
+		ok &= checkOctreeFunction<uint32_t>(codes, 16, *executor);
+		ok &= checkOctreeFunction<uint64_t>(codes, 100, *executor);
+		// Windows of more than one block of points
+		ok &= checkOctreeFunction<uint32_t>(codes, 100000, *executor);
+		// Leaves large enough for all points: only the root
+		ok &= checkOctreeFunction<uint32_t>(codes, codes.size(), *executor);
+		ok &= checkOctreeFunction<uint32_t>(few, SIZE_MAX, *executor);
+		ok &= checkOctreeFunction<uint32_t>(few, 8, *executor);
+		ok &= checkOctreeFunction<uint32_t>(few, 2, *executor);
+		ok &= checkOctreeFunction<uint32_t>(none, 8, *executor);
+		ok &= checkOctreeFunction<uint64_t>(same, 4, *executor);
+	}
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
+// Test performance of building the octree of sorted codes, with at most max_points points per leaf: build time,
+// nodes and memory of the node arrays
+static std::string testOctree_Perf(const vector<uint64_t>& codes, const size_t max_points, size_t times) {
+	Timer timer;
+	size_t nodes = 0, memory = 0;
+	for (size_t t = 0; t < times; t++) {
+		timer.start();
+		const libmorton::morton_octree<uint32_t> tree = libmorton::morton_build_octree<uint32_t>(codes.data(), codes.size(), max_points);
+		timer.stop();
+		nodes = tree.size();
+		memory = tree.memory();
+		running_sums.push_back(tree.keys[nodes / 2] + tree.next[nodes / 3]);
+	}
+	stringstream os;
+	os << setfill('0') << std::setw(6) << std::fixed << std::setprecision(3) << timer.elapsed_time_milliseconds / (float)times << " ms, "
+		<< nodes << " nodes, " << setprecision(1) << static_cast<double>(memory) / (1 << 20) << " MB ("
+		<< setprecision(2) << static_cast<double>(memory) / codes.size() << " bytes per point)";
+	return os.str();
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "libmorton_test.h"
+
+using namespace std;
+
+// The 2D / 3D order-preserving methods, by number of dimensions: encode / decode value v on one axis, the others 0
+template <typename morton, typename T, size_t N> struct ordered_methods;
+template <typename morton, typename T> struct ordered_methods<morton, T, 2> {
+	static morton encode(const T v, const unsigned int axis) {
+		return axis == 0 ? libmorton::m2D_e_ordered<morton, T>(v, T(0)) : libmorton::m2D_e_ordered<morton, T>(T(0), v);
+	}
+	static T decode(const morton m, const unsigned int axis) {
+		T c[2];
+		libmorton::m2D_d_ordered<morton, T>(m, c[0], c[1]);
+		return c[axis];
+	}
+};
+template <typename morton, typename T> struct ordered_methods<morton, T, 3> {
+	static morton encode(const T v, const unsigned int axis) {
+		return axis == 0 ? libmorton::m3D_e_ordered<morton, T>(v, T(0), T(0)) : axis == 1 ? libmorton::m3D_e_ordered<morton, T>(T(0), v, T(0)) : libmorton::m3D_e_ordered<morton, T>(T(0), T(0), v);
+	}
+	static T decode(const morton m, const unsigned int axis) {
+		T c[3];
+		libmorton::m3D_d_ordered<morton, T>(m, c[0], c[1], c[2]);
+		return c[axis];
+	}
+};
+
+// Random values of T (no NaNs), and the extremes, zeros (both signs for floats) and ones
+template <typename T>
+static vector<T> orderedTestValues() {
+	vector<T> values = { T(0), T(1), static_cast<T>(-T(1)), std::numeric_limits<T>::lowest(), std::numeric_limits<T>::max(), std::numeric_limits<T>::min() };
+	if (std::numeric_limits<T>::has_infinity) {
+		values.push_back(-std::numeric_limits<T>::min());
+		values.push_back(std::numeric_limits<T>::infinity());
+		values.push_back(-std::numeric_limits<T>::infinity());
+		values.push_back(-T(0));
+		values.push_back(std::numeric_limits<T>::denorm_min());
+	}
+	while (values.size() < 5000) {
+		const uint64_t r = (static_cast<uint64_t>(rand()) << 42) ^ (static_cast<uint64_t>(rand()) << 21) ^ static_cast<uint64_t>(rand()) ^ (static_cast<uint64_t>(rand()) << 60);
+		T v;
+		memcpy(&v, &r, sizeof(v));
+		if (v == v) { values.push_back(v); }
+	}
+	// -0.0 before +0.0
+	std::sort(values.begin(), values.end(), [](const T a, const T b) { return a < b || (a == b && std::signbit(a) && !std::signbit(b)); });
+	return values;
+}
+
+// Check that codes keep the order of the values on every axis (strictly where the coordinates fit the code), and that
+// decoding returns the value (or, where the coordinates do not fit, a value no larger with the same code)
+template <size_t N, typename morton, typename T>
+static bool checkOrderedFunctions() {
+	typedef ordered_methods<morton, T, N> ops;
+	const bool exact = sizeof(T) * 8 <= sizeof(morton) * 8 / N;
+	const vector<T> values = orderedTestValues<T>();
+
+	bool everything_okay = true;
+	for (unsigned int axis = 0; axis < N; axis++) {
+		for (size_t i = 0; i < values.size(); i++) {
+			const morton code = ops::encode(values[i], axis);
+			const T decoded = ops::decode(code, axis);
+			bool ok = exact ? memcmp(&decoded, &values[i], sizeof(T)) == 0 : decoded <= values[i] && ops::encode(decoded, axis) == code;
+			if (i > 0) {
+				const morton previous = ops::encode(values[i - 1], axis);
+				ok &= exact && memcmp(&values[i - 1], &values[i], sizeof(T)) != 0 ? previous < code : previous <= code;
+			}
+			if (!ok) {
+				everything_okay = false;
+				cout << endl << "    Incorrect " << N << "D order-preserving encoding of " << +values[i] << " on axis " << axis << endl;
+			}
+		}
+	}
+	return everything_okay;
+}
+
+template <size_t N, typename morton, typename T>
+inline void checkOrderedCorrectness(const char* type) {
+	printf("++ Checking correctness of %luD order-preserving (%lu bit, %s) methods ... ", N, sizeof(morton) * 8, type);
+	checkOrderedFunctions<N, morton, T>() ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
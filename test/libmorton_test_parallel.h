@@ -0,0 +1,142 @@
+#pragma once
+#include "libmorton_test.h"
+#include "libmorton_test_2D.h"
+#include "libmorton_test_3D.h"
+
+using namespace std;
+
+// Config variables (defined elsewhere)
+extern size_t total;
+extern size_t MAX;
+extern unsigned int times;
+extern vector<uint_fast64_t> running_sums;
+
+// Runs the tasks of a call one by one, last task first: checks the parallel methods only rely on morton_executor
+struct reverse_executor : public libmorton::morton_executor {
+	unsigned int concurrency() const override { return 4; }
+	void run(size_t tasks, const std::function<void(size_t)>& task) override {
+		for (size_t i = tasks; i > 0; --i) { task(i - 1); }
+	}
+};
+
+// Executor of the parallel methods under test (the batch wrappers take plain function pointers)
+static libmorton::morton_executor* parallel_test_executor = nullptr;
+
+// Check the parallel batch methods with the batch checks, on a pool of 4 threads and on reverse_executor. The 3D
+// 64-bit checks encode and decode more than two chunks of codes, so these get split over the threads.
+inline void checkParallelCorrectness() {
+	libmorton::morton_thread_pool pool(4);
+	reverse_executor reverse;
+	libmorton::morton_executor* executors[] = { &pool, &reverse };
+	for (libmorton::morton_executor* executor : executors) {
+		parallel_test_executor = executor;
+		check3D_EncodeBatchCorrectness<uint64_t, uint32_t, 64>({ encode_batch_3D_64_wrapper("morton.h (parallel)",
+			[](const uint32_t* x, const uint32_t* y, const uint32_t* z, uint64_t* out, size_t n) { libmorton::morton3D_64_encode_batch_parallel(x, y, z, out, n, *parallel_test_executor); }) });
+		check3D_EncodeBatchCorrectness<uint32_t, uint16_t, 32>({ encode_batch_3D_32_wrapper("morton.h (parallel)",
+			[](const uint16_t* x, const uint16_t* y, const uint16_t* z, uint32_t* out, size_t n) { libmorton::morton3D_32_encode_batch_parallel(x, y, z, out, n, *parallel_test_executor); }) });
+		check3D_DecodeBatchCorrectness<uint64_t, uint32_t, 64>({ decode_batch_3D_64_wrapper("morton.h (parallel)",
+			[](const uint64_t* m, uint32_t* x, uint32_t* y, uint32_t* z, size_t n) { libmorton::morton3D_64_decode_batch_parallel(m, x, y, z, n, *parallel_test_executor); }) });
+		check3D_DecodeBatchCorrectness<uint32_t, uint16_t, 32>({ decode_batch_3D_32_wrapper("morton.h (parallel)",
+			[](const uint32_t* m, uint16_t* x, uint16_t* y, uint16_t* z, size_t n) { libmorton::morton3D_32_decode_batch_parallel(m, x, y, z, n, *parallel_test_executor); }) });
+		check2D_EncodeBatchCorrectness<uint64_t, uint32_t, 64>({ encode_batch_2D_64_wrapper("morton.h (parallel)",
+			[](const uint32_t* x, const uint32_t* y, uint64_t* out, size_t n) { libmorton::morton2D_64_encode_batch_parallel(x, y, out, n, *parallel_test_executor); }) });
+		check2D_EncodeBatchCorrectness<uint32_t, uint16_t, 32>({ encode_batch_2D_32_wrapper("morton.h (parallel)",
+			[](const uint16_t* x, const uint16_t* y, uint32_t* out, size_t n) { libmorton::morton2D_32_encode_batch_parallel(x, y, out, n, *parallel_test_executor); }) });
+		check2D_DecodeBatchCorrectness<uint64_t, uint32_t, 64>({ decode_batch_2D_64_wrapper("morton.h (parallel)",
+			[](const uint64_t* m, uint32_t* x, uint32_t* y, size_t n) { libmorton::morton2D_64_decode_batch_parallel(m, x, y, n, *parallel_test_executor); }) });
+		check2D_DecodeBatchCorrectness<uint32_t, uint16_t, 32>({ decode_batch_2D_32_wrapper("morton.h (parallel)",
+			[](const uint32_t* m, uint16_t* x, uint16_t* y, size_t n) { libmorton::morton2D_32_decode_batch_parallel(m, x, y, n, *parallel_test_executor); }) });
+	}
+	parallel_test_executor = nullptr;
+}
+
+// Thread counts of the scaling benchmark: powers of two below the number of hardware threads, and that number
+inline vector<unsigned int> scalingThreads() {
+	const unsigned int hardware = max(1u, std::thread::hardware_concurrency());
+	vector<unsigned int> threads;
+	for (unsigned int t = 1; t < hardware; t *= 2) { threads.push_back(t); }
+	threads.push_back(hardware);
+	return threads;
+}
+
+// Codes per call in the small calls of the scaling benchmark
+static const size_t SCALING_CALL_SIZE = size_t(1) << 16;
+
+// Time f(begin, end) over all codes on every pool: in one call, and in calls of SCALING_CALL_SIZE codes
+template <typename function>
+static std::string testParallel_Scaling(const vector<unique_ptr<libmorton::morton_thread_pool>>& pools, const function& f, size_t times) {
+	stringstream os;
+	os << setfill('0') << std::fixed << std::setprecision(3);
+	for (size_t p = 0; p < pools.size(); p++) {
+		Timer whole, calls;
+		for (size_t t = 0; t < times; t++) {
+			whole.start();
+			libmorton::morton_parallel_for(total, f, *pools[p]);
+			whole.stop();
+			calls.start();
+			for (size_t begin = 0; begin < total; begin += SCALING_CALL_SIZE) {
+				const size_t end = min(total, begin + SCALING_CALL_SIZE);
+				libmorton::morton_parallel_for(end - begin, [&](size_t b, size_t e) { f(begin + b, begin + e); }, *pools[p]);
+			}
+			calls.stop();
+		}
+		os << (p > 0 ? ", " : "") << std::setw(6) << whole.elapsed_time_milliseconds / (float)times << " ms "
+			<< std::setw(6) << calls.elapsed_time_milliseconds / (float)times << " ms";
+	}
+	return os.str();
+}
+
+// Scaling of every registered 3D batch encode / decode method over random coordinates
+template <typename morton, typename coord>
+static void testParallel_3D_Scaling(const vector<unique_ptr<libmorton::morton_thread_pool>>& pools, const vector<encode_batch_f_3D_wrapper<morton, coord>>& encoders,
+	const vector<decode_batch_f_3D_wrapper<morton, coord>>& decoders, const char* width) {
+	const coord maximum = static_cast<coord>(uint64_t(1) << (sizeof(morton) * 8 / 3));
+	vector<coord> x(total), y(total), z(total);
+	vector<morton> codes(total);
+	for (size_t i = 0; i < total; i++) {
+		x[i] = static_cast<coord>(rand() % maximum);
+		y[i] = static_cast<coord>(rand() % maximum);
+		z[i] = static_cast<coord>(rand() % maximum);
+	}
+	morton runningsum = 0;
+	for (auto it = encoders.begin(); it != encoders.end(); it++) {
+		const auto encode = (*it).encode;
+		cout << "    " << testParallel_Scaling(pools, [&](size_t b, size_t e) { encode(x.data() + b, y.data() + b, z.data() + b, codes.data() + b, e - b); }, times)
+			<< " : " << width << " batch encode " << (*it).description << endl;
+		runningsum += codes[total / 2];
+	}
+	for (auto it = decoders.begin(); it != decoders.end(); it++) {
+		const auto decode = (*it).decode;
+		cout << "    " << testParallel_Scaling(pools, [&](size_t b, size_t e) { decode(codes.data() + b, x.data() + b, y.data() + b, z.data() + b, e - b); }, times)
+			<< " : " << width << " batch decode " << (*it).description << endl;
+		runningsum += x[total / 2] + y[total / 3] + z[total / 4];
+	}
+	running_sums.push_back(runningsum);
+}
+
+// Scaling of every registered 2D batch encode / decode method over random coordinates
+template <typename morton, typename coord>
+static void testParallel_2D_Scaling(const vector<unique_ptr<libmorton::morton_thread_pool>>& pools, const vector<encode_batch_f_2D_wrapper<morton, coord>>& encoders,
+	const vector<decode_batch_f_2D_wrapper<morton, coord>>& decoders, const char* width) {
+	const coord maximum = static_cast<coord>(~coord(0));
+	vector<coord> x(total), y(total);
+	vector<morton> codes(total);
+	for (size_t i = 0; i < total; i++) {
+		x[i] = static_cast<coord>(rand() % maximum);
+		y[i] = static_cast<coord>(rand() % maximum);
+	}
+	morton runningsum = 0;
+	for (auto it = encoders.begin(); it != encoders.end(); it++) {
+		const auto encode = (*it).encode;
+		cout << "    " << testParallel_Scaling(pools, [&](size_t b, size_t e) { encode(x.data() + b, y.data() + b, codes.data() + b, e - b); }, times)
+			<< " : " << width << " batch encode " << (*it).description << endl;
+		runningsum += codes[total / 2];
+	}
+	for (auto it = decoders.begin(); it != decoders.end(); it++) {
+		const auto decode = (*it).decode;
+		cout << "    " << testParallel_Scaling(pools, [&](size_t b, size_t e) { decode(codes.data() + b, x.data() + b, y.data() + b, e - b); }, times)
+			<< " : " << width << " batch decode " << (*it).description << endl;
+		runningsum += x[total / 2] + y[total / 3];
+	}
+	running_sums.push_back(runningsum);
+}
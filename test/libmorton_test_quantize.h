@@ -0,0 +1,164 @@
+#pragma once
+#include "libmorton_test.h"
+#include "libmorton_test_ND.h"
+
+using namespace std;
+
+// Config variables (defined elsewhere)
+extern size_t total;
+extern size_t MAX;
+extern unsigned int times;
+extern vector<uint_fast64_t> running_sums;
+
+// The 2D / 3D quantize methods, by number of dimensions: separate arrays (SoA), or one array of N + 1 values per position (AoS)
+template <typename morton, typename real, size_t N> struct quantize_methods;
+template <typename morton, typename real> struct quantize_methods<morton, real, 2> {
+	static void encode(const vector<real> (&c)[2], const libmorton::morton_aabb<real, 2>& box, morton* out) {
+		libmorton::m2D_quantize_encode<morton, real>(c[0].data(), c[1].data(), box, out, c[0].size());
+	}
+	static void encode(const vector<real>& p, const libmorton::morton_aabb<real, 2>& box, morton* out) {
+		libmorton::m2D_quantize_encode<morton, real>(p.data(), 3, box, out, p.size() / 3);
+	}
+	static void decode(const vector<morton>& m, const libmorton::morton_aabb<real, 2>& box, vector<real> (&c)[2]) {
+		libmorton::m2D_decode_dequantize<morton, real>(m.data(), box, c[0].data(), c[1].data(), m.size());
+	}
+	static void decode(const vector<morton>& m, const libmorton::morton_aabb<real, 2>& box, vector<real>& p) {
+		libmorton::m2D_decode_dequantize<morton, real>(m.data(), box, p.data(), 3, m.size());
+	}
+};
+template <typename morton, typename real> struct quantize_methods<morton, real, 3> {
+	static void encode(const vector<real> (&c)[3], const libmorton::morton_aabb<real, 3>& box, morton* out) {
+		libmorton::m3D_quantize_encode<morton, real>(c[0].data(), c[1].data(), c[2].data(), box, out, c[0].size());
+	}
+	static void encode(const vector<real>& p, const libmorton::morton_aabb<real, 3>& box, morton* out) {
+		libmorton::m3D_quantize_encode<morton, real>(p.data(), 4, box, out, p.size() / 4);
+	}
+	static void decode(const vector<morton>& m, const libmorton::morton_aabb<real, 3>& box, vector<real> (&c)[3]) {
+		libmorton::m3D_decode_dequantize<morton, real>(m.data(), box, c[0].data(), c[1].data(), c[2].data(), m.size());
+	}
+	static void decode(const vector<morton>& m, const libmorton::morton_aabb<real, 3>& box, vector<real>& p) {
+		libmorton::m3D_decode_dequantize<morton, real>(m.data(), box, p.data(), 4, m.size());
+	}
+};
+
+// Check quantized encoding against the cells of the positions computed in double precision (allowing a quarter
+// cell of rounding), for positions inside and around random boxes. SoA and AoS must agree, and decoded positions
+// must be the cell centers.
+template <size_t N, typename morton, typename real, size_t bits>
+static bool checkQuantizeFunctions() {
+	typedef quantize_methods<morton, real, N> ops;
+	static const size_t fieldbits = bits / N;
+	static const size_t count = 1000;
+	const double cells = static_cast<double>(uint64_t(1) << fieldbits);
+
+	bool everything_okay = true;
+	for (unsigned int v = 0; v < 64; v++) {
+		libmorton::morton_aabb<real, N> box;
+		vector<real> soa[N], aos((N + 1) * count);
+		for (size_t d = 0; d < N; d++) {
+			box.lo[d] = static_cast<real>(rand() % 2000 - 1000) / 8;
+			box.hi[d] = box.lo[d] + static_cast<real>(rand() % 1000 + 1) / 8;
+			soa[d].resize(count);
+			for (size_t i = 0; i < count; i++) {
+				// A tenth of the positions lie outside the box, a few exactly on its faces
+				const double t = (rand() % 1200 - 100) / 1000.0;
+				soa[d][i] = i % 100 == 0 ? box.lo[d] : i % 100 == 1 ? box.hi[d] : static_cast<real>(box.lo[d] + t * (box.hi[d] - box.lo[d]));
+				aos[i * (N + 1) + d] = soa[d][i];
+			}
+		}
+		vector<morton> codes(count), aos_codes(count), center_codes(count);
+		ops::encode(soa, box, codes.data());
+		ops::encode(aos, box, aos_codes.data());
+		bool ok = codes == aos_codes;
+		for (size_t i = 0; i < count; i++) {
+			std::array<uint64_t, N> c;
+			control_decode_ND<N>(codes[i], c, std::make_index_sequence<N>());
+			for (size_t d = 0; d < N; d++) {
+				const double e = (static_cast<double>(soa[d][i]) - box.lo[d]) * cells / (static_cast<double>(box.hi[d]) - box.lo[d]);
+				const double clamped = min(max(e, 0.5), cells - 0.5);
+				ok &= fabs(static_cast<double>(c[d]) + 0.5 - clamped) <= 0.75;
+			}
+		}
+
+		vector<real> centers[N], aos_centers((N + 1) * count);
+		for (size_t d = 0; d < N; d++) { centers[d].resize(count); }
+		ops::decode(codes, box, centers);
+		ops::decode(codes, box, aos_centers);
+		for (size_t i = 0; i < count; i++) {
+			std::array<uint64_t, N> c;
+			control_decode_ND<N>(codes[i], c, std::make_index_sequence<N>());
+			for (size_t d = 0; d < N; d++) {
+				const double width = (static_cast<double>(box.hi[d]) - box.lo[d]) / cells;
+				const double tolerance = 2 * std::numeric_limits<real>::epsilon() * (fabs(static_cast<double>(box.lo[d])) + fabs(static_cast<double>(box.hi[d])));
+				ok &= fabs(centers[d][i] - (box.lo[d] + (c[d] + 0.5) * width)) <= tolerance;
+				ok &= aos_centers[i * (N + 1) + d] == centers[d][i];
+			}
+		}
+		// Centers only encode to the same cells if real can tell the cells apart
+		if (fieldbits + 8 <= static_cast<size_t>(std::numeric_limits<real>::digits)) {
+			ops::encode(centers, box, center_codes.data());
+			ok &= center_codes == codes;
+		}
+		if (!ok) {
+			everything_okay = false;
+			cout << endl << "    Incorrect " << N << "D quantized encoding in box (" << box.lo[0] << ", " << box.lo[1] << ", ...) - (" << box.hi[0] << ", " << box.hi[1] << ", ...)" << endl;
+		}
+	}
+	return everything_okay;
+}
+
+template <size_t N, typename morton, typename real, size_t bits>
+inline void checkQuantizeCorrectness() {
+	printf("++ Checking correctness of %luD quantize (%lu bit, %s) methods ... ", N, bits, sizeof(real) == 4 ? "float" : "double");
+	checkQuantizeFunctions<N, morton, real, bits>() ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
+static inline void batch_encode_3D(const uint16_t* x, const uint16_t* y, const uint16_t* z, uint32_t* out, size_t n) { libmorton::morton3D_32_encode_batch(x, y, z, out, n); }
+static inline void batch_encode_3D(const uint32_t* x, const uint32_t* y, const uint32_t* z, uint64_t* out, size_t n) { libmorton::morton3D_64_encode_batch(x, y, z, out, n); }
+
+// Test performance of encoding MAX^3 float positions in the unit cube: quantized and encoded in one call (SoA, AoS),
+// and quantized into coordinate arrays first, then batch encoded
+template <typename morton, typename coord>
+static std::string testQuantize_3D_Perf(size_t times) {
+	static const unsigned int fieldbits = std::numeric_limits<morton>::digits / 3;
+	Timer soa_timer, aos_timer, separate_timer;
+	morton runningsum = 0;
+	vector<float> x(total), y(total), z(total), p(4 * total);
+	vector<coord> cx(total), cy(total), cz(total);
+	vector<morton> out(total);
+	for (size_t i = 0; i < total; i++) {
+		x[i] = p[4 * i] = static_cast<float>(rand()) / RAND_MAX;
+		y[i] = p[4 * i + 1] = static_cast<float>(rand()) / RAND_MAX;
+		z[i] = p[4 * i + 2] = static_cast<float>(rand()) / RAND_MAX;
+	}
+	const libmorton::morton_aabb<float, 3> box = { { 0, 0, 0 }, { 1, 1, 1 } };
+	const float cells = static_cast<float>(1u << fieldbits), top = cells - 1;
+	const auto quantize = [&](const vector<float>& in, vector<coord>& c) {
+		for (size_t i = 0; i < total; i++) { c[i] = static_cast<coord>(min(max(in[i] * cells, 0.0f), top)); }
+	};
+
+	for (size_t t = 0; t < times; t++) {
+		soa_timer.start();
+		libmorton::m3D_quantize_encode<morton, float>(x.data(), y.data(), z.data(), box, out.data(), total);
+		soa_timer.stop();
+		runningsum += out[total / 2];
+		aos_timer.start();
+		libmorton::m3D_quantize_encode<morton, float>(p.data(), 4, box, out.data(), total);
+		aos_timer.stop();
+		runningsum += out[total / 3];
+		separate_timer.start();
+		quantize(x, cx);
+		quantize(y, cy);
+		quantize(z, cz);
+		batch_encode_3D(cx.data(), cy.data(), cz.data(), out.data(), total);
+		separate_timer.stop();
+		runningsum += out[total / 4];
+	}
+	running_sums.push_back(runningsum);
+
+	stringstream os;
+	os << setfill('0') << std::setw(6) << std::fixed << std::setprecision(3)
+		<< soa_timer.elapsed_time_milliseconds / (float)times << " ms " << aos_timer.elapsed_time_milliseconds / (float)times << " ms : fused (SoA, AoS), "
+		<< separate_timer.elapsed_time_milliseconds / (float)times << " ms : quantize, then batch encode";
+	return os.str();
+}
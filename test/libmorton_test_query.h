@@ -0,0 +1,176 @@
+#pragma once
+#include "libmorton_test.h"
+#include "libmorton_test_ND.h"
+
+using namespace std;
+
+// The 2D / 3D box query methods, by number of dimensions
+template <typename morton, size_t N> struct query_methods;
+template <typename morton> struct query_methods<morton, 2> {
+	static morton bigmin(const morton c, const morton lo, const morton hi) { return libmorton::m2D_bigmin<morton>(c, lo, hi); }
+	static morton litmax(const morton c, const morton lo, const morton hi) { return libmorton::m2D_litmax<morton>(c, lo, hi); }
+	static bool in_box(const morton c, const morton lo, const morton hi) { return libmorton::m2D_in_box<morton>(c, lo, hi); }
+	template <typename visitor> static size_t query(const vector<morton>& codes, const morton lo, const morton hi, visitor&& visit) {
+		return libmorton::m2D_box_query<morton>(codes.data(), codes.size(), lo, hi, visit);
+	}
+	static void ranges(const std::array<uint64_t, 2>& lo, const std::array<uint64_t, 2>& hi, vector<libmorton::morton_range<morton> >& r, const size_t max_ranges) {
+		libmorton::m2D_box_ranges<morton, uint64_t>(lo[0], lo[1], hi[0], hi[1], r, max_ranges);
+	}
+};
+template <typename morton> struct query_methods<morton, 3> {
+	static morton bigmin(const morton c, const morton lo, const morton hi) { return libmorton::m3D_bigmin<morton>(c, lo, hi); }
+	static morton litmax(const morton c, const morton lo, const morton hi) { return libmorton::m3D_litmax<morton>(c, lo, hi); }
+	static bool in_box(const morton c, const morton lo, const morton hi) { return libmorton::m3D_in_box<morton>(c, lo, hi); }
+	template <typename visitor> static size_t query(const vector<morton>& codes, const morton lo, const morton hi, visitor&& visit) {
+		return libmorton::m3D_box_query<morton>(codes.data(), codes.size(), lo, hi, visit);
+	}
+	static void ranges(const std::array<uint64_t, 3>& lo, const std::array<uint64_t, 3>& hi, vector<libmorton::morton_range<morton> >& r, const size_t max_ranges) {
+		libmorton::m3D_box_ranges<morton, uint64_t>(lo[0], lo[1], lo[2], hi[0], hi[1], hi[2], r, max_ranges);
+	}
+};
+
+// Check in_box, BIGMIN and LITMAX against a linear scan over every code between the box corners, and box queries
+// against filtering a sorted array. Boxes of 4 bits per coordinate, at the bottom and at the top of the coordinate range.
+template <size_t N, typename morton, typename coord, size_t bits>
+static bool checkQueryFunctions() {
+	typedef query_methods<morton, N> ops;
+	static const size_t fieldbits = bits / N;
+
+	bool everything_okay = true;
+	for (size_t offset = 0; offset <= fieldbits - 4; offset += fieldbits - 4) {
+		for (unsigned int v = 0; v < 256; v++) {
+			std::array<uint64_t, N> lo, hi;
+			for (size_t i = 0; i < N; i++) {
+				const uint64_t a = rand() & 15, b = rand() & 15;
+				lo[i] = min(a, b) << offset;
+				hi[i] = (max(a, b) << offset) | ((uint64_t(1) << offset) - 1);
+			}
+			const morton min_code = static_cast<morton>(control_encode_ND<N, uint64_t>(lo, std::make_index_sequence<N>()));
+			const morton max_code = static_cast<morton>(control_encode_ND<N, uint64_t>(hi, std::make_index_sequence<N>()));
+
+			// Every code between the corners, with a scaled down step above the lowest bits
+			vector<morton> inside;
+			const morton step = static_cast<morton>(morton(1) << (offset * N));
+			for (morton c = min_code; c <= max_code && c >= min_code; c += step) {
+				std::array<uint64_t, N> p;
+				control_decode_ND<N>(c, p, std::make_index_sequence<N>());
+				bool correct = true;
+				for (size_t i = 0; i < N; i++) { correct &= p[i] >= lo[i] && p[i] <= hi[i]; }
+				if (ops::in_box(c, min_code, max_code) != correct) {
+					everything_okay = false;
+					cout << endl << "    Incorrect in_box of " << c << " in box " << min_code << " - " << max_code << endl;
+				}
+				if (correct) { inside.push_back(c); }
+			}
+			for (morton c = min_code; c <= max_code && c >= min_code; c += step) {
+				if (std::binary_search(inside.begin(), inside.end(), c)) { continue; }
+				const morton correct_bigmin = *std::upper_bound(inside.begin(), inside.end(), c);
+				const morton correct_litmax = *(std::lower_bound(inside.begin(), inside.end(), c) - 1);
+				// With a step above the lowest bits, BIGMIN / LITMAX land on the corners of the scaled down cells
+				const morton computed_bigmin = ops::bigmin(c, min_code, max_code);
+				const morton computed_litmax = static_cast<morton>(ops::litmax(c, min_code, max_code) & ~(step - 1));
+				if (computed_bigmin != correct_bigmin || computed_litmax != correct_litmax) {
+					everything_okay = false;
+					cout << endl << "    Incorrect BIGMIN / LITMAX of " << c << " in box " << min_code << " - " << max_code << ": "
+						<< computed_bigmin << " / " << computed_litmax << " != " << correct_bigmin << " / " << correct_litmax << endl;
+				}
+			}
+
+			// Query a sorted array of codes in and around the box
+			vector<morton> codes;
+			const morton base = min_code >= 64 * step ? static_cast<morton>(min_code - 64 * step) : 0;
+			for (unsigned int i = 0; i < 1000; i++) {
+				const morton c = static_cast<morton>(base + static_cast<morton>(rand() % 4096) * step);
+				std::array<uint64_t, N> p;
+				control_decode_ND<N>(c, p, std::make_index_sequence<N>());
+				// Skip codes which wrapped around, or have bits set above the coordinates
+				if (c >= base && c == static_cast<morton>(control_encode_ND<N, uint64_t>(p, std::make_index_sequence<N>()))) { codes.push_back(c); }
+			}
+			std::sort(codes.begin(), codes.end());
+			vector<size_t> found, correct;
+			const size_t count = ops::query(codes, min_code, max_code, [&](size_t i) { found.push_back(i); });
+			for (size_t i = 0; i < codes.size(); i++) {
+				if (ops::in_box(codes[i], min_code, max_code)) { correct.push_back(i); }
+			}
+			if (found != correct || count != correct.size()) {
+				everything_okay = false;
+				cout << endl << "    Incorrect box query in box " << min_code << " - " << max_code << ": " << count << " codes found, " << correct.size() << " expected" << endl;
+			}
+		}
+	}
+	return everything_okay;
+}
+
+// Check box to ranges against the codes of every cell in the box, for small boxes at the bottom and at the top of the
+// coordinate range. Capped ranges must cover the box with at most max_ranges ranges.
+template <size_t N, typename morton, typename coord, size_t bits>
+static bool checkRangesFunctions() {
+	typedef query_methods<morton, N> ops;
+	static const size_t fieldbits = bits / N;
+	const size_t caps[3] = { 1, 4, 16 };
+
+	bool everything_okay = true;
+	for (size_t offset = 0; offset <= fieldbits - 4; offset += fieldbits - 4) {
+		for (unsigned int v = 0; v < 256; v++) {
+			std::array<uint64_t, N> lo, hi, p;
+			for (size_t i = 0; i < N; i++) {
+				const uint64_t a = rand() & 15, b = rand() & 15;
+				lo[i] = (min(a, b) << offset) | (offset ? (rand() & 15) : 0);
+				hi[i] = (max(a, b) << offset) | (offset ? (rand() & 15) : 0);
+				if (hi[i] < lo[i]) { std::swap(lo[i], hi[i]); }
+				hi[i] = min(hi[i], lo[i] + 12);
+			}
+			vector<morton> cells;
+			p = lo;
+			while (true) {
+				cells.push_back(static_cast<morton>(control_encode_ND<N, uint64_t>(p, std::make_index_sequence<N>())));
+				size_t i = 0;
+				for (; i < N && p[i] == hi[i]; i++) { p[i] = lo[i]; }
+				if (i == N) { break; }
+				p[i]++;
+			}
+			std::sort(cells.begin(), cells.end());
+
+			vector<libmorton::morton_range<morton> > ranges;
+			ops::ranges(lo, hi, ranges, 0);
+			vector<morton> covered;
+			bool disjoint = true;
+			for (size_t r = 0; r < ranges.size(); r++) {
+				disjoint &= r == 0 || ranges[r].lo > ranges[r - 1].hi + 1;
+				for (morton c = ranges[r].lo; c <= ranges[r].hi && covered.size() <= cells.size(); c++) { covered.push_back(c); }
+			}
+			if (covered != cells || !disjoint) {
+				everything_okay = false;
+				cout << endl << "    Incorrect ranges of box (" << lo[0] << ", " << lo[1] << ", ...) - (" << hi[0] << ", " << hi[1] << ", ...): " << ranges.size() << " ranges" << endl;
+			}
+
+			for (size_t cap : caps) {
+				vector<libmorton::morton_range<morton> > capped;
+				ops::ranges(lo, hi, capped, cap);
+				bool ok = capped.size() <= cap && (ranges.size() > cap || capped.size() == ranges.size());
+				size_t r = 0;
+				for (morton c : cells) {
+					while (r < capped.size() && capped[r].hi < c) { r++; }
+					ok &= r < capped.size() && capped[r].lo <= c;
+				}
+				if (!ok) {
+					everything_okay = false;
+					cout << endl << "    Incorrect capped ranges (" << cap << ") of box (" << lo[0] << ", " << lo[1] << ", ...) - (" << hi[0] << ", " << hi[1] << ", ...): " << capped.size() << " ranges" << endl;
+				}
+			}
+		}
+	}
+	return everything_okay;
+}
+
+template <size_t N, typename morton, typename coord, size_t bits>
+inline void checkRangesCorrectness() {
+	printf("++ Checking correctness of %luD box to ranges (%lu bit) methods ... ", N, bits);
+	checkRangesFunctions<N, morton, coord, bits>() ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
+template <size_t N, typename morton, typename coord, size_t bits>
+inline void checkQueryCorrectness() {
+	printf("++ Checking correctness of %luD box query (%lu bit) methods ... ", N, bits);
+	checkQueryFunctions<N, morton, coord, bits>() ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "libmorton_test.h"
+
+using namespace std;
+
+// Config variables (defined elsewhere)
+extern size_t RAND_POOL_SIZE;
+extern size_t total;
+extern size_t MAX;
+extern unsigned int times;
+extern vector<uint_fast64_t> running_sums;
+
+// Check the radix sort against std::stable_sort of (code, position) pairs: random codes, codes sharing their high
+// digits, codes which are all the same, and inputs large enough to be sorted on several threads
+template <typename morton>
+static bool checkSortFunctions() {
+	const size_t sizes[6] = { 0, 1, 2, 1000, 100000, 300000 };
+	const unsigned int threads[3] = { 1, 4, 0 };
+	const morton full = static_cast<morton>(~morton(0));
+	const morton masks[3] = { full, static_cast<morton>(0xFFFF), 0 };
+
+	bool everything_okay = true;
+	for (size_t n : sizes) {
+		for (unsigned int t : threads) {
+			for (morton mask : masks) {
+				const morton base = static_cast<morton>(static_cast<morton>(rand()) << (sizeof(morton) * 8 - 16));
+				vector<morton> keys(n), sorted;
+				vector<pair<morton, uint32_t> > correct(n);
+				for (size_t i = 0; i < n; i++) {
+					const morton r = static_cast<morton>((static_cast<uint64_t>(rand()) << 32) ^ (static_cast<uint64_t>(rand()) << 16) ^ rand());
+					keys[i] = mask == full ? r : static_cast<morton>((r & mask) | base);
+					correct[i] = make_pair(keys[i], static_cast<uint32_t>(i));
+				}
+				std::stable_sort(correct.begin(), correct.end(), [](const pair<morton, uint32_t>& a, const pair<morton, uint32_t>& b) { return a.first < b.first; });
+
+				sorted = keys;
+				vector<uint32_t> perm(n);
+				libmorton::morton_sort<morton, uint32_t>(sorted.data(), perm.data(), n, t);
+				vector<morton> gathered(n);
+				libmorton::morton_gather<morton, uint32_t>(keys.data(), perm.data(), gathered.data(), n);
+				bool ok = gathered == sorted;
+				for (size_t i = 0; i < n; i++) { ok &= sorted[i] == correct[i].first && perm[i] == correct[i].second; }
+				libmorton::morton_sort<morton>(keys.data(), n, t);
+				ok &= keys == sorted;
+				if (!ok) {
+					everything_okay = false;
+					cout << endl << "    Incorrect sort of " << n << " codes on " << t << " threads (mask " << mask << ")" << endl;
+				}
+			}
+		}
+	}
+	return everything_okay;
+}
+
+template <typename morton, size_t bits>
+inline void checkSortCorrectness() {
+	printf("++ Checking correctness of %lu-bit radix sort ... ", bits);
+	checkSortFunctions<morton>() ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
+// Test performance of sorting the codes of a MAX^3 grid, encoded in the order of the linear encode benchmarks and
+// from random coordinates like the random encode benchmarks: radix sort (with permutation) against std::sort
+template <typename morton, typename coord>
+static std::string testSort_3D_Perf(size_t times) {
+	Timer radix_linear, radix_random, std_linear, std_random;
+	morton runningsum = 0;
+	vector<morton> linear, random, keys;
+	vector<uint32_t> perm(total);
+	linear.reserve(total);
+	random.reserve(total);
+	for (coord i = 0; i < MAX; i++) {
+		for (coord j = 0; j < MAX; j++) {
+			for (coord k = 0; k < MAX; k++) {
+				linear.push_back(static_cast<morton>(control_encode(i, j, k)));
+			}
+		}
+	}
+	const coord maximum = static_cast<coord>(~0);
+	vector<coord> randnumbers;
+	for (size_t i = 0; i < RAND_POOL_SIZE; i++) {
+		randnumbers.push_back(rand() % maximum);
+	}
+	for (size_t i = 0; i < total; i++) {
+		random.push_back(static_cast<morton>(control_encode(randnumbers[i % RAND_POOL_SIZE], randnumbers[(i + 1) % RAND_POOL_SIZE], randnumbers[(i + 2) % RAND_POOL_SIZE])));
+	}
+
+	for (size_t t = 0; t < times; t++) {
+		keys = linear;
+		radix_linear.start();
+		libmorton::morton_sort<morton, uint32_t>(keys.data(), perm.data(), total);
+		radix_linear.stop();
+		runningsum += keys[total / 2] + perm[total / 3];
+		keys = linear;
+		std_linear.start();
+		std::sort(keys.begin(), keys.end());
+		std_linear.stop();
+		runningsum += keys[total / 2];
+
+		keys = random;
+		radix_random.start();
+		libmorton::morton_sort<morton, uint32_t>(keys.data(), perm.data(), total);
+		radix_random.stop();
+		runningsum += keys[total / 2] + perm[total / 3];
+		keys = random;
+		std_random.start();
+		std::sort(keys.begin(), keys.end());
+		std_random.stop();
+		runningsum += keys[total / 2];
+	}
+	running_sums.push_back(runningsum);
+
+	stringstream os;
+	os << setfill('0') << std::setw(6) << std::fixed << std::setprecision(3)
+		<< radix_linear.elapsed_time_milliseconds / (float)times << " ms " << radix_random.elapsed_time_milliseconds / (float)times << " ms : radix sort, "
+		<< std_linear.elapsed_time_milliseconds / (float)times << " ms " << std_random.elapsed_time_milliseconds / (float)times << " ms : std::sort";
+	return os.str();
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include "libmorton_test.h"
+
+using namespace std;
+
+// Config variables (defined elsewhere)
+extern size_t total;
+extern size_t MAX;
+extern unsigned int times;
+extern vector<uint_fast64_t> running_sums;
+
+// Buffer of bytes starting at a 64-byte boundary, plus offset bytes
+struct swizzleBuffer {
+	vector<unsigned char> storage;
+	unsigned char* data;
+	swizzleBuffer(const size_t bytes, const size_t offset) : storage(bytes + 64 + offset, 0xCD) {
+		data = storage.data() + (64 - reinterpret_cast<uintptr_t>(storage.data()) % 64) % 64 + offset;
+	}
+};
+
+// Swizzle a random image of width x height pixels, compare every pixel with its place in the Z-order layout (and the
+// elements in between pixels with their old value), then unswizzle it and compare with the image
+static bool checkSwizzleFunction(const uint32_t width, const uint32_t height, const size_t size, const size_t pitch, const size_t offset, const bool control) {
+	swizzleBuffer image(pitch * height, offset), swizzled(libmorton::morton2D_swizzled_size(width, height) * size, offset), back(pitch * height, offset);
+	for (size_t i = 0; i < pitch * height; i++) { image.data[i] = static_cast<unsigned char>(rand()); }
+	bool ok = libmorton::morton2D_swizzle(image.data, pitch, swizzled.data, width, height, size);
+	vector<bool> pixel(libmorton::morton2D_swizzled_size(width, height), false);
+	for (uint32_t y = 0; ok && y < height; y++) {
+		for (uint32_t x = 0; ok && x < width; x++) {
+			const uint64_t m = control ? control_encode(static_cast<uint64_t>(x), static_cast<uint64_t>(y)) : libmorton::morton2D_64_encode(x, y);
+			ok &= memcmp(swizzled.data + m * size, image.data + y * pitch + x * size, size) == 0;
+			pixel[m] = true;
+		}
+	}
+	for (size_t m = 0; ok && m < pixel.size(); m++) {
+		for (size_t b = 0; !pixel[m] && b < size; b++) { ok &= swizzled.data[m * size + b] == 0xCD; }
+	}
+	ok &= libmorton::morton2D_unswizzle(swizzled.data, back.data, pitch, width, height, size);
+	for (uint32_t y = 0; ok && y < height; y++) {
+		ok &= memcmp(back.data + y * pitch, image.data + y * pitch, size_t(width) * size) == 0;
+	}
+	if (!ok) {
+		cout << endl << "    Incorrect swizzle of a " << width << " x " << height << " image of " << size << "-byte pixels (pitch " << pitch << ", offset " << offset << ")" << endl;
+	}
+	return ok;
+}
+
+inline void checkSwizzleCorrectness() {
+	printf("++ Checking correctness of image swizzle methods ... ");
+	bool ok = true;
+	const size_t sizes[] = { 1, 2, 4, 8, 16 };
+	for (size_t size : sizes) {
+		// Square and rectangular images, whole tiles and edge tiles, rows with padding, unaligned buffers
+		ok &= checkSwizzleFunction(64, 64, size, 64 * size, 0, true);
+		ok &= checkSwizzleFunction(37, 21, size, 37 * size, 0, true);
+		ok &= checkSwizzleFunction(100, 48, size, 128 * size + 16, 0, true);
+		ok &= checkSwizzleFunction(16, 200, size, 16 * size + 3, 5, true);
+		ok &= checkSwizzleFunction(1, 1, size, size, 0, true);
+		ok &= checkSwizzleFunction(0, 7, size, size, 0, true);
+		// Large enough for streaming stores, aligned and unaligned
+		ok &= checkSwizzleFunction(1024, 1024 * 4 / static_cast<uint32_t>(size), size, 1024 * size, 0, false);
+		ok &= checkSwizzleFunction(1000, 4400 / static_cast<uint32_t>(size), size, 1000 * size + 8, 8, false);
+	}
+	// Pixel sizes without a swizzle method
+	ok &= !libmorton::morton2D_swizzle(nullptr, 0, nullptr, 1, 1, 3) && !libmorton::morton2D_unswizzle(nullptr, nullptr, 0, 1, 1, 32);
+	ok ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
+
+// Test performance of swizzling and unswizzling a square image of about total pixels of size bytes, against copying
+// it with memcpy and against encoding and scattering every pixel on its own
+static std::string testSwizzle_Perf(const size_t size, size_t times) {
+	Timer swizzle_timer, unswizzle_timer, copy_timer, pixel_timer;
+	uint32_t side = 1;
+	while (size_t(side) * side * 4 <= total) { side *= 2; }
+	const size_t bytes = size_t(side) * side * size;
+	swizzleBuffer image(bytes, 0), swizzled(bytes, 0);
+	for (size_t i = 0; i < bytes; i++) { image.data[i] = static_cast<unsigned char>(i * 7); }
+
+	bool ok = true;
+	for (size_t t = 0; t < times; t++) {
+		copy_timer.start();
+		memcpy(swizzled.data, image.data, bytes);
+		copy_timer.stop();
+		swizzle_timer.start();
+		ok &= libmorton::morton2D_swizzle(image.data, side * size, swizzled.data, side, side, size);
+		swizzle_timer.stop();
+		unswizzle_timer.start();
+		ok &= libmorton::morton2D_unswizzle(swizzled.data, image.data, side * size, side, side, size);
+		unswizzle_timer.stop();
+		pixel_timer.start();
+		for (uint32_t y = 0; y < side; y++) {
+			for (uint32_t x = 0; x < side; x++) {
+				memcpy(swizzled.data + libmorton::morton2D_64_encode(x, y) * size, image.data + (size_t(y) * side + x) * size, size);
+			}
+		}
+		pixel_timer.stop();
+		running_sums.push_back(swizzled.data[bytes / 3] + image.data[bytes / 2]);
+	}
+	running_sums.push_back(ok);
+
+	const double gigabytes = static_cast<double>(bytes) * times / (1 << 30);
+	stringstream os;
+	os << side << " x " << side << " x " << size << " bytes: " << std::fixed << std::setprecision(2)
+		<< gigabytes * 1000 / swizzle_timer.elapsed_time_milliseconds << " GB/s swizzle, "
+		<< gigabytes * 1000 / unswizzle_timer.elapsed_time_milliseconds << " GB/s unswizzle, "
+		<< gigabytes * 1000 / pixel_timer.elapsed_time_milliseconds << " GB/s per pixel, "
+		<< gigabytes * 1000 / copy_timer.elapsed_time_milliseconds << " GB/s memcpy" << (ok ? "" : " (failed)");
+	return os.str();
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include "libmorton_test.h"
+#include "libmorton_test_ND.h"
+
+using namespace std;
+
+// The 2D / 3D tree navigation methods, by number of dimensions
+template <typename morton, size_t N> struct tree_methods;
+template <typename morton> struct tree_methods<morton, 2> {
+	static constexpr unsigned int levels() { return libmorton::m2D_levels<morton>(); }
+	static morton cell(const morton m, const unsigned int level) { return libmorton::m2D_cell<morton>(m, level); }
+	static morton parent(const morton c, const unsigned int level) { return libmorton::m2D_parent<morton>(c, level); }
+	static morton child(const morton c, const unsigned int level, const unsigned int i) { return libmorton::m2D_child<morton>(c, level, i); }
+	static unsigned int child_index(const morton m, const unsigned int level) { return libmorton::m2D_child_index<morton>(m, level); }
+	static morton sibling(const morton c, const unsigned int level, const unsigned int i) { return libmorton::m2D_sibling<morton>(c, level, i); }
+	static morton cell_last(const morton c, const unsigned int level) { return libmorton::m2D_cell_last<morton>(c, level); }
+	static unsigned int common_level(const morton a, const morton b) { return libmorton::m2D_common_level<morton>(a, b); }
+	static void bounds(const morton c, const unsigned int level, std::array<uint64_t, 2>& lo, std::array<uint64_t, 2>& hi) {
+		libmorton::m2D_cell_bounds<morton, uint64_t>(c, level, lo[0], lo[1], hi[0], hi[1]);
+	}
+	static libmorton::morton_aabb<double, 2> box(const morton c, const unsigned int level, const libmorton::morton_aabb<double, 2>& domain) { return libmorton::m2D_cell_box<morton, double>(c, level, domain); }
+	static void cell_batch(const morton* m, size_t n, unsigned int level, morton* out) { libmorton::m2D_cell_batch<morton>(m, n, level, out); }
+	static void common_level_batch(const morton* a, const morton* b, size_t n, unsigned int* out) { libmorton::m2D_common_level_batch<morton>(a, b, n, out); }
+};
+template <typename morton> struct tree_methods<morton, 3> {
+	static constexpr unsigned int levels() { return libmorton::m3D_levels<morton>(); }
+	static morton cell(const morton m, const unsigned int level) { return libmorton::m3D_cell<morton>(m, level); }
+	static morton parent(const morton c, const unsigned int level) { return libmorton::m3D_parent<morton>(c, level); }
+	static morton child(const morton c, const unsigned int level, const unsigned int i) { return libmorton::m3D_child<morton>(c, level, i); }
+	static unsigned int child_index(const morton m, const unsigned int level) { return libmorton::m3D_child_index<morton>(m, level); }
+	static morton sibling(const morton c, const unsigned int level, const unsigned int i) { return libmorton::m3D_sibling<morton>(c, level, i); }
+	static morton cell_last(const morton c, const unsigned int level) { return libmorton::m3D_cell_last<morton>(c, level); }
+	static unsigned int common_level(const morton a, const morton b) { return libmorton::m3D_common_level<morton>(a, b); }
+	static void bounds(const morton c, const unsigned int level, std::array<uint64_t, 3>& lo, std::array<uint64_t, 3>& hi) {
+		libmorton::m3D_cell_bounds<morton, uint64_t>(c, level, lo[0], lo[1], lo[2], hi[0], hi[1], hi[2]);
+	}
+	static libmorton::morton_aabb<double, 3> box(const morton c, const unsigned int level, const libmorton::morton_aabb<double, 3>& domain) { return libmorton::m3D_cell_box<morton, double>(c, level, domain); }
+	static void cell_batch(const morton* m, size_t n, unsigned int level, morton* out) { libmorton::m3D_cell_batch<morton>(m, n, level, out); }
+	static void common_level_batch(const morton* a, const morton* b, size_t n, unsigned int* out) { libmorton::m3D_common_level_batch<morton>(a, b, n, out); }
+};
+
+// The navigation methods are usable in constant expressions
+static_assert(libmorton::m3D_levels<uint64_t>() == 21 && libmorton::m2D_levels<uint32_t>() == 16, "tree depth");
+static_assert(libmorton::m3D_child<uint64_t>(0, 0, 7) == uint64_t(7) << 60 && libmorton::m3D_child_index<uint64_t>(uint64_t(5) << 57, 2) == 5, "octree child");
+static_assert(libmorton::m2D_parent<uint32_t>(0xFFFFu, 16) == 0xFFFCu && libmorton::m2D_cell_last<uint64_t>(0, 0) == ~uint64_t(0), "quadtree parent");
+
+// Bits below bit s set, for s up to 64
+static uint64_t treeLowBits(const size_t s) {
+	return s == 0 ? 0 : ~uint64_t(0) >> (64 - s);
+}
+
+// Random coordinates, sharing their top bits with base up to a random level
+template <size_t N>
+static std::array<uint64_t, N> treeTestCoordinates(const std::array<uint64_t, N>& base, const size_t fieldbits) {
+	const size_t shared = rand() % (fieldbits + 1);
+	std::array<uint64_t, N> c;
+	for (size_t d = 0; d < N; d++) {
+		const uint64_t r = ((static_cast<uint64_t>(rand()) << 62) ^ (static_cast<uint64_t>(rand()) << 31) ^ static_cast<uint64_t>(rand())) & treeLowBits(fieldbits);
+		const uint64_t low = treeLowBits(fieldbits - shared);
+		c[d] = (base[d] & ~low) | (r & low);
+	}
+	return c;
+}
+
+// Control encoding of tree test coordinates into codes of any width
+template <typename morton, size_t N>
+static morton treeControlEncode(const std::array<uint64_t, N>& c) {
+	return static_cast<morton>(control_encode_ND<N, uint64_t>(c, std::make_index_sequence<N>()));
+}
+#if LIBMORTON_HAS_UINT128
+template <>
+libmorton::morton128_t treeControlEncode<libmorton::morton128_t, 2>(const std::array<uint64_t, 2>& c) { return control_encode_128(c[0], c[1]); }
+template <>
+libmorton::morton128_t treeControlEncode<libmorton::morton128_t, 3>(const std::array<uint64_t, 3>& c) { return control_encode_128(c[0], c[1], c[2]); }
+#endif
+
+// Check the navigation methods against decoding the coordinates, shifting them and encoding them again
+template <size_t N, typename morton, size_t bits>
+static bool checkTreeFunctions() {
+	typedef tree_methods<morton, N> ops;
+	static const size_t fieldbits = bits / N;
+	static const unsigned int levels = ops::levels();
+	static_assert(levels == fieldbits, "tree depth is the number of bits per coordinate");
+
+	bool everything_okay = true;
+	std::array<uint64_t, N> base = treeTestCoordinates<N>(std::array<uint64_t, N>(), fieldbits);
+	vector<morton> codes, others;
+	for (unsigned int v = 0; v < 2000; v++) {
+		const std::array<uint64_t, N> ca = treeTestCoordinates<N>(base, fieldbits), cb = treeTestCoordinates<N>(ca, fieldbits);
+		const morton a = treeControlEncode<morton, N>(ca), b = treeControlEncode<morton, N>(cb);
+		codes.push_back(a);
+		others.push_back(b);
+		base = ca;
+
+		bool ok = true;
+		unsigned int common = 0;
+		for (unsigned int level = 0; level <= levels; level++) {
+			const size_t s = levels - level;
+			std::array<uint64_t, N> lo, hi, computed_lo, computed_hi;
+			bool same = true;
+			unsigned int index = 0;
+			for (size_t d = 0; d < N; d++) {
+				lo[d] = ca[d] & ~treeLowBits(s);
+				hi[d] = lo[d] + treeLowBits(s);
+				same &= ((ca[d] ^ cb[d]) & ~treeLowBits(s)) == 0;
+				if (level > 0) { index |= static_cast<unsigned int>((ca[d] >> s) & 1) << d; }
+			}
+			common = same ? level : common;
+			const morton cell = ops::cell(a, level);
+			ok &= cell == treeControlEncode<morton, N>(lo);
+			ok &= ops::cell_last(cell, level) == treeControlEncode<morton, N>(hi);
+			ops::bounds(cell, level, computed_lo, computed_hi);
+			ok &= computed_lo == lo && computed_hi == hi;
+			libmorton::morton_aabb<double, N> box;
+			for (size_t d = 0; d < N; d++) {
+				box.lo[d] = -1.0 * (d + 1);
+				box.hi[d] = box.lo[d] + std::ldexp(1.0, static_cast<int>(fieldbits));
+			}
+			const libmorton::morton_aabb<double, N> cell_box = ops::box(cell, level, box);
+			for (size_t d = 0; d < N; d++) {
+				// hi + 1 as a double: beyond 53 bits, hi itself would be rounded first
+				ok &= cell_box.lo[d] == box.lo[d] + lo[d] && cell_box.hi[d] == box.lo[d] + (static_cast<double>(lo[d]) + std::ldexp(1.0, static_cast<int>(s)));
+			}
+			if (level > 0) {
+				const morton parent = ops::parent(cell, level);
+				ok &= parent == ops::cell(a, level - 1) && ops::child_index(a, level) == index && ops::child(parent, level - 1, index) == cell;
+				for (unsigned int i = 0; i < (1u << N); i++) {
+					ok &= ops::sibling(cell, level, i) == ops::child(parent, level - 1, i);
+				}
+			}
+			if (level < levels) {
+				for (unsigned int i = 0; i < (1u << N); i++) {
+					const morton child = ops::child(cell, level, i);
+					ok &= ops::child_index(child, level + 1) == i && ops::parent(child, level + 1) == cell;
+				}
+			}
+		}
+		ok &= ops::common_level(a, b) == common && ops::common_level(b, a) == common;
+		if (!ok) {
+			everything_okay = false;
+			cout << endl << "    Incorrect " << N << "D tree navigation of the code of (" << ca[0] << ", " << ca[1] << ", ...)" << endl;
+		}
+	}
+
+	// Batch methods match the single-code ones
+	for (unsigned int level = 0; level <= levels; level += 3) {
+		vector<morton> cells(codes.size());
+		ops::cell_batch(codes.data(), codes.size(), level, cells.data());
+		for (size_t i = 0; i < codes.size(); i++) { everything_okay &= cells[i] == ops::cell(codes[i], level); }
+	}
+	vector<unsigned int> common(codes.size());
+	ops::common_level_batch(codes.data(), others.data(), codes.size(), common.data());
+	for (size_t i = 0; i < codes.size(); i++) { everything_okay &= common[i] == ops::common_level(codes[i], others[i]); }
+	return everything_okay;
+}
+
+template <size_t N, typename morton, size_t bits>
+inline void checkTreeCorrectness() {
+	printf("++ Checking correctness of %luD tree navigation (%lu bit) methods ... ", N, bits);
+	checkTreeFunctions<N, morton, bits>() ? printf(" Passed. \n") : printf("    One or more methods failed. \n");
+}
@@ -0,0 +1,130 @@
+// Sort a file of fixed size point records by the 3D morton codes of their positions, in bounded memory
+// Usage: morton_sort_file <input> <output> <record size> <position offset> <float|double|uint32>
+//        [--box x0 y0 z0 x1 y1 z1] [--memory MB] [--temp prefix]
+// float / double positions are quantized in the box, or in the bounds of all positions (found in an extra pass
+// over the input) if no box is given. uint32 coordinates must be below 2^21.
+
+// 64-bit file offsets (fseeko / ftello) on 32-bit POSIX systems
+#define _FILE_OFFSET_BITS 64
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <limits>
+#include <string>
+#include <vector>
+#include "morton_external_sort.h"
+
+using namespace libmorton;
+
+// Bounds of the positions in the file
+template<typename real>
+static bool findBounds(const char* path, const size_t record_size, const size_t offset, morton_aabb<real, 3>& box) {
+	FILE* f = fopen(path, "rb");
+	if (f == nullptr) { return false; }
+	for (size_t d = 0; d < 3; d++) {
+		box.lo[d] = std::numeric_limits<real>::max();
+		box.hi[d] = std::numeric_limits<real>::lowest();
+	}
+	std::vector<unsigned char> buffer(record_size * 65536);
+	for (size_t got; (got = fread(buffer.data(), 1, buffer.size(), f)) > 0;) {
+		for (size_t i = 0; i + record_size <= got; i += record_size) {
+			for (size_t d = 0; d < 3; d++) {
+				real v;
+				memcpy(&v, buffer.data() + i + offset + d * sizeof(real), sizeof(real));
+				box.lo[d] = v < box.lo[d] ? v : box.lo[d];
+				box.hi[d] = v > box.hi[d] ? v : box.hi[d];
+			}
+		}
+	}
+	fclose(f);
+	return true;
+}
+
+// Size of the file in bytes, or -1 if it cannot be opened. ftell returns a long, which has 32 bits on Windows.
+static int64_t fileSize(const char* path) {
+	FILE* f = fopen(path, "rb");
+	if (f == nullptr) { return -1; }
+#if _MSC_VER
+	const int64_t size = _fseeki64(f, 0, SEEK_END) == 0 ? _ftelli64(f) : -1;
+#else
+	const int64_t size = fseeko(f, 0, SEEK_END) == 0 ? static_cast<int64_t>(ftello(f)) : -1;
+#endif
+	fclose(f);
+	return size;
+}
+
+template<typename real>
+static bool positionKey(const char* path, const size_t record_size, const size_t offset, const std::vector<double>& box_values, morton_record_key& key) {
+	morton_aabb<real, 3> box;
+	if (box_values.empty()) {
+		if (!findBounds(path, record_size, offset, box)) { return false; }
+	}
+	else {
+		for (size_t d = 0; d < 3; d++) {
+			box.lo[d] = static_cast<real>(box_values[d]);
+			box.hi[d] = static_cast<real>(box_values[d + 3]);
+		}
+	}
+	printf("Box: (%g, %g, %g) - (%g, %g, %g)\n", double(box.lo[0]), double(box.lo[1]), double(box.lo[2]), double(box.hi[0]), double(box.hi[1]), double(box.hi[2]));
+	key = morton_quantized_key<real>(offset, box);
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 6) {
+		printf("Usage: %s <input> <output> <record size> <position offset> <float|double|uint32> [--box x0 y0 z0 x1 y1 z1] [--memory MB] [--temp prefix]\n", argv[0]);
+		return 1;
+	}
+	const char* input = argv[1];
+	const char* output = argv[2];
+	const size_t record_size = strtoull(argv[3], nullptr, 10);
+	const size_t offset = strtoull(argv[4], nullptr, 10);
+	const std::string type = argv[5];
+	const size_t position_size = type == "double" ? 24 : 12;
+	if (record_size == 0 || offset + position_size > record_size || (type != "float" && type != "double" && type != "uint32")) {
+		printf("Invalid record layout\n");
+		return 1;
+	}
+	std::vector<double> box;
+	morton_external_sort_options options;
+	for (int i = 6; i < argc; i++) {
+		if (strcmp(argv[i], "--box") == 0 && i + 6 < argc) {
+			for (int j = 1; j <= 6; j++) { box.push_back(atof(argv[i + j])); }
+			i += 6;
+		}
+		else if (strcmp(argv[i], "--memory") == 0 && i + 1 < argc) {
+			options.memory = strtoull(argv[++i], nullptr, 10) << 20;
+		}
+		else if (strcmp(argv[i], "--temp") == 0 && i + 1 < argc) {
+			options.temp_prefix = argv[++i];
+		}
+		else {
+			printf("Unknown argument %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	morton_record_key key;
+	bool ok = true;
+	if (type == "float") { ok = positionKey<float>(input, record_size, offset, box, key); }
+	else if (type == "double") { ok = positionKey<double>(input, record_size, offset, box, key); }
+	else { key = morton_coordinate_key(offset); }
+	ok = ok && morton_external_sort(input, output, record_size, key, options);
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (!ok) {
+		printf("Could not sort %s into %s\n", input, output);
+		return 1;
+	}
+
+	const int64_t bytes = fileSize(output);
+	if (bytes < 0) {
+		printf("Could not open %s\n", output);
+		return 1;
+	}
+	const double megabytes = static_cast<double>(bytes) / (1 << 20);
+	printf("Sorted %.0f MB in %.3f s (%.0f MB/s)\n", megabytes, seconds, megabytes / seconds);
+	return 0;
+}